@@ -6,450 +6,841 @@
 #include <bits/stdc++.h>
 #include "Algorithms.hpp"
 #include "Graph.hpp"
+#include "Traversal.hpp"
+#include "AllPairsPaths.hpp"
+#include "StronglyConnectedComponents.hpp"
+#include "DisjointSet.hpp"
+#include "ThreadPool.hpp"
 using namespace std;
 using namespace ariel;
-#define INF 99999
-int Algorithms::isConnected(Graph &graph)
-{
-    // Create a vector to store visited vertices and initialize all vertices as not visited.
-    size_t v = graph.getVertices();
-    vector<vector<int>> adjacencyMatrix = graph.getAdjacencyMatrix();
-    // If the graph is directed, check if it is strongly connected.
-    if (graph.isDirected())
 
+const size_t Algorithms::FLOYD_WARSHALL_TILE;
+
+namespace
+{
+    // Finds a cycle in a directed graph: an edge entering a vertex that is still on the stack.
+    struct DirectedCycleVisitor : DepthFirstVisitor
     {
-        // Mark all the vertices as not visited.
-        vector<bool> visited(v, false);
-        // Do a DFS traversal starting from the first vertex.
+        vector<size_t> parent;
+        string &cycle;
 
-        DFSIsConnected(adjacencyMatrix, 0, visited);
-        // If DFS traversal does not visit all vertices, the graph is not connected.
-        for (size_t i = 0; i < v; i++)
+        DirectedCycleVisitor(size_t n, string &cycle) : parent(n, DepthFirstSearch::NO_PARENT), cycle(cycle) {}
+
+        template <typename Edge>
+        bool examineEdge(size_t, const Edge &edge)
         {
-            if (!visited[i])
+            // DFS doesn't work with negative edges.
+            if (edge.weight < 0)
             {
-                return 0;
+                throw invalid_argument("The graph contains a negative edge");
             }
+            return true;
         }
 
-        // Create a transpose of the adjacency matrix.
-        vector<vector<int>> transposeMat = graph.getTranspose();
-        // Mark all the vertices as not visited.
-        visited = vector<bool>(v, false);
-        // Do a DFS traversal starting from the first vertex.
-        // Starting vertex must be  same starting vertex in the original graph.
-        DFSIsConnected(transposeMat, 0, visited);
-        // If DFS traversal does not visit all vertices, the graph is not connected.
-        for (size_t i = 0; i < v; i++)
+        bool discover(size_t v, size_t from)
         {
-            if (!visited[i])
+            this->parent[v] = from;
+            return true;
+        }
+
+        template <typename Edge>
+        bool backEdge(size_t u, const Edge &edge)
+        {
+            // The cycle starts at the vertex the edge enters, and goes up the stack from the parent of u to the root.
+            this->cycle += "->" + to_string(edge.vertex);
+            for (size_t w = this->parent[u]; w != DepthFirstSearch::NO_PARENT; w = this->parent[w])
             {
-                return 0;
+                this->cycle += "->" + to_string(w);
             }
+            return false;
         }
+    };
 
-        return 1;
-    }
-    else
+    // Finds a cycle in an undirected graph: an edge entering a vertex on the stack, other than the parent.
+    struct UndirectedCycleVisitor : DepthFirstVisitor
     {
-        // Mark all the vertices as not visited.
-        vector<bool> visited(v, false);
-        // Do a DFS traversal starting from the first vertex.
-        DFSIsConnected(adjacencyMatrix, 0, visited);
-        // If DFS traversal does not visit all vertices, the graph is not connected.
-        for (size_t i = 0; i < v; i++)
+        vector<size_t> parent;
+        string &cycle;
+
+        UndirectedCycleVisitor(size_t n, string &cycle) : parent(n, DepthFirstSearch::NO_PARENT), cycle(cycle) {}
+
+        template <typename Edge>
+        bool examineEdge(size_t, const Edge &edge)
         {
-            if (!visited[i])
+            // DFS doesn't work with negative edges.
+            if (edge.weight < 0)
             {
-                return 0;
+                throw invalid_argument("The graph contains a negative edge");
             }
+            return true;
         }
-        return 1;
-    }
-}
 
-string Algorithms::shortestPath(Graph &graph, size_t src, size_t dest)
-{
-    vector<vector<int>> adjacencyMatrix = graph.getAdjacencyMatrix();
-    vector<int>::size_type n = adjacencyMatrix.size();
-    vector<int>::size_type i, j;
+        bool discover(size_t v, size_t from)
+        {
+            this->parent[v] = from;
+            return true;
+        }
 
-    // Create a distance matrix and a next matrix.
-    vector<vector<int>> dist(n, vector<int>(n, 0));
-    vector<vector<int>> next(n, vector<int>(n, 0));
-    // Initialize the distance matrix.
-    for (i = 0; i < n; i++)
-    {
-        for (j = 0; j < n; j++)
+        template <typename Edge>
+        bool backEdge(size_t u, const Edge &edge)
         {
-            // If there is no edge between the vertices, set the distance to infinity.
-            if (adjacencyMatrix[i][j] == 0)
+            size_t i = edge.vertex;
+            // The edge to the parent is the edge the search came down by.
+            if (i == this->parent[u])
             {
-                dist[i][j] = INF;
-                next[i][j] = -1;
+                return true;
             }
-            
-            // If there is an edge between the vertices, set the distance to the weight of the edge.
-            else 
+            // Walk up the tree from u to the vertex the edge enters.
+            this->cycle = "The cycle is:" + to_string(i);
+            for (size_t j = u; j != i; j = this->parent[j])
             {
-                dist[i][j] = adjacencyMatrix[i][j];
-                // Set the next matrix.
-                next[i][j] = j;
+                this->cycle += "->" + to_string(j);
             }
+            this->cycle += "->" + to_string(i);
+            return false;
         }
-    }
-    // Floyd-Warshall algorithm.
-    floydWarshall(dist, next);
-    // Check if there is a path between the source and destination.
-    if (dist[src][dest] == INF)
-    {
-        return "-1";
-    }
-    // Reconstruct the path.
-    string path = to_string(src);
-    
-    while (src != dest)
+    };
+
+    // Colors every vertex with the opposite color of its parent, and checks that no other edge joins two vertices of the same color.
+    struct ColoringVisitor : DepthFirstVisitor
     {
-        src = static_cast<size_t>(next[src][dest]);
-        path += "->" + to_string(src);
-    }
-    return path;
-}
+        vector<int> &color;
 
-bool Algorithms::isContainsCycle(Graph &graph)
-{
-    vector<int>::size_type v = graph.getVertices();
+        explicit ColoringVisitor(vector<int> &color) : color(color) {}
 
-    string cycle = "The cycle is:";
+        bool discover(size_t v, size_t from)
+        {
+            this->color[v] = from == DepthFirstSearch::NO_PARENT ? 0 : 1 - this->color[from];
+            return true;
+        }
 
-    // If the graph is directed, use DFS utility for directed graph.
-    if (graph.isDirected())
-    { 
-        // Mark all the vertices as not visited and not part of the recursion stack.
-        vector<bool> visited(v, false);
-        vector<bool> recStack(v, false);
+        template <typename Edge>
+        bool backEdge(size_t u, const Edge &edge)
+        {
+            return this->color[edge.vertex] != this->color[u];
+        }
 
-        // Call the recursive helper function to detect cycle in different DFS trees.
-        for (size_t i = 0; i < v; i++)
+        template <typename Edge>
+        bool forwardOrCrossEdge(size_t u, const Edge &edge)
         {
-            // If the vertex is not visited, check if it contains a cycle.
-            if (!visited[i] && DFSIsContainsCycleDirected(graph, i, visited, recStack, cycle))
+            return this->color[edge.vertex] != this->color[u];
+        }
+    };
+
+    // The component of a vertex that is not in a finished component yet.
+    const size_t NO_COMPONENT = SIZE_MAX;
+
+    // Tarjan: the vertices of a component stay on a stack of their own until the search of its first vertex finishes,
+    // and low[v] is the first discovered vertex still on that stack that v and its descendants have an edge to.
+    // Components are numbered as they finish, so an edge between two components enters the one with the smaller number.
+    struct ComponentVisitor : DepthFirstVisitor
+    {
+        vector<size_t> &component;
+        vector<size_t> order;
+        vector<size_t> low;
+        vector<size_t> parent;
+        vector<size_t> open;
+        size_t discovered;
+        size_t components;
+
+        explicit ComponentVisitor(vector<size_t> &component)
+            : component(component), order(component.size()), low(component.size()), parent(component.size()), discovered(0), components(0)
+        {
+            this->open.reserve(component.size());
+        }
+
+        bool discover(size_t v, size_t from)
+        {
+            this->order[v] = this->low[v] = this->discovered++;
+            this->parent[v] = from;
+            this->open.push_back(v);
+            return true;
+        }
+
+        template <typename Edge>
+        bool backEdge(size_t u, const Edge &edge)
+        {
+            this->low[u] = min(this->low[u], this->order[edge.vertex]);
+            return true;
+        }
+
+        template <typename Edge>
+        bool forwardOrCrossEdge(size_t u, const Edge &edge)
+        {
+            // An edge into a finished component does not join u to it.
+            if (this->component[edge.vertex] == NO_COMPONENT)
             {
-                cout << cycle << endl;
-                return true;
+                this->low[u] = min(this->low[u], this->order[edge.vertex]);
             }
+            return true;
         }
 
-        cout << "0" << endl;
-        return false;
-    }
-    // If the graph is undirected, use DFS utility for undirected graph.
-    else
+        bool finish(size_t v)
+        {
+            // v is the first vertex of its component, the component is v and the vertices above it on the stack.
+            if (this->low[v] == this->order[v])
+            {
+                size_t w;
+                do
+                {
+                    w = this->open.back();
+                    this->open.pop_back();
+                    this->component[w] = this->components;
+                } while (w != v);
+                this->components++;
+            }
+            if (this->parent[v] != DepthFirstSearch::NO_PARENT)
+            {
+                this->low[this->parent[v]] = min(this->low[this->parent[v]], this->low[v]);
+            }
+            return true;
+        }
+    };
+
+    /*
+    * @brief
+    * Breadth first search of a graph in bitset storage, 64 vertices at a time: the next level is the or of the rows
+    * of the vertices of the level, without the vertices already discovered.
+    * @param graph - a graph in bitset storage.
+    * @param root - the vertex to start from, not discovered yet.
+    * @param discovered - one bit per vertex, the vertices reached are added to it.
+    * @param discover - called as discover(v, depth) for every vertex reached, the root at depth 0, returns false to stop the search.
+    * @return bool - false if discover stopped the search, true otherwise.
+    */
+    template <typename W, typename Discover>
+    bool bitsetSearch(const BasicGraph<W> &graph, size_t root, vector<uint64_t> &discovered, Discover discover)
     {
-        // Mark all the vertices as not visited and not part of the recursion stack.
-        vector<bool> visited(v, false);
-        // To store parent vertices in DFS tree.
-        vector<int> parentVec(v, -1);
-        // Call the recursive helper function to detect cycle in different DFS trees.
-        for (size_t i = 0; i < v; i++)
+        size_t words = discovered.size();
+        vector<uint64_t> level(words, 0), next(words);
+        level[root / 64] = uint64_t(1) << (root % 64);
+        discovered[root / 64] |= level[root / 64];
+        if (!discover(root, 0))
         {
-            // If the vertex is not visited, check if it contains a cycle.
-            if (!visited[i])
+            return false;
+        }
+
+        for (size_t depth = 1;; depth++)
+        {
+            fill(next.begin(), next.end(), 0);
+            for (size_t w = 0; w < words; w++)
             {
-                if (DFSIsContainsCycleUndirected(graph, i, -1, visited, cycle, parentVec))
+                for (uint64_t word = level[w]; word != 0; word &= word - 1)
                 {
+                    const uint64_t *row = graph.getRow(w * 64 + static_cast<size_t>(__builtin_ctzll(word))).bits();
+                    for (size_t k = 0; k < words; k++)
+                    {
+                        next[k] |= row[k];
+                    }
+                }
+            }
 
-                    cout << cycle << endl;
-                    return true;
+            bool reached = false;
+            for (size_t w = 0; w < words; w++)
+            {
+                next[w] &= ~discovered[w];
+                discovered[w] |= next[w];
+                reached = reached || next[w] != 0;
+                for (uint64_t word = next[w]; word != 0; word &= word - 1)
+                {
+                    if (!discover(w * 64 + static_cast<size_t>(__builtin_ctzll(word)), depth))
+                    {
+                        return false;
+                    }
                 }
             }
+            if (!reached)
+            {
+                return true;
+            }
+            level.swap(next);
         }
+    }
+}
+
+template <typename W>
+int Algorithms::isConnected(const BasicGraph<W> &graph)
+{
+    size_t v = graph.getVertices();
+    if (v == 0)
+    {
+        return 1;
+    }
+    // A directed graph is strongly connected if all its vertices are in one strongly connected component.
+    if (graph.isDirected())
+    {
+        return StronglyConnectedComponents(graph).getComponentCount() == 1;
+    }
+    // The bitset search is cheaper than finding the components, which the other storages keep with the graph.
+    if (graph.getStorage() != GraphBase::Storage::Bitset)
+    {
+        return graph.getConnectivity()->isConnected();
+    }
+    // Do a search starting from the first vertex.
+    // If the search does not visit all vertices, the graph is not connected.
+    return DFSIsConnected(graph, 0);
+}
 
-        cout << "0" << endl;
-        return false;
+template <typename W>
+StronglyConnectedComponents Algorithms::stronglyConnectedComponents(const BasicGraph<W> &graph)
+{
+    return StronglyConnectedComponents(graph);
+}
+
+template <typename W>
+string Algorithms::shortestPath(const BasicGraph<W> &graph, size_t src, size_t dest)
+{
+    size_t n = graph.getVertices();
+    if (src >= n || dest >= n)
+    {
+        throw invalid_argument("Invalid vertex");
     }
+    // The empty path.
+    if (src == dest)
+    {
+        return to_string(src);
+    }
+
+    // Pick the cheapest algorithm that is still correct for the weights of the graph.
+    W lightest = graph.getLightestWeight();
+    W heaviest = graph.getHeaviestWeight();
+    if (lightest > 0 && lightest == heaviest)
+    {
+        // All the edges weigh the same, so the path with the fewest edges is the shortest.
+        return BFSShortestPath(graph, src, dest);
+    }
+    if (lightest >= 0)
+    {
+        return dijkstraShortestPath(graph, src, dest);
+    }
+    return bellmanFordShortestPath(graph, src, dest);
 }
 
-string Algorithms::isBipartite(Graph &graph)
+template <typename W>
+bool Algorithms::isContainsCycle(const BasicGraph<W> &graph)
+{
+    string cycle = "The cycle is:";
+
+    // If the graph is directed, use DFS utility for directed graph, otherwise use DFS utility for undirected graph.
+    bool found = graph.isDirected() ? DFSIsContainsCycleDirected(graph, cycle) : DFSIsContainsCycleUndirected(graph, cycle);
+    if (found)
+    {
+        cout << cycle << endl;
+        return true;
+    }
+
+    cout << "0" << endl;
+    return false;
+}
+
+template <typename W>
+string Algorithms::isBipartite(const BasicGraph<W> &graph)
 {
     // Initialize all vertices as not colored.
     vector<int>::size_type v = graph.getVertices();
     vector<int> color(v, -1);
     string setA = "", setB = "";
 
-    // Call the recursive helper function to check if the graph is bipartite.
-    for (size_t i = 0; i < v; i++)
+    // Color the vertices with two colors, to check if the graph is bipartite.
+    if (!paintGraph(graph, color))
     {
-        // If the vertex is not colored, color it and all connected vertices.
-        if (color[i] == -1)
-        {
-            
-            if (paintGraph(graph, 0, color, i) == "0")
-            {
-                return "0";
-            }
-        }
+        return "0";
     }
 
+    // Every vertex takes at most as many digits as v, plus ", ", so the sets are allocated only once.
+    size_t longest = v * (to_string(v).size() + 2);
+    setA.reserve(longest);
+    setB.reserve(longest);
+
     // Assign vertices to sets A and B based on their color
     for (size_t i = 0; i < v; i++)
     {   
         // If the vertex is colored with 0, add it to set A.
         if (color[i] == 0)
         {
-            setA += to_string(i) + ", ";
+            setA += to_string(i);
+            setA += ", ";
         }
         // If the vertex is colored with 1, add it to set B.
         else if (color[i] == 1)
         {
-            setB += to_string(i) + ", ";
+            setB += to_string(i);
+            setB += ", ";
         }
     }
 
     // Remove the trailing comma and space from each set
     if (!setA.empty())
     {
-        setA = setA.substr(0, setA.size() - 2);
+        setA.resize(setA.size() - 2);
     }
     if (!setB.empty())
     {
-        setB = setB.substr(0, setB.size() - 2);
+        setB.resize(setB.size() - 2);
     }
 
     return "The graph is bipartite: A={" + setA + "}, B={" + setB + "}";
 }
 
-string Algorithms::negativeCycle(Graph &graph)
+template <typename W>
+string Algorithms::negativeCycle(const BasicGraph<W> &graph)
+{
+    // Floyd-Warshall algorithm, or its result from an earlier call.
+    shared_ptr<const BasicAllPairsPaths<W>> paths = graph.getAllPairsPaths();
+    vector<size_t> vertices = paths->getNegativeCycle();
+
+    // No negative cycle found.
+    if (vertices.empty())
+    {
+        return "The graph does not contain a negative cycle";
+    }
+
+    // Reconstruct the path.
+    string cycle = "The negative cycle is:" + to_string(vertices[0]);
+    for (size_t i = 1; i < vertices.size(); i++)
+    {
+        cycle += "->" + to_string(vertices[i]);
+    }
+    return cycle;
+}
+
+string Algorithms::buildPath(const vector<size_t> &parent, size_t src, size_t dest)
 {
-    vector<vector<int>> adjacencyMatrix = graph.getAdjacencyMatrix();
-    vector<int>::size_type n = adjacencyMatrix.size();
-    vector<int>::size_type i, j;
+    // Walk back from the destination to the source, then print the vertices in reverse.
+    vector<size_t> vertices;
+    for (size_t v = dest; v != src; v = parent[v])
+    {
+        vertices.push_back(v);
+    }
+    string path = to_string(src);
+    for (size_t i = vertices.size(); i > 0; i--)
+    {
+        path += "->" + to_string(vertices[i - 1]);
+    }
+    return path;
+}
 
-    // Create a distance matrix and a next matrix.
-    vector<vector<int>> dist(n, vector<int>(n, 0));
-    vector<vector<int>> next(n, vector<int>(n, 0));
-    // Initialize the distance matrix.
-    for (i = 0; i < n; i++)
+template <typename W>
+string Algorithms::BFSShortestPath(const BasicGraph<W> &graph, size_t src, size_t dest)
+{
+    size_t n = graph.getVertices();
+    vector<size_t> parent(n, n);
+    // The queue of the BFS, a vertex is pushed once at most, so it is a fixed array with a read position.
+    vector<size_t> queue;
+    queue.reserve(n);
+    queue.push_back(src);
+    parent[src] = src;
+
+    for (size_t head = 0; head < queue.size(); head++)
     {
-        for (j = 0; j < n; j++)
+        size_t u = queue[head];
+        for (typename BasicGraph<W>::Neighbour neighbour : graph.getRow(u))
         {
-            // If there is no edge between the vertices, set the distance to infinity.
-            if (adjacencyMatrix[i][j] == 0)
+            size_t v = neighbour.vertex;
+            if (parent[v] != n)
             {
-                dist[i][j] = INF;
-                next[i][j] = -1;
+                continue;
             }
-
-            // If there is an edge between the vertices, set the distance to the weight of the edge.
-            else
+            parent[v] = u;
+            // Stop as soon as the destination is reached, no later path can have fewer edges.
+            if (v == dest)
             {
-                dist[i][j] = adjacencyMatrix[i][j];
-                // Set the next matrix.
-                next[i][j] = j;
+                return buildPath(parent, src, dest);
             }
+            queue.push_back(v);
         }
     }
+    return "-1";
+}
 
-    // Floyd-Warshall algorithm.
-    floydWarshall(dist, next);
-
-    // Reconstruct the path.
-    string cycle = "The negative cycle is:";
-
-    for (size_t i = 0; i < n; i++)
+template <typename W>
+string Algorithms::dijkstraShortestPath(const BasicGraph<W> &graph, size_t src, size_t dest)
+{
+    typedef typename WeightTraits<W>::PathLength PathLength;
+    size_t n = graph.getVertices();
+    const PathLength unreached = numeric_limits<PathLength>::max();
+    vector<PathLength> dist(n, unreached);
+    vector<size_t> parent(n, n);
+    vector<bool> settled(n, false);
+    // Binary heap of (distance, vertex), a vertex may be pushed again when its distance drops, stale entries are skipped.
+    priority_queue<pair<PathLength, size_t>, vector<pair<PathLength, size_t>>, greater<pair<PathLength, size_t>>> heap;
+    dist[src] = 0;
+    parent[src] = src;
+    heap.push(make_pair(PathLength(0), src));
+
+    while (!heap.empty())
     {
-        // Check if there is a negative cycle.
-        if (dist[i][i] < 0)
+        size_t u = heap.top().second;
+        heap.pop();
+        if (settled[u])
         {
-            size_t u = i;
-
-            // Do while loop to find the cycle.
-            do
+            continue;
+        }
+        settled[u] = true;
+        // The distance of a settled vertex is final, so stop once the destination is settled.
+        if (u == dest)
+        {
+            return buildPath(parent, src, dest);
+        }
+        for (typename BasicGraph<W>::Neighbour neighbour : graph.getRow(u))
+        {
+            size_t v = neighbour.vertex;
+            PathLength candidate = dist[u] + neighbour.weight;
+            if (!settled[v] && candidate < dist[v])
             {
-                cycle += to_string(u) + "->";
-                u = static_cast<size_t>(next[u][i]);
-            } while (u != i);
-
-            cycle += to_string(i);
-            return cycle;
+                dist[v] = candidate;
+                parent[v] = u;
+                heap.push(make_pair(candidate, v));
+            }
         }
     }
-    // No negative cycle found.
-    return "The graph does not contain a negative cycle";
+    return "-1";
 }
 
-void Algorithms::DFSIsConnected(vector<vector<int>> &adjMat, size_t src, vector<bool> &visited)
+template <typename W>
+string Algorithms::bellmanFordShortestPath(const BasicGraph<W> &graph, size_t src, size_t dest)
 {
-    // Mark the current vertex as visited.
-    visited[src] = true;
-    size_t V = adjMat.size();
-    // Recur for all the vertices adjacent to this vertex.
-    for (size_t i = 0; i < V; i++)
+    typedef typename WeightTraits<W>::PathLength PathLength;
+    size_t n = graph.getVertices();
+    const PathLength unreached = numeric_limits<PathLength>::max();
+    vector<PathLength> dist(n, unreached);
+    vector<size_t> parent(n, n);
+    // Number of edges on the best path found so far, a path of n edges repeats a vertex, so it goes around a negative cycle.
+    vector<size_t> length(n, 0);
+    vector<bool> queued(n, false);
+    vector<bool> onNegativeCycle(n, false);
+    bool negativeCycleFound = false;
+    // SPFA: only the vertices whose distance dropped relax their edges again.
+    deque<size_t> queue;
+    dist[src] = 0;
+    parent[src] = src;
+    queue.push_back(src);
+    queued[src] = true;
+
+    while (!queue.empty())
     {
-        // If the adjacent vertex is connected and not visited, recur.
-        if (adjMat[src][i])
+        size_t u = queue.front();
+        queue.pop_front();
+        queued[u] = false;
+        if (onNegativeCycle[u])
         {
-            if (!visited[i])
+            continue;
+        }
+        for (typename BasicGraph<W>::Neighbour neighbour : graph.getRow(u))
+        {
+            size_t v = neighbour.vertex;
+            PathLength candidate = dist[u] + neighbour.weight;
+            if (onNegativeCycle[v] || candidate >= dist[v])
+            {
+                continue;
+            }
+            dist[v] = candidate;
+            parent[v] = u;
+            length[v] = length[u] + 1;
+            if (length[v] >= n)
             {
-                DFSIsConnected(adjMat, i, visited);
+                // The distance of v can drop forever, stop relaxing from it.
+                onNegativeCycle[v] = true;
+                negativeCycleFound = true;
+            }
+            else if (!queued[v])
+            {
+                queue.push_back(v);
+                queued[v] = true;
             }
         }
     }
-}
-
-void Algorithms::floydWarshall(vector<vector<int>> &allDistances, vector<vector<int>> &next)
-{
-    vector<int>::size_type i, j, k;
-    vector<int>::size_type n = allDistances.size();
 
-    // Add all vertices one by one to the set of intermediate vertices.
-    for (k = 0; k < n; k++)
+    if (negativeCycleFound)
     {
-        // Pick all vertices as source one by one.
-        for (i = 0; i < n; i++)
+        // Every vertex reachable from a negative cycle has no shortest path.
+        BasicDepthFirstSearch<W> search(graph);
+        DepthFirstVisitor visitor;
+        for (size_t v = 0; v < n; v++)
         {
-            // Pick all vertices as destination for the above picked source.
-            for (j = 0; j < n; j++)
+            if (onNegativeCycle[v])
             {
-
-                // If vertex k is on the shortest path from i to j, then update the value of dist[i][j].
-                if (allDistances[i][j] > (allDistances[i][k] + allDistances[k][j]) && (allDistances[k][j] != INF && allDistances[i][k] != INF))
-                {
-                    allDistances[i][j] = allDistances[i][k] + allDistances[k][j];
-                    // Set the next matrix.
-                    next[i][j] = next[i][k];
-                }
+                search.run(v, visitor);
             }
         }
+        if (search.isDiscovered(dest))
+        {
+            return "-1";
+        }
+    }
+    if (dist[dest] == unreached)
+    {
+        return "-1";
     }
+    return buildPath(parent, src, dest);
 }
 
-bool Algorithms::DFSIsContainsCycleDirected(Graph &graph, size_t v, vector<bool> &visited, vector<bool> &recStack, string &cycle)
+template <typename W>
+bool Algorithms::DFSIsConnected(const BasicGraph<W> &graph, size_t src)
 {
-    // Mark the current node as visited and part of the recursion stack.
-    if (!visited[v])
+    if (graph.getStorage() == GraphBase::Storage::Bitset)
     {
-        visited[v] = true;
-        recStack[v] = true;
+        vector<uint64_t> discovered((graph.getVertices() + 63) / 64, 0);
+        size_t reached = 0;
+        bitsetSearch(graph, src, discovered, [&](size_t, size_t)
+        {
+            reached++;
+            return true;
+        });
+        return reached == graph.getVertices();
+    }
 
-        // Recur for all the vertices adjacent to this vertex.
-        vector<vector<int>> adjancencyMatrix = graph.getAdjacencyMatrix();
-        size_t n = adjancencyMatrix[v].size();
+    BasicDepthFirstSearch<W> search(graph);
+    DepthFirstVisitor visitor;
+    search.run(src, visitor);
+    for (size_t i = 0; i < graph.getVertices(); i++)
+    {
+        if (!search.isDiscovered(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
+template <typename W>
+size_t Algorithms::findComponents(const BasicGraph<W> &graph, vector<size_t> &component)
+{
+    component.assign(graph.getVertices(), NO_COMPONENT);
+    BasicDepthFirstSearch<W> search(graph);
+    ComponentVisitor visitor(component);
+    // Search from every vertex that was not visited yet, every search finishes the components it reaches first.
+    for (size_t i = 0; i < graph.getVertices(); i++)
+    {
+        search.run(i, visitor);
+    }
+    return visitor.components;
+}
 
-        for (size_t i = 0; i < n; i++)
+template <typename W>
+void Algorithms::initializeDistances(const BasicGraph<W> &graph, typename WeightTraits<W>::Distance *dist, int *next, size_t stride)
+{
+    typedef typename WeightTraits<W>::Distance Distance;
+    const Distance inf = WeightTraits<W>::infinity();
+    // Floyd-Warshall adds two distances in [-inf, inf] without overflowing, so an integer weight must be in that range.
+    if (!numeric_limits<Distance>::has_infinity &&
+        (static_cast<Distance>(graph.getLightestWeight()) <= -inf || static_cast<Distance>(graph.getHeaviestWeight()) >= inf))
+    {
+        throw invalid_argument("Floyd-Warshall can't handle weights of magnitude " + to_string(inf) + " or more.");
+    }
+    size_t n = graph.getVertices();
+    // If there is no edge between the vertices, the distance is infinity.
+    for (size_t i = 0; i < n; i++)
+    {
+        fill(dist + i * stride, dist + i * stride + n, inf);
+        fill(next + i * stride, next + i * stride + n, -1);
+        for (typename BasicGraph<W>::Neighbour neighbour : graph.getRow(i))
         {
-            // DFS doesn't work with negative edges.
-            if (adjancencyMatrix[v][i] < 0)
+            // If there is an edge between the vertices, set the distance to the weight of the edge.
+            dist[i * stride + neighbour.vertex] = neighbour.weight;
+            // Set the next matrix.
+            next[i * stride + neighbour.vertex] = static_cast<int>(neighbour.vertex);
+        }
+    }
+}
+
+template <typename D>
+void Algorithms::relaxTile(D *dist, int *next, size_t stride, size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd)
+{
+    const D inf = DistanceTraits<D>::infinity();
+    for (size_t k = kBegin; k < kEnd; k++)
+    {
+        const D *distK = dist + k * stride;
+        for (size_t i = iBegin; i < iEnd; i++)
+        {
+            D *distI = dist + i * stride;
+            int *nextI = next + i * stride;
+            D distIK = distI[k];
+            // No path from i to k, so k is not on a path from i.
+            if (distIK == inf)
             {
-                throw invalid_argument("The graph contains a negative edge");
+                continue;
             }
+            int nextIK = nextI[k];
 
-            // If the adjacent vertex is not visited, recur.
-            else if (adjancencyMatrix[v][i])
+            // Branch free min-plus, so the compiler turns it into vector compares and blends.
+            // The values stay in [-inf, inf], so the sum of two of them can't overflow.
+            for (size_t j = jBegin; j < jEnd; j++)
             {
-                if (!visited[i] && DFSIsContainsCycleDirected(graph, i, visited, recStack, cycle))
-                {
-                    cycle += "->" + to_string(v);
-                    return true;
-                }
-
-                // If the adjacent vertex is part of the recursion stack, there is a cycle.
-                else if (recStack[i])
-                {
-                    cycle += "->" + to_string(i);
-                    return true;
-                }
+                D distKJ = distK[j];
+                D through = distIK + distKJ;
+                through = through < -inf ? -inf : through;
+                bool shorter = distKJ != inf && through < distI[j];
+                distI[j] = shorter ? through : distI[j];
+                nextI[j] = shorter ? nextIK : nextI[j];
             }
         }
     }
-    recStack[v] = false;
-
-    return false;
 }
 
-bool Algorithms::DFSIsContainsCycleUndirected(Graph &graph, size_t src, int parent, vector<bool> &visited, string &cycle, vector<int> &parentVec)
+template <typename D>
+void Algorithms::floydWarshall(D *dist, int *next, size_t n, size_t stride)
 {
-    // Mark the current node as visited.
-    visited[src] = true;
-    parentVec[src] = parent;
-    // Recur for all the vertices adjacent to this vertex.
-    vector<vector<int>> adjancencyMatrix = graph.getAdjacencyMatrix();
-    size_t n = adjancencyMatrix[src].size();
+    const size_t tile = FLOYD_WARSHALL_TILE;
+    size_t tiles = (n + tile - 1) / tile;
 
-
-    for (size_t i = 0; i < n; i++)
+    // Blocked Floyd-Warshall: in round kb the intermediate vertices are the ones of tile kb.
+    for (size_t kb = 0; kb < n; kb += tile)
     {
-        // DFS doesn't work with negative edges.
-        if (adjancencyMatrix[src][i] < 0)
-        {
-            throw invalid_argument("The graph contains a negative edge");
-        }
+        size_t kEnd = min(kb + tile, n);
 
-        // If the adjacent vertex is not visited, recur.
-        else if (adjancencyMatrix[src][i] && !visited[i])
+        // The diagonal tile depends only on itself.
+        relaxTile(dist, next, stride, kb, kEnd, kb, kEnd, kb, kEnd);
+
+        // The tiles in the row and the column of the diagonal tile depend on themselves and on the diagonal tile.
+        ThreadPool::instance().parallelFor(tiles, 0, [&](size_t t)
         {
-            if (DFSIsContainsCycleUndirected(graph, i, src, visited, cycle, parentVec))
+            size_t b = t * tile;
+            if (b != kb)
             {
-                return true;
+                size_t bEnd = min(b + tile, n);
+                relaxTile(dist, next, stride, kb, kEnd, b, bEnd, kb, kEnd);
+                relaxTile(dist, next, stride, b, bEnd, kb, kEnd, kb, kEnd);
             }
-        }
-        // If an adjacent is visited and not parent of the current vertex, then there is a cycle.
-        else if (adjancencyMatrix[src][i] && i != parent)
+        });
+
+        // Every other tile depends only on the tile in its row and the tile in its column.
+        // A thread takes a whole row of tiles, so it reads the tile of the row once.
+        ThreadPool::instance().parallelFor(tiles, 0, [&](size_t t)
         {
-            cycle = "The cycle is:" + to_string(i);
-            
-            // Loop to find the cycle.
-            for (size_t j = src; j != i; j = static_cast<size_t> (parentVec[j]))
+            size_t ib = t * tile;
+            if (ib == kb)
+            {
+                return;
+            }
+            for (size_t jb = 0; jb < n; jb += tile)
             {
-                cycle += "->" + to_string(j);
+                if (jb != kb)
+                {
+                    relaxTile(dist, next, stride, ib, min(ib + tile, n), jb, min(jb + tile, n), kb, kEnd);
+                }
             }
-            cycle += "->" + to_string(i);
+        });
+    }
+}
+
+void Algorithms::setThreadCount(size_t threads)
+{
+    ThreadPool::setThreadCount(threads);
+}
+
+size_t Algorithms::getThreadCount()
+{
+    return ThreadPool::getThreadCount();
+}
+
+template <typename W>
+bool Algorithms::DFSIsContainsCycleDirected(const BasicGraph<W> &graph, string &cycle)
+{
+    BasicDepthFirstSearch<W> search(graph);
+    DirectedCycleVisitor visitor(graph.getVertices(), cycle);
+    // Search from every vertex that was not visited yet, to detect cycle in different DFS trees.
+    for (size_t i = 0; i < graph.getVertices(); i++)
+    {
+        if (!search.run(i, visitor))
+        {
             return true;
         }
     }
     return false;
 }
 
-string Algorithms::paintGraph(Graph &graph, size_t c, vector<int> &color, size_t pos)
+template <typename W>
+bool Algorithms::DFSIsContainsCycleUndirected(const BasicGraph<W> &graph, string &cycle)
 {
-    // If the current vertex is already colored with the same color, the graph is not bipartite.
-    if (color[pos] != -1 && color[pos] != c)
+    BasicDepthFirstSearch<W> search(graph);
+    UndirectedCycleVisitor visitor(graph.getVertices(), cycle);
+    // Search from every vertex that was not visited yet, to detect cycle in different DFS trees.
+    for (size_t i = 0; i < graph.getVertices(); i++)
     {
-        return "0";
+        if (!search.run(i, visitor))
+        {
+            return true;
+        }
     }
+    return false;
+}
 
-    // Color the pos as c and all its adjacent as 1-c.
-    color[pos] = c;
-    string res = to_string(pos) + ", ";
-
-    // Recur for all the vertices adjacent to this vertex.
-    // vector<int>::iterator i;
-    vector<vector<int>> adjancencyMatrix = graph.getAdjacencyMatrix();
-    size_t v = graph.getVertices();
-    for (size_t i = 0; i < v; i++)
+template <typename W>
+bool Algorithms::paintGraph(const BasicGraph<W> &graph, vector<int> &color)
+{
+    size_t n = graph.getVertices();
+    if (graph.getStorage() == GraphBase::Storage::Bitset)
     {
-        // If the adjacent vertex is connected
-        if (adjancencyMatrix[pos][i])
+        size_t words = (n + 63) / 64;
+        vector<uint64_t> discovered(words, 0);
+        // The vertices of color 0 and of color 1.
+        vector<uint64_t> colored[2] = {vector<uint64_t>(words, 0), vector<uint64_t>(words, 0)};
+        // An edge leaving a vertex to a vertex of its color that was colored before it is found as soon as the vertex is colored.
+        auto paint = [&](size_t v, size_t depth)
         {
-            // If the adjacent vertex is not colored, color it with 1-c and recur.
-            if (color[i] == -1)
+            const uint64_t *row = graph.getRow(v).bits();
+            vector<uint64_t> &same = colored[depth % 2];
+            color[v] = static_cast<int>(depth % 2);
+            same[v / 64] |= uint64_t(1) << (v % 64);
+            for (size_t w = 0; w < words; w++)
             {
-                string temp = paintGraph(graph, 1 - c, color, i);
-                if (temp == "0")
+                if ((row[w] & same[w]) != 0)
                 {
-                    return "0";
+                    return false;
                 }
-                res += temp;
             }
-
-            // If the adjacent vertex is already colored with the same color, the graph is not bipartite.
-            if (color[i] != -1 && color[i] != 1 - c)
+            return true;
+        };
+        for (size_t i = 0; i < n; i++)
+        {
+            if (((discovered[i / 64] >> (i % 64)) & 1) == 0 && !bitsetSearch(graph, i, discovered, paint))
+            {
+                return false;
+            }
+        }
+        // In an undirected graph the other edges are found from their other end, a directed graph checks them once colored.
+        for (size_t u = 0; graph.isDirected() && u < n; u++)
+        {
+            const uint64_t *row = graph.getRow(u).bits();
+            const vector<uint64_t> &same = colored[color[u] == 0 ? 0 : 1];
+            for (size_t w = 0; w < words; w++)
             {
-                return "0";
+                if ((row[w] & same[w]) != 0)
+                {
+                    return false;
+                }
             }
         }
+        return true;
+    }
+
+    BasicDepthFirstSearch<W> search(graph);
+    ColoringVisitor visitor(color);
+    // If the vertex is not colored, color it and all connected vertices.
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!search.run(i, visitor))
+        {
+            return false;
+        }
     }
-    
-    return res;
+    return true;
 }
+
+// The algorithms on the graphs of every weight type.
+#define ARIEL_INSTANTIATE_ALGORITHMS(W)                                                                               \
+    template int Algorithms::isConnected(const BasicGraph<W> &graph);                                                 \
+    template StronglyConnectedComponents Algorithms::stronglyConnectedComponents(const BasicGraph<W> &graph);         \
+    template string Algorithms::shortestPath(const BasicGraph<W> &graph, size_t src, size_t dest);                    \
+    template bool Algorithms::isContainsCycle(const BasicGraph<W> &graph);                                            \
+    template string Algorithms::isBipartite(const BasicGraph<W> &graph);                                              \
+    template string Algorithms::negativeCycle(const BasicGraph<W> &graph);                                            \
+    template size_t Algorithms::findComponents(const BasicGraph<W> &graph, vector<size_t> &component);               \
+    template void Algorithms::initializeDistances(const BasicGraph<W> &graph, WeightTraits<W>::Distance *dist, int *next, size_t stride);
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_ALGORITHMS)
+
+// Floyd-Warshall for every type of distances, 8 and 16 bit weights have int distances, 32 and 64 bit weights int64_t.
+template void Algorithms::floydWarshall(int *dist, int *next, size_t n, size_t stride);
+template void Algorithms::floydWarshall(int64_t *dist, int *next, size_t n, size_t stride);
+template void Algorithms::floydWarshall(float *dist, int *next, size_t n, size_t stride);
+template void Algorithms::floydWarshall(double *dist, int *next, size_t n, size_t stride);
@@ -5,11 +5,13 @@
 #define _ALGORITHMS_HPP_
 #include <iostream>
 #include <string>
+#include <limits>
 #include "Graph.hpp"
 using namespace std;
 namespace ariel
 {
-    
+    class StronglyConnectedComponents;
+
     class Algorithms
     {
     public:
@@ -18,24 +20,40 @@ namespace ariel
         * @brief
         * This function checks if the graph is connected.
         * A graph is connected if there is a path between every pair of vertices.
-        * A directed graph is strongly connected if there is a path between every pair of vertices.
+        * A directed graph is strongly connected if there is a path between every pair of vertices,
+        * it is checked with its strongly connected components, without building the transposed graph.
+        * An undirected graph is checked with the connected components the graph keeps (Graph::getConnectivity),
+        * so it takes O(1) once they are found, also after operator+= added edges to it.
         * @param graph - Graph object.
         * @return int 1 if the graph is connected, 0 otherwise.
         */
+        template <typename W>
+        static int isConnected(const BasicGraph<W> &graph);
 
-        static int isConnected(Graph &graph);
+        /*
+        * @brief
+        * This function finds the strongly connected components of the graph, and the condensation between them, in O(V+E).
+        * @param graph - Graph object.
+        * @return StronglyConnectedComponents - the component of every vertex, the size of every component and the condensation.
+        */
+        template <typename W>
+        static StronglyConnectedComponents stronglyConnectedComponents(const BasicGraph<W> &graph);
 
         /*
         * @brief
         * This function finds the shortest path between two vertices.
         * The function returns the shortest path as a string.
+        * It uses BFS if all the edges have the same positive weight, Dijkstra if there is no negative edge,
+        * and Bellman-Ford (SPFA) otherwise. BFS and Dijkstra stop as soon as dest is reached.
         * @param graph - Graph object.
         * @param src - source vertex.
         * @param dest - destination vertex.
-        * @return string - shortest path between src and dest.
+        * @return string - shortest path between src and dest, src itself if src == dest,
+        * "-1" if dest can't be reached or a negative cycle on the way makes the path arbitrarily short.
+        * @throw invalid_argument - if src or dest is not a vertex of the graph.
         */
-
-        static string shortestPath(Graph &graph, size_t src, size_t dest);
+        template <typename W>
+        static string shortestPath(const BasicGraph<W> &graph, size_t src, size_t dest);
 
         /*
         * @brief
@@ -45,7 +63,8 @@ namespace ariel
         * @return string - the cycle if the graph contains a cycle or "0" otherwise.
         */
        
-        static bool isContainsCycle(Graph &graph);
+        template <typename W>
+        static bool isContainsCycle(const BasicGraph<W> &graph);
 
         /*
         * @brief
@@ -54,70 +73,174 @@ namespace ariel
         * @param graph - Graph object.
         * @return string - the two disjoint sets if the graph is bipartite, "Graph is not bipartite" otherwise.
         */
-        static string isBipartite(Graph &graph);
+        template <typename W>
+        static string isBipartite(const BasicGraph<W> &graph);
 
         /*
         * @brief
         * This function checks if the graph contains a negative cycle.
         * A negative cycle is a cycle whose edges sum to a negative value.
+        * It uses the all-pairs shortest paths of the graph, so only the first call on an unchanged graph runs Floyd-Warshall.
         * @param graph - Graph object.
-        * 
+        * @return string - the negative cycle, or a message that there is none.
         */
-        static string negativeCycle(Graph &graph);
+        template <typename W>
+        static string negativeCycle(const BasicGraph<W> &graph);
+
+        /*
+        * @brief
+        * This function sets the number of threads the all-pairs shortest path algorithms and the graph product run on.
+        * It is the default of the whole library, see ThreadPool::setThreadCount.
+        * @param threads - number of threads, 1 runs on the calling thread only, 0 uses every hardware thread.
+        * @return void
+        */
+        static void setThreadCount(size_t threads);
+
+        /*
+        * @brief
+        * This function returns the number of threads the all-pairs shortest path algorithms and the graph product run on.
+        * @return size_t - number of threads, at least 1.
+        */
+        static size_t getThreadCount();
 
     private:
-         /*
+        // AllPairsPaths runs the Floyd-Warshall of the class, StronglyConnectedComponents its search for components.
+        template <typename W>
+        friend class BasicAllPairsPaths;
+        friend class StronglyConnectedComponents;
+
+        // Side of the square tiles of the blocked Floyd-Warshall, a tile of distances and its next cells fit in the L2 cache.
+        static const size_t FLOYD_WARSHALL_TILE = 64;
+
+        /*
         * @brief
-        * This function solves all-pairs shortest path, using Floyd-Warshall algorithm.
-        * The function returns the shortest path between all pairs of vertices.
-        * @param adjancencyMatrix - 2D vector representing the graph.
+        * This function fills the distance and next matrices of Floyd-Warshall from the edges of the graph.
+        * A cell with no edge gets WeightTraits<W>::infinity() and -1, the diagonal too unless there is a self loop.
+        * @param graph - Graph object.
+        * @param dist - n x n distance matrix, row i starts at dist[i * stride].
+        * @param next - n x n next matrix, laid out like dist.
+        * @param stride - distance between the starts of two rows.
         * @return void
-        *
+        * @throw invalid_argument - if an integer weight is not strictly between -infinity() and infinity(),
+        * which only a 64 bit weight can be.
         */
-        static void floydWarshall(vector<vector<int>> &allDistances, vector<vector<int>> &next);
+        template <typename W>
+        static void initializeDistances(const BasicGraph<W> &graph, typename WeightTraits<W>::Distance *dist, int *next, size_t stride);
 
         /*
         * @brief
-        * This function uses DFS algorithm to check if the graph is connected.
-        * @param adjMat - adjacency matrix.
-        * @param src - source vertex.
-        * @param visited - array of visited vertices.
+        * This function solves all-pairs shortest path, using the blocked (tiled) Floyd-Warshall algorithm.
+        * The tiles of the second and third phase of every round are independent, they are relaxed on getThreadCount() threads.
+        * On return dist holds the shortest distances, and next[i][j] the vertex after i on a shortest path from i to j.
+        * The distances are of type D, DistanceTraits<D>::infinity() is the distance of a pair with no path, and integer
+        * distances are clamped to [-infinity, infinity], which only matters with negative cycles.
+        * @param dist - n x n distance matrix, row i starts at dist[i * stride].
+        * @param next - n x n next matrix, laid out like dist.
+        * @param n - number of vertices.
+        * @param stride - distance between the starts of two rows.
+        * @return void
+        */
+        template <typename D>
+        static void floydWarshall(D *dist, int *next, size_t n, size_t stride);
+
+        /*
+        * @brief
+        * This function relaxes the cells of a tile of the distance matrix through the intermediate vertices kBegin .. kEnd - 1.
+        * @param dist - the distance matrix.
+        * @param next - the next matrix.
+        * @param stride - distance between the starts of two rows.
+        * @param iBegin, iEnd - the rows of the tile.
+        * @param jBegin, jEnd - the columns of the tile.
+        * @param kBegin, kEnd - the intermediate vertices.
         * @return void
         */
-        static void DFSIsConnected(vector<vector<int>> &adjMat, size_t src, vector<bool> &visited);
+        template <typename D>
+        static void relaxTile(D *dist, int *next, size_t stride, size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd, size_t kBegin, size_t kEnd);
+
+        /*
+        * @brief
+        * This function prints the path from src to dest, following the parent of every vertex back from dest.
+        * @param parent - the vertex before every vertex on the path.
+        * @param src - source vertex.
+        * @param dest - destination vertex.
+        * @return string - the path as "src->...->dest".
+        */
+        static string buildPath(const vector<size_t> &parent, size_t src, size_t dest);
+
+        /*
+        * @brief
+        * These functions find the shortest path between two different vertices.
+        * BFSShortestPath requires all the edges to weigh the same, dijkstraShortestPath requires no negative edge.
+        * @param graph - Graph object.
+        * @param src - source vertex.
+        * @param dest - destination vertex.
+        * @return string - shortest path between src and dest, "-1" if there is none.
+        */
+        template <typename W>
+        static string BFSShortestPath(const BasicGraph<W> &graph, size_t src, size_t dest);
+        template <typename W>
+        static string dijkstraShortestPath(const BasicGraph<W> &graph, size_t src, size_t dest);
+        template <typename W>
+        static string bellmanFordShortestPath(const BasicGraph<W> &graph, size_t src, size_t dest);
+
+        /*
+        * @brief
+        * This function uses DFS algorithm to check if every vertex can be reached from the source vertex.
+        * It only looks at the neighbours of every vertex, so it takes O(V+E) on a sparse graph.
+        * In bitset storage it searches breadth first, 64 vertices at a time.
+        * @param graph - Graph object.
+        * @param src - source vertex.
+        * @return bool true if DFS from src visits every vertex, false otherwise.
+        */
+        template <typename W>
+        static bool DFSIsConnected(const BasicGraph<W> &graph, size_t src);
+
+        /*
+        * @brief
+        * This function finds the strongly connected components of the graph with Tarjan's algorithm, on the iterative DFS.
+        * The components are numbered in the order their search finishes, so an edge between two components
+        * always enters the one with the smaller number.
+        * @param graph - Graph object.
+        * @param component - set to the number of the component of every vertex.
+        * @return size_t - the number of components.
+        */
+        template <typename W>
+        static size_t findComponents(const BasicGraph<W> &graph, vector<size_t> &component);
 
         /*
         * @brief
         * This function uses DFS algorithm to check if an directed graph contains a cycle.
         * @param graph - Graph object.
-        * @param v - source vertex.
-        * @param visited - array of visited vertices.
-        * @param recStack - array of vertices in the recursion stack.
+        * @param cycle - the cycle is appended to it if one is found.
         * @return bool true if the graph contains a cycle, false otherwise.
+        * @throw invalid_argument - if DFS reaches a negative edge.
         */
-        static bool DFSIsContainsCycleDirected(Graph &graph, size_t v, vector<bool> &visited, vector<bool> &recStack, string &cycle);
+        template <typename W>
+        static bool DFSIsContainsCycleDirected(const BasicGraph<W> &graph, string &cycle);
 
         /*
         * @brief
         * This function uses DFS algorithm to check if an undirected graph contains a cycle.
         * @param graph - Graph object.
-        * @param v - source vertex.
-        * @param parent - parent vertex.
-        * @param visited - array of visited vertices.
+        * @param cycle - set to the cycle if one is found.
         * @return bool true if the graph contains a cycle, false otherwise.
+        * @throw invalid_argument - if DFS reaches a negative edge.
         */
-        static bool DFSIsContainsCycleUndirected(Graph &graph, size_t v, int parent, vector<bool> &visited, string &cycle, vector<int> &parentVec);
+        template <typename W>
+        static bool DFSIsContainsCycleUndirected(const BasicGraph<W> &graph, string &cycle);
 
         /*
         * @brief
         * This function colors the vertices of the graph using two colors, to check if the graph is bipartite.
+        * In bitset storage it colors the vertices breadth first and checks the rows against the vertices of each color
+        * 64 at a time. A vertex gets the color of the parity of its depth either way, so when every edge joins two colors
+        * both searches give the same colors, and when one coloring fails so does the other.
         * @param graph - Graph object.
-        * @param v - source vertex.
-        * @param color - array of colors.
-        * @param pos - current position.
-        * @return string the two disjoint sets if the graph is bipartite, "Graph is not bipartite" otherwise.
+        * @param color - array of colors, filled with 0 and 1.
+        * @return bool true if the graph can be colored, false otherwise.
         */
-       static string paintGraph(Graph &graph, size_t c, vector<int> &color, size_t pos); 
+       template <typename W>
+       static bool paintGraph(const BasicGraph<W> &graph, vector<int> &color); 
        
     };
     
@@ -0,0 +1,151 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _ALIGNED_BUFFER_HPP_
+#define _ALIGNED_BUFFER_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+#include <memory>
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * This function returns the number of buffers allocated by AlignedBuffer since the program started.
+    * They do not go through operator new, AllocationCounter adds them to its count.
+    * @return atomic<size_t>& - the counter.
+    */
+    inline atomic<size_t> &alignedBufferAllocations()
+    {
+        static atomic<size_t> count(0);
+        return count;
+    }
+
+    /*
+    * @brief
+    * A fixed size array that lives in a single, cache-line aligned heap allocation.
+    * The elements must be trivially copyable, the buffer is copied with memcpy and is always zero initialized.
+    * A buffer may also use memory it does not own, such as a mapped file, which its owner keeps alive
+    * as long as a buffer uses it. A copy of such a buffer is an ordinary one.
+    */
+    template <typename T>
+    class AlignedBuffer
+    {
+    private:
+        T *elements;
+        size_t length;
+        // The owner of memory the buffer does not allocate itself, nullptr for a heap allocation.
+        shared_ptr<const void> owner;
+
+        static T *allocate(size_t n)
+        {
+            if (n == 0)
+            {
+                return nullptr;
+            }
+            void *memory = nullptr;
+            if (posix_memalign(&memory, ALIGNMENT, n * sizeof(T)) != 0)
+            {
+                throw bad_alloc();
+            }
+            alignedBufferAllocations().fetch_add(1, memory_order_relaxed);
+            return static_cast<T *>(memory);
+        }
+
+    public:
+        // Alignment of the first element, in bytes.
+        static const size_t ALIGNMENT = 64;
+
+        /*
+        * @brief
+        * This function returns the number of elements to reserve for every row of a matrix with the given number of columns,
+        * so every row starts on a cache line, and walking down a column does not map every row to the same cache sets.
+        * @param columns - number of columns.
+        * @return size_t - the row stride, in elements.
+        */
+        static size_t rowStride(size_t columns)
+        {
+            const size_t line = ALIGNMENT / sizeof(T);
+            // Row strides that are a multiple of this many bytes alias in the cache when walking down a column.
+            const size_t cacheSetStride = 1024 / sizeof(T);
+            size_t stride = (columns + line - 1) / line * line;
+            // A stride of a large power of two maps a whole column to the same cache sets, skip one cache line.
+            if (stride % cacheSetStride == 0)
+            {
+                stride += line;
+            }
+            return stride;
+        }
+
+        AlignedBuffer() : elements(nullptr), length(0) {}
+
+        explicit AlignedBuffer(size_t n) : elements(allocate(n)), length(n)
+        {
+            if (n != 0)
+            {
+                memset(this->elements, 0, n * sizeof(T));
+            }
+        }
+
+        /*
+        * @brief
+        * This constructor uses memory that belongs to someone else, in place, without copying it.
+        * @param elements - the first element, aligned to ALIGNMENT.
+        * @param n - number of elements.
+        * @param owner - keeps the memory alive, released when no buffer uses the memory any more.
+        */
+        AlignedBuffer(T *elements, size_t n, shared_ptr<const void> owner) : elements(elements), length(n), owner(move(owner)) {}
+
+        AlignedBuffer(const AlignedBuffer &other) : elements(allocate(other.length)), length(other.length)
+        {
+            if (this->length != 0)
+            {
+                memcpy(this->elements, other.elements, this->length * sizeof(T));
+            }
+        }
+
+        AlignedBuffer(AlignedBuffer &&other) noexcept : elements(other.elements), length(other.length), owner(move(other.owner))
+        {
+            other.elements = nullptr;
+            other.length = 0;
+        }
+
+        AlignedBuffer &operator=(AlignedBuffer other) noexcept
+        {
+            this->swap(other);
+            return *this;
+        }
+
+        ~AlignedBuffer()
+        {
+            if (!this->owner)
+            {
+                free(this->elements);
+            }
+        }
+
+        void swap(AlignedBuffer &other) noexcept
+        {
+            T *elements = this->elements;
+            size_t length = this->length;
+            this->elements = other.elements;
+            this->length = other.length;
+            other.elements = elements;
+            other.length = length;
+            this->owner.swap(other.owner);
+        }
+
+        T *data() { return this->elements; }
+        const T *data() const { return this->elements; }
+        size_t size() const { return this->length; }
+        T &operator[](size_t i) { return this->elements[i]; }
+        const T &operator[](size_t i) const { return this->elements[i]; }
+    };
+}
+
+#endif
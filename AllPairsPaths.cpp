@@ -0,0 +1,180 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include "AllPairsPaths.hpp"
+#include "Algorithms.hpp"
+using ariel::BasicAllPairsPaths;
+using ariel::BasicGraph;
+using ariel::Algorithms;
+using namespace std;
+
+template <typename W>
+constexpr typename BasicAllPairsPaths<W>::Distance BasicAllPairsPaths<W>::NO_PATH;
+
+template <typename W>
+BasicAllPairsPaths<W>::BasicAllPairsPaths(const BasicGraph<W> &graph)
+{
+    size_t n = graph.getVertices();
+    this->vertices = n;
+    this->stride = AlignedBuffer<Distance>::rowStride(n);
+    this->dist = AlignedBuffer<Distance>(n * this->stride);
+    this->next = AlignedBuffer<int>(n * this->stride);
+    Algorithms::initializeDistances(graph, this->dist.data(), this->next.data(), this->stride);
+    Algorithms::floydWarshall(this->dist.data(), this->next.data(), n, this->stride);
+
+    // The diagonal holds the shortest cycle through every vertex.
+    this->negativeCycle = false;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (this->dist[i * this->stride + i] < 0)
+        {
+            this->negativeCycle = true;
+        }
+    }
+    if (this->negativeCycle)
+    {
+        this->findNegativeCycle(graph);
+    }
+}
+
+template <typename W>
+void BasicAllPairsPaths<W>::findNegativeCycle(const BasicGraph<W> &graph)
+{
+    size_t n = this->vertices;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (this->dist[i * this->stride + i] >= 0)
+        {
+            continue;
+        }
+        // Follow the next matrix from i back to i, and keep the cycle if its edges really sum to a negative value.
+        typename WeightTraits<W>::PathLength weight = 0;
+        bool edges = true;
+        size_t u = i;
+        do
+        {
+            this->cycle.push_back(u);
+            size_t v = static_cast<size_t>(this->next[u * this->stride + i]);
+            W w = graph.getWeight(u, v);
+            edges = edges && w != 0;
+            weight += w;
+            u = v;
+        } while (u != i && this->cycle.size() < n);
+
+        if (u == i && edges && weight < 0)
+        {
+            this->cycle.push_back(i);
+            return;
+        }
+        this->cycle.clear();
+    }
+
+    // Bellman-Ford from a virtual source with an edge of weight 0 to every vertex.
+    // A vertex still relaxed in the n-th round has a negative cycle on the chain of its parents.
+    vector<typename WeightTraits<W>::PathLength> distance(n, 0);
+    vector<size_t> parent(n, n);
+    size_t relaxed = n;
+    for (size_t round = 0; round < n; round++)
+    {
+        relaxed = n;
+        for (size_t v = 0; v < n; v++)
+        {
+            for (typename BasicGraph<W>::Neighbour neighbour : graph.getRow(v))
+            {
+                if (distance[v] + neighbour.weight < distance[neighbour.vertex])
+                {
+                    distance[neighbour.vertex] = distance[v] + neighbour.weight;
+                    parent[neighbour.vertex] = v;
+                    relaxed = neighbour.vertex;
+                }
+            }
+        }
+        if (relaxed == n)
+        {
+            return;
+        }
+    }
+
+    // n steps back from the relaxed vertex end on the cycle, then the parents lead around it backwards.
+    size_t start = relaxed;
+    for (size_t step = 0; step < n; step++)
+    {
+        start = parent[start];
+    }
+    size_t v = start;
+    do
+    {
+        this->cycle.push_back(v);
+        v = parent[v];
+    } while (v != start);
+    this->cycle.push_back(start);
+    reverse(this->cycle.begin(), this->cycle.end());
+}
+
+template <typename W>
+void BasicAllPairsPaths<W>::checkQuery(size_t src, size_t dest) const
+{
+    if (src >= this->vertices || dest >= this->vertices)
+    {
+        throw invalid_argument("Invalid vertex");
+    }
+    if (this->negativeCycle)
+    {
+        throw invalid_argument("The graph contains a negative cycle");
+    }
+}
+
+template <typename W>
+size_t BasicAllPairsPaths<W>::getVertices() const
+{
+    return this->vertices;
+}
+
+template <typename W>
+bool BasicAllPairsPaths<W>::hasNegativeCycle() const
+{
+    return this->negativeCycle;
+}
+
+template <typename W>
+vector<size_t> BasicAllPairsPaths<W>::getNegativeCycle() const
+{
+    return this->cycle;
+}
+
+template <typename W>
+typename BasicAllPairsPaths<W>::Distance BasicAllPairsPaths<W>::getDistance(size_t src, size_t dest) const
+{
+    this->checkQuery(src, dest);
+    if (src == dest)
+    {
+        return 0;
+    }
+    Distance distance = this->dist[src * this->stride + dest];
+    return distance == WeightTraits<W>::infinity() ? NO_PATH : distance;
+}
+
+template <typename W>
+vector<size_t> BasicAllPairsPaths<W>::getPath(size_t src, size_t dest) const
+{
+    this->checkQuery(src, dest);
+    vector<size_t> path;
+    if (src != dest && this->dist[src * this->stride + dest] == WeightTraits<W>::infinity())
+    {
+        return path;
+    }
+    path.push_back(src);
+    for (size_t u = src; u != dest;)
+    {
+        u = static_cast<size_t>(this->next[u * this->stride + dest]);
+        path.push_back(u);
+    }
+    return path;
+}
+
+// The paths of the graphs of every weight type.
+#define ARIEL_INSTANTIATE_ALL_PAIRS_PATHS(W) \
+    template class ariel::BasicAllPairsPaths<W>;
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_ALL_PAIRS_PATHS)
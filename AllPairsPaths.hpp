@@ -0,0 +1,116 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _ALL_PAIRS_PATHS_HPP_
+#define _ALL_PAIRS_PATHS_HPP_
+
+#include <vector>
+#include <limits>
+#include "AlignedBuffer.hpp"
+#include "Graph.hpp"
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * The shortest paths between all the pairs of vertices of a graph, computed once with Floyd-Warshall.
+    * The distance of a pair is read in O(1) and a path is rebuilt in O(length of the path).
+    * The object does not change, and does not follow later changes of the graph it was computed from,
+    * use Graph::getAllPairsPaths to get the paths of the graph as it is now.
+    * The distances of a graph of weight type W are WeightTraits<W>::Distance, int for 8 and 16 bit weights and int64_t for 32 bit weights.
+    */
+    template <typename W>
+    class BasicAllPairsPaths
+    {
+    public:
+        // The type of the distances.
+        typedef typename WeightTraits<W>::Distance Distance;
+
+    private:
+        size_t vertices;
+        size_t stride;
+        // dist[i * stride + j] is the length of the shortest path with at least one edge from i to j,
+        // next[i * stride + j] the vertex after i on it.
+        AlignedBuffer<Distance> dist;
+        AlignedBuffer<int> next;
+        bool negativeCycle;
+        // A negative cycle of the graph, found when the paths are computed, empty if there is none.
+        vector<size_t> cycle;
+
+        /*
+        * @brief
+        * This function finds a negative cycle of a graph that has one.
+        * The next matrix is followed first, but once the distances pass through a negative cycle it may lead
+        * around a cycle that is not negative, so such a cycle is checked against the edges of the graph,
+        * and if none is negative Bellman-Ford from every vertex at once finds one in O(V*E).
+        * @param graph - the graph the paths were computed from.
+        * @return void
+        */
+        void findNegativeCycle(const BasicGraph<W> &graph);
+
+        /*
+        * @brief
+        * This function throws if a vertex is not a vertex of the graph, or if the distances are meaningless.
+        * @param src - source vertex.
+        * @param dest - destination vertex.
+        * @return void
+        * @throw invalid_argument - if src or dest is not a vertex, or if the graph contains a negative cycle.
+        */
+        void checkQuery(size_t src, size_t dest) const;
+
+    public:
+        // The distance between two vertices with no path between them.
+        static constexpr Distance NO_PATH = numeric_limits<Distance>::max();
+
+        /*
+        * @brief
+        * Constructor, computes the shortest paths of the graph on Algorithms::getThreadCount() threads.
+        * @param graph - Graph object.
+        */
+        explicit BasicAllPairsPaths(const BasicGraph<W> &graph);
+
+        /*
+        * @brief
+        * This function returns the number of vertices of the graph the paths were computed from.
+        * @return size_t - number of vertices.
+        */
+        size_t getVertices() const;
+
+        /*
+        * @brief
+        * This function checks if the graph contains a negative cycle, in which case there are no shortest paths.
+        * @return bool - true if the graph contains a negative cycle, false otherwise.
+        */
+        bool hasNegativeCycle() const;
+
+        /*
+        * @brief
+        * This function returns a negative cycle of the graph.
+        * @return vector<size_t> - the vertices of the cycle, starting and ending with the same vertex, empty if there is none.
+        */
+        vector<size_t> getNegativeCycle() const;
+
+        /*
+        * @brief
+        * This function returns the length of the shortest path from src to dest, in O(1).
+        * @param src - source vertex.
+        * @param dest - destination vertex.
+        * @return Distance - the sum of the weights on the path, 0 if src == dest, NO_PATH if dest can't be reached.
+        * @throw invalid_argument - if src or dest is not a vertex, or if the graph contains a negative cycle.
+        */
+        Distance getDistance(size_t src, size_t dest) const;
+
+        /*
+        * @brief
+        * This function returns the shortest path from src to dest, in O(length of the path).
+        * @param src - source vertex.
+        * @param dest - destination vertex.
+        * @return vector<size_t> - the vertices of the path from src to dest, empty if dest can't be reached.
+        * @throw invalid_argument - if src or dest is not a vertex, or if the graph contains a negative cycle.
+        */
+        vector<size_t> getPath(size_t src, size_t dest) const;
+    };
+}
+
+#endif
@@ -0,0 +1,72 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.hpp"
+#include "AlignedBuffer.hpp"
+using ariel::AllocationCounter;
+using namespace std;
+
+static atomic<size_t> allocations(0);
+
+static void *countedAllocate(size_t size)
+{
+    allocations++;
+    // malloc(0) may return nullptr, but operator new must return a unique pointer.
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new(size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return countedAllocate(size);
+}
+
+// std::stable_sort takes its buffer with the nothrow form, it must come from malloc as well, to be freed below.
+void *operator new(size_t size, const nothrow_t &) noexcept
+{
+    allocations++;
+    return malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const nothrow_t &) noexcept
+{
+    allocations++;
+    return malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    free(memory);
+}
+
+AllocationCounter::AllocationCounter()
+{
+    this->start = AllocationCounter::getTotalAllocations();
+}
+
+size_t AllocationCounter::getAllocations() const
+{
+    return AllocationCounter::getTotalAllocations() - this->start;
+}
+
+size_t AllocationCounter::getTotalAllocations()
+{
+    return allocations.load() + ariel::alignedBufferAllocations().load();
+}
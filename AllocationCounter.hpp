@@ -0,0 +1,42 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _ALLOCATION_COUNTER_HPP_
+#define _ALLOCATION_COUNTER_HPP_
+
+#include <cstddef>
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * Counts the heap allocations made through operator new and the aligned buffers of Graph since the counter was created.
+    * Linking AllocationCounter.cpp replaces the global operator new and delete of the program with counting versions.
+    */
+    class AllocationCounter
+    {
+    private:
+        size_t start;
+
+    public:
+        // Constructor, starts counting from now.
+        AllocationCounter();
+
+        /*
+        * @brief
+        * This function returns the number of allocations made since the counter was created.
+        * @return size_t - number of allocations.
+        */
+        size_t getAllocations() const;
+
+        /*
+        * @brief
+        * This function returns the number of allocations made since the program started.
+        * @return size_t - number of allocations.
+        */
+        static size_t getTotalAllocations();
+    };
+}
+
+#endif
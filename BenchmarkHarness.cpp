@@ -0,0 +1,322 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <stdexcept>
+#include <thread>
+#include "BenchmarkHarness.hpp"
+using namespace std;
+using namespace ariel;
+
+// A case stops at the deadline only once it has this many samples.
+static const size_t MIN_SAMPLES = 3;
+
+static double nanoseconds(chrono::steady_clock::duration d)
+{
+    return chrono::duration<double, nano>(d).count();
+}
+
+BenchmarkState::BenchmarkState(size_t vertices, double density, size_t repetitions, size_t warmups, double minSampleMilliseconds, double maxSeconds)
+{
+    this->vertices = vertices;
+    this->density = density;
+    this->repetitions = max(repetitions, static_cast<size_t>(1));
+    this->warmupsLeft = warmups;
+    this->minSampleNanoseconds = minSampleMilliseconds * 1e6;
+    this->maxTime = chrono::duration_cast<Clock::duration>(chrono::duration<double>(maxSeconds));
+    this->started = false;
+    this->pausedNanoseconds = 0;
+    this->batch = 1;
+    this->remaining = 0;
+    this->iterations = 0;
+    this->bytesProcessed = 0;
+}
+
+bool BenchmarkState::keepRunning()
+{
+    // Inside a batch only a counter is touched, the clock is read at the ends of the batch.
+    if (this->remaining > 0)
+    {
+        this->remaining--;
+        return true;
+    }
+    Clock::time_point now = Clock::now();
+    if (!this->started)
+    {
+        this->started = true;
+        this->deadline = now + this->maxTime;
+    }
+    else
+    {
+        double elapsed = nanoseconds(now - this->batchStart) - this->pausedNanoseconds;
+        if (this->warmupsLeft > 0)
+        {
+            // A warmup batch that is too short to time grows the batch, at most 100 times at once.
+            this->warmupsLeft = now >= this->deadline ? 0 : this->warmupsLeft - 1;
+            if (elapsed < this->minSampleNanoseconds)
+            {
+                double perIteration = max(elapsed / static_cast<double>(this->batch), 1.0);
+                size_t needed = static_cast<size_t>(ceil(this->minSampleNanoseconds / perIteration));
+                this->batch = min(max(needed, this->batch), this->batch * 100);
+            }
+        }
+        else
+        {
+            this->samples.push_back(elapsed / static_cast<double>(this->batch));
+            this->iterations += this->batch;
+            if (this->samples.size() >= this->repetitions || (now >= this->deadline && this->samples.size() >= MIN_SAMPLES))
+            {
+                return false;
+            }
+        }
+    }
+    this->remaining = this->batch - 1;
+    this->pausedNanoseconds = 0;
+    this->batchStart = Clock::now();
+    return true;
+}
+
+void BenchmarkState::pauseTiming()
+{
+    this->pauseStart = Clock::now();
+}
+
+void BenchmarkState::resumeTiming()
+{
+    this->pausedNanoseconds += nanoseconds(Clock::now() - this->pauseStart);
+}
+
+void BenchmarkHarness::add(const string &name, const vector<size_t> &sizes, const vector<double> &densities, const function<void(BenchmarkState &)> &body)
+{
+    this->benchmarks.push_back(Benchmark{name, sizes, densities, body});
+}
+
+BenchmarkHarness::Result BenchmarkHarness::summarize(const BenchmarkState &state)
+{
+    vector<double> sorted = state.getSamples();
+    sort(sorted.begin(), sorted.end());
+    size_t count = sorted.size();
+    Result result;
+    result.vertices = state.getVertices();
+    result.density = state.getDensity();
+    result.iterations = state.getIterations();
+    result.repetitions = count;
+    result.median = count % 2 == 1 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+    result.p99 = sorted[static_cast<size_t>(ceil(0.99 * static_cast<double>(count))) - 1];
+    result.min = sorted[0];
+    double total = 0;
+    for (double sample : sorted)
+    {
+        total += sample;
+    }
+    result.mean = total / static_cast<double>(count);
+    result.bytesPerSecond = static_cast<double>(state.getBytesProcessed()) / result.median * 1e9;
+    return result;
+}
+
+// A time in the unit that keeps it between 1 and 1000.
+static string formatTime(double ns)
+{
+    char text[32];
+    if (ns < 1e3)
+    {
+        snprintf(text, sizeof(text), "%.1f ns", ns);
+    }
+    else if (ns < 1e6)
+    {
+        snprintf(text, sizeof(text), "%.2f us", ns / 1e3);
+    }
+    else if (ns < 1e9)
+    {
+        snprintf(text, sizeof(text), "%.2f ms", ns / 1e6);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%.2f s", ns / 1e9);
+    }
+    return text;
+}
+
+// A throughput in MB/s, empty for a case that does not report one.
+static string formatThroughput(double bytesPerSecond)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.1f MB/s", bytesPerSecond / 1e6);
+    return bytesPerSecond > 0 ? text : "";
+}
+
+static string formatDensity(double density)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%g", density);
+    return text;
+}
+
+vector<BenchmarkHarness::Result> BenchmarkHarness::run(const Options &options, ostream &out) const
+{
+    char line[256];
+    snprintf(line, sizeof(line), "%-40s %12s %12s %12s %12s %12s %14s", "benchmark", "median", "p99", "min", "mean", "iterations", "throughput");
+    out << line << endl;
+
+    vector<Result> results;
+    for (const Benchmark &benchmark : this->benchmarks)
+    {
+        for (size_t n : benchmark.sizes)
+        {
+            for (double density : benchmark.densities)
+            {
+                string name = benchmark.name + "/" + to_string(n) + "/" + formatDensity(density);
+                if (n > options.maxVertices || name.find(options.filter) == string::npos)
+                {
+                    continue;
+                }
+                BenchmarkState state(n, density, options.repetitions, options.warmups, options.minSampleMilliseconds, options.maxSeconds);
+                benchmark.body(state);
+                if (state.getSamples().empty())
+                {
+                    throw invalid_argument("The benchmark " + name + " did not run its loop on keepRunning.");
+                }
+                Result result = summarize(state);
+                result.name = name;
+                result.operation = benchmark.name;
+                results.push_back(result);
+
+                snprintf(line, sizeof(line), "%-40s %12s %12s %12s %12s %12zu %14s", name.c_str(), formatTime(result.median).c_str(),
+                         formatTime(result.p99).c_str(), formatTime(result.min).c_str(), formatTime(result.mean).c_str(), result.iterations,
+                         formatThroughput(result.bytesPerSecond).c_str());
+                out << line << endl;
+            }
+        }
+    }
+    return results;
+}
+
+// The text as a JSON string, with quotes, backslashes and control characters escaped.
+static string jsonString(const string &text)
+{
+    string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+void BenchmarkHarness::writeJson(const vector<Result> &results, const Options &options, ostream &out)
+{
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    out << "{" << endl;
+    out << "  \"context\": {" << endl;
+    out << "    \"date\": " << jsonString(date) << "," << endl;
+#ifdef __VERSION__
+    out << "    \"compiler\": " << jsonString(__VERSION__) << "," << endl;
+#endif
+    out << "    \"hardware_threads\": " << thread::hardware_concurrency() << "," << endl;
+    out << "    \"threads\": " << options.threads << "," << endl;
+    out << "    \"repetitions\": " << options.repetitions << "," << endl;
+    out << "    \"warmup\": " << options.warmups << "," << endl;
+    out << "    \"min_sample_ms\": " << options.minSampleMilliseconds << "," << endl;
+    out << "    \"max_vertices\": " << options.maxVertices << "," << endl;
+    out << "    \"time_unit\": \"ns\"" << endl;
+    out << "  }," << endl;
+    out << "  \"benchmarks\": [" << endl;
+    // A case on every line, so two runs can be compared with diff.
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        char numbers[256];
+        snprintf(numbers, sizeof(numbers),
+                 "\"vertices\": %zu, \"density\": %s, \"iterations\": %zu, \"repetitions\": %zu, "
+                 "\"median\": %.1f, \"p99\": %.1f, \"min\": %.1f, \"mean\": %.1f",
+                 r.vertices, formatDensity(r.density).c_str(), r.iterations, r.repetitions, r.median, r.p99, r.min, r.mean);
+        char throughput[64] = "";
+        if (r.bytesPerSecond > 0)
+        {
+            snprintf(throughput, sizeof(throughput), ", \"bytes_per_second\": %.0f", r.bytesPerSecond);
+        }
+        out << "    {\"name\": " << jsonString(r.name) << ", \"operation\": " << jsonString(r.operation) << ", " << numbers << throughput << "}"
+            << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    out << "  ]" << endl;
+    out << "}" << endl;
+}
+
+// The value after an option, as a number.
+static double numberArgument(int argc, char *argv[], int &i)
+{
+    string option = argv[i];
+    if (++i >= argc)
+    {
+        throw invalid_argument("The option " + option + " needs a value.");
+    }
+    char *end;
+    double value = strtod(argv[i], &end);
+    if (*argv[i] == '\0' || *end != '\0' || value < 0)
+    {
+        throw invalid_argument("The value of " + option + " must be a non negative number.");
+    }
+    return value;
+}
+
+BenchmarkHarness::Options BenchmarkHarness::parseArguments(int argc, char *argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+        if (option == "--repetitions")
+        {
+            options.repetitions = static_cast<size_t>(numberArgument(argc, argv, i));
+        }
+        else if (option == "--warmup")
+        {
+            options.warmups = static_cast<size_t>(numberArgument(argc, argv, i));
+        }
+        else if (option == "--min-sample-ms")
+        {
+            options.minSampleMilliseconds = numberArgument(argc, argv, i);
+        }
+        else if (option == "--max-seconds")
+        {
+            options.maxSeconds = numberArgument(argc, argv, i);
+        }
+        else if (option == "--max-vertices")
+        {
+            options.maxVertices = static_cast<size_t>(numberArgument(argc, argv, i));
+        }
+        else if (option == "--threads")
+        {
+            options.threads = static_cast<size_t>(numberArgument(argc, argv, i));
+        }
+        else if ((option == "--filter" || option == "--json") && i + 1 < argc)
+        {
+            (option == "--filter" ? options.filter : options.jsonPath) = argv[++i];
+        }
+        else
+        {
+            throw invalid_argument("Unknown option or missing value: " + option);
+        }
+    }
+    return options;
+}
@@ -0,0 +1,204 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _BENCHMARK_HARNESS_HPP_
+#define _BENCHMARK_HARNESS_HPP_
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * One case of a benchmark: the number of vertices and the density of its input, and the clock of the measured loop.
+    * The benchmarked function builds its input, then runs the measured operation in a loop on keepRunning:
+    *     while (state.keepRunning()) { g1 += g2; }
+    * The first rounds of the loop are a warmup, which also finds how many iterations make a sample long enough
+    * to time, then every sample is the time of a batch of iterations divided by their number.
+    */
+    class BenchmarkState
+    {
+    private:
+        typedef chrono::steady_clock Clock;
+
+        size_t vertices;
+        double density;
+        size_t repetitions;
+        size_t warmupsLeft;
+        double minSampleNanoseconds;
+        Clock::duration maxTime;
+
+        bool started;
+        Clock::time_point deadline;
+        Clock::time_point batchStart;
+        Clock::time_point pauseStart;
+        double pausedNanoseconds;
+        size_t batch;
+        size_t remaining;
+        size_t iterations;
+        size_t bytesProcessed;
+        vector<double> samples;
+
+    public:
+        /*
+        * @brief
+        * Constructor, a case that has not started yet.
+        * @param vertices, density - the input of the case.
+        * @param repetitions - the number of samples to take.
+        * @param warmups - the number of batches run before the samples, at least 1 to find the size of a batch.
+        * @param minSampleMilliseconds - a batch grows until it takes at least this long.
+        * @param maxSeconds - after this long the case stops at the samples it has, if it has at least 3.
+        */
+        BenchmarkState(size_t vertices, double density, size_t repetitions, size_t warmups, double minSampleMilliseconds, double maxSeconds);
+
+        size_t getVertices() const { return this->vertices; }
+        double getDensity() const { return this->density; }
+
+        /*
+        * @brief
+        * This function is the condition of the measured loop, it returns true as long as another iteration is needed.
+        * @return bool true if the operation should run once more, false when all the samples are taken.
+        */
+        bool keepRunning();
+
+        /*
+        * @brief
+        * These functions leave the work between them out of the measured time,
+        * such as dropping the results a graph keeps so every iteration computes them again.
+        * @return void
+        */
+        void pauseTiming();
+        void resumeTiming();
+
+        // The number of measured iterations, without the warmup.
+        size_t getIterations() const { return this->iterations; }
+
+        // The time of one iteration in every sample, in nanoseconds.
+        const vector<double> &getSamples() const { return this->samples; }
+
+        /*
+        * @brief
+        * This function sets the number of bytes of input one iteration reads, such as the size of a parsed file,
+        * so the throughput of the case is reported next to its time.
+        * @param bytes - bytes per iteration, 0 reports no throughput.
+        * @return void
+        */
+        void setBytesProcessed(size_t bytes) { this->bytesProcessed = bytes; }
+        size_t getBytesProcessed() const { return this->bytesProcessed; }
+    };
+
+    /*
+    * @brief
+    * Benchmarks registered by name over sizes and densities, run with warmup and repetitions,
+    * and reported as the median, 99th percentile, minimum and mean time of an iteration, as a table and as JSON,
+    * with the throughput of the cases that set the bytes they process.
+    */
+    class BenchmarkHarness
+    {
+    public:
+        // How the benchmarks are run, set from the command line by parseArguments.
+        struct Options
+        {
+            size_t repetitions = 20;
+            size_t warmups = 2;
+            double minSampleMilliseconds = 1;
+            double maxSeconds = 2;
+            // Cases with more vertices are skipped.
+            size_t maxVertices = 1024;
+            // The number of threads of the library, 0 for every hardware thread, see Algorithms::setThreadCount.
+            size_t threads = 1;
+            // Only cases whose name contains it are run.
+            string filter;
+            // The JSON results are written to this file, if it is not empty.
+            string jsonPath;
+        };
+
+        // The statistics of a case, times in nanoseconds.
+        struct Result
+        {
+            string name;
+            string operation;
+            size_t vertices;
+            double density;
+            size_t iterations;
+            size_t repetitions;
+            double median;
+            double p99;
+            double min;
+            double mean;
+            // The bytes read per second at the median time, 0 if the case does not set the bytes it processes.
+            double bytesPerSecond;
+        };
+
+    private:
+        struct Benchmark
+        {
+            string name;
+            vector<size_t> sizes;
+            vector<double> densities;
+            function<void(BenchmarkState &)> body;
+        };
+
+        vector<Benchmark> benchmarks;
+
+        /*
+        * @brief
+        * This function computes the statistics of the samples of a case.
+        * The 99th percentile is the nearest rank, so with fewer than 100 samples it is the slowest one.
+        * @param state - the finished case.
+        * @return Result - the statistics, without the name.
+        */
+        static Result summarize(const BenchmarkState &state);
+
+    public:
+        /*
+        * @brief
+        * This function registers a benchmark, it runs once for every size and density.
+        * The cases are named operation/vertices/density, which stays the same between releases.
+        * @param name - the name of the benchmark.
+        * @param sizes - the numbers of vertices of the input.
+        * @param densities - the densities of the input, the fraction of cells with an edge.
+        * @param body - the benchmarked function.
+        * @return void
+        */
+        void add(const string &name, const vector<size_t> &sizes, const vector<double> &densities, const function<void(BenchmarkState &)> &body);
+
+        /*
+        * @brief
+        * This function runs the registered cases that match the options, in the order they were added,
+        * printing a line for every case as soon as it finishes.
+        * @param options - how to run the cases.
+        * @param out - the stream the table is printed to.
+        * @return vector<Result> - the statistics of every case that ran.
+        * @throw invalid_argument - if a benchmarked function never calls keepRunning.
+        */
+        vector<Result> run(const Options &options, ostream &out) const;
+
+        /*
+        * @brief
+        * This function writes the results as JSON, the options in "context" and a line for every case in "benchmarks".
+        * @param results - the results of run.
+        * @param options - the options of the run.
+        * @param out - the stream to write to.
+        * @return void
+        */
+        static void writeJson(const vector<Result> &results, const Options &options, ostream &out);
+
+        /*
+        * @brief
+        * This function reads the options from the command line:
+        * --repetitions N, --warmup N, --min-sample-ms X, --max-seconds X, --max-vertices N, --threads N, --filter TEXT, --json FILE.
+        * @param argc, argv - the arguments of main.
+        * @return Options - the options, the defaults for the ones not given.
+        * @throw invalid_argument - if an argument is unknown or its value is missing or not a number.
+        */
+        static Options parseArguments(int argc, char *argv[]);
+    };
+}
+
+#endif
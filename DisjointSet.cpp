@@ -0,0 +1,132 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include "DisjointSet.hpp"
+using ariel::DisjointSet;
+using ariel::BasicGraph;
+using namespace std;
+
+DisjointSet::DisjointSet(size_t n) : parent(n), ranks(n, 0), sets(n)
+{
+    for (size_t v = 0; v < n; v++)
+    {
+        this->parent[v] = v;
+    }
+}
+
+template <typename W>
+DisjointSet::DisjointSet(const BasicGraph<W> &graph) : DisjointSet(graph.getVertices())
+{
+    this->unite(graph);
+}
+
+size_t DisjointSet::root(size_t v) const
+{
+    while (this->parent[v] != v)
+    {
+        v = this->parent[v];
+    }
+    return v;
+}
+
+size_t DisjointSet::compress(size_t v)
+{
+    size_t r = this->root(v);
+    // Path compression: a second pass points every vertex on the path at the root.
+    while (this->parent[v] != r)
+    {
+        size_t next = this->parent[v];
+        this->parent[v] = r;
+        v = next;
+    }
+    return r;
+}
+
+size_t DisjointSet::getVertices() const
+{
+    return this->parent.size();
+}
+
+size_t DisjointSet::getSetCount() const
+{
+    return this->sets;
+}
+
+bool DisjointSet::isConnected() const
+{
+    return this->sets <= 1;
+}
+
+size_t DisjointSet::find(size_t v) const
+{
+    if (v >= this->parent.size())
+    {
+        throw invalid_argument("Invalid vertex");
+    }
+    return this->root(v);
+}
+
+bool DisjointSet::connected(size_t u, size_t v) const
+{
+    return this->find(u) == this->find(v);
+}
+
+bool DisjointSet::unite(size_t u, size_t v)
+{
+    if (u >= this->parent.size() || v >= this->parent.size())
+    {
+        throw invalid_argument("Invalid vertex");
+    }
+    size_t a = this->compress(u);
+    size_t b = this->compress(v);
+    if (a == b)
+    {
+        return false;
+    }
+    // Union by rank: the lower tree goes under the higher one, so the trees stay O(log V) high.
+    if (this->ranks[a] < this->ranks[b])
+    {
+        swap(a, b);
+    }
+    this->parent[b] = a;
+    if (this->ranks[a] == this->ranks[b])
+    {
+        this->ranks[a]++;
+    }
+    this->sets--;
+    return true;
+}
+
+template <typename W>
+void DisjointSet::unite(const BasicGraph<W> &graph)
+{
+    size_t n = this->parent.size();
+    if (graph.getVertices() != n)
+    {
+        throw invalid_argument("The graph must have the same number of vertices.");
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        for (typename BasicGraph<W>::Neighbour neighbour : graph.getRow(i))
+        {
+            // Every edge of an undirected graph is in the rows of both its ends, take it once.
+            if (neighbour.vertex > i)
+            {
+                this->unite(i, neighbour.vertex);
+            }
+        }
+    }
+    // Every vertex points at its root, so the queries that follow find it in one step without compressing.
+    for (size_t v = 0; v < n; v++)
+    {
+        this->compress(v);
+    }
+}
+
+// The sets of the graphs of every weight type.
+#define ARIEL_INSTANTIATE_DISJOINT_SET(W)                  \
+    template DisjointSet::DisjointSet(const BasicGraph<W> &graph); \
+    template void DisjointSet::unite(const BasicGraph<W> &graph);
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_DISJOINT_SET)
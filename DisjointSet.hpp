@@ -0,0 +1,127 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _DISJOINT_SET_HPP_
+#define _DISJOINT_SET_HPP_
+
+#include <vector>
+#include "Graph.hpp"
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * The connected components of an undirected graph as a union-find (disjoint set) forest, with union by rank
+    * and path compression, so every added edge takes amortized O(α(V)), practically O(1).
+    * Edges can be added to it but not removed. Graph::getConnectivity keeps one for the graph,
+    * and operator+= adds the new edges to it instead of finding the components again.
+    * The paths are compressed only when edges are added, and every vertex is pointed at its root once all the edges
+    * of a graph are added, so a query reads the forest without changing it, in O(1) after a graph,
+    * and the const functions may be called from several threads at once.
+    */
+    class DisjointSet
+    {
+    private:
+        // The parent of every vertex in its tree, a root is its own parent.
+        vector<size_t> parent;
+        // An upper bound on the height of the tree of every root.
+        vector<unsigned char> ranks;
+        size_t sets;
+
+        /*
+        * @brief
+        * This function finds the root of the tree of a vertex, without changing the forest.
+        * @param v - a vertex, not checked.
+        * @return size_t - the root.
+        */
+        size_t root(size_t v) const;
+
+        /*
+        * @brief
+        * This function finds the root of the tree of a vertex, and points every vertex on the way at it.
+        * @param v - a vertex, not checked.
+        * @return size_t - the root.
+        */
+        size_t compress(size_t v);
+
+    public:
+        /*
+        * @brief
+        * Constructor, every vertex in a set of its own.
+        * @param n - number of vertices.
+        */
+        explicit DisjointSet(size_t n);
+
+        /*
+        * @brief
+        * Constructor, the connected components of an undirected graph.
+        * @param graph - Graph object.
+        */
+        template <typename W>
+        explicit DisjointSet(const BasicGraph<W> &graph);
+
+        /*
+        * @brief
+        * This function returns the number of vertices.
+        * @return size_t - number of vertices.
+        */
+        size_t getVertices() const;
+
+        /*
+        * @brief
+        * This function returns the number of sets, the connected components of the graph.
+        * @return size_t - number of sets.
+        */
+        size_t getSetCount() const;
+
+        /*
+        * @brief
+        * This function checks if all the vertices are in one set.
+        * @return bool - true if the graph is connected, false otherwise.
+        */
+        bool isConnected() const;
+
+        /*
+        * @brief
+        * This function returns the representative of the set of a vertex, the same for every vertex of the set
+        * until the set is joined to another one.
+        * @param v - the vertex.
+        * @return size_t - the representative of its set.
+        * @throw invalid_argument - if v is not a vertex.
+        */
+        size_t find(size_t v) const;
+
+        /*
+        * @brief
+        * This function checks if two vertices are in the same set.
+        * @param u - first vertex.
+        * @param v - second vertex.
+        * @return bool - true if there is a path between u and v, false otherwise.
+        * @throw invalid_argument - if u or v is not a vertex.
+        */
+        bool connected(size_t u, size_t v) const;
+
+        /*
+        * @brief
+        * This function adds an edge, joining the sets of its two vertices.
+        * @param u - first vertex.
+        * @param v - second vertex.
+        * @return bool - true if u and v were in different sets, false otherwise.
+        * @throw invalid_argument - if u or v is not a vertex.
+        */
+        bool unite(size_t u, size_t v);
+
+        /*
+        * @brief
+        * This function adds the edges of an undirected graph with the same vertices.
+        * @param graph - Graph object.
+        * @return void
+        * @throw invalid_argument - if the graph does not have the same number of vertices.
+        */
+        template <typename W>
+        void unite(const BasicGraph<W> &graph);
+    };
+}
+
+#endif
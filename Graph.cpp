@@ -4,178 +4,1409 @@
 #include <iostream>
 #include <vector>
 #include <set>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstdio>
+#include <cerrno>
+#include <clocale>
+#include <unistd.h>
 #include "Graph.hpp"
-using ariel::Graph;
+#include "AllPairsPaths.hpp"
+#include "ReachabilityIndex.hpp"
+#include "DisjointSet.hpp"
+#include "ThreadPool.hpp"
+using ariel::BasicGraph;
+using ariel::GraphBase;
 using namespace std;
 
-Graph::Graph()
+// Side of the square tiles used when a loop has to walk down the columns of the matrix.
+static const size_t TILE = 64;
+// Number of product rows computed together by operator*.
+static const size_t MULTIPLY_ROWS = 4;
+// Rows and columns of the blocks of the right operand of operator* (128 x 512 ints, 256KB), sized for the L2 cache.
+static const size_t MULTIPLY_K_BLOCK = 128;
+static const size_t MULTIPLY_J_BLOCK = 512;
+// Number of chunks of rows per thread of operator*, each chunk has its own scratch rows.
+static const size_t MULTIPLY_CHUNKS = 8;
+// Number of columns of the product of two bitset graphs computed together, their words (32KB at 4096 vertices) stay in the cache.
+static const size_t MULTIPLY_BITS_BLOCK = 64;
+// Number of vertices in a word of bitset storage.
+static const size_t WORD_BITS = 64;
+// Size of the buffer operator<< renders rows into before writing them (256KB), grown for a row that does not fit.
+static const size_t PRINT_BUFFER_BYTES = 1 << 18;
+// Significant digits of a double that tell every double apart, the most formatRows prints.
+static const int PRINT_MAX_PRECISION = 17;
+
+double GraphBase::sparseThreshold = 0.1;
+bool GraphBase::bitsetStorage = true;
+bool GraphBase::symmetricStorage = true;
+
+/*
+* @brief
+* This function checks if a matrix given as rows is symmetric, comparing tiles of the upper triangle with their mirror tiles.
+* @param graph - square 2D vector.
+* @return bool - true if the matrix is symmetric, false otherwise.
+*/
+template <typename W>
+static bool isSymmetricMatrix(const vector<vector<W>> &graph)
 {
+    size_t n = graph.size();
+    for (size_t ib = 0; ib < n; ib += TILE)
+    {
+        for (size_t jb = ib; jb < n; jb += TILE)
+        {
+            for (size_t i = ib; i < min(ib + TILE, n); i++)
+            {
+                for (size_t j = max(jb, i + 1); j < min(jb + TILE, n); j++)
+                {
+                    if (graph[i][j] != graph[j][i])
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template <typename W>
+BasicGraph<W>::BasicGraph()
+{
+    this->stride = 0;
+    this->storage = Storage::Dense;
     this->vertices = 0;
     this->edges = 0;
+    this->nonZeros = 0;
     this->directed = false;
+    this->lightest = 0;
+    this->heaviest = 0;
+}
+
+template <typename W>
+BasicGraph<W>::BasicGraph(BasicGraph &&other) noexcept : BasicGraph()
+{
+    *this = move(other);
+}
+
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator=(BasicGraph &&other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    // Moving a buffer or a result leaves it empty in other, the rest of other is reset to a graph of 0 vertices.
+    this->adjancencyMatrix = move(other.adjancencyMatrix);
+    this->rowOffsets = move(other.rowOffsets);
+    this->columnIndices = move(other.columnIndices);
+    this->weights = move(other.weights);
+    this->bits = move(other.bits);
+    this->results.allPairsPaths = move(other.results.allPairsPaths);
+    this->results.reachability = move(other.results.reachability);
+    this->results.connectivity = move(other.results.connectivity);
+    this->stride = other.stride;
+    this->storage = other.storage;
+    this->vertices = other.vertices;
+    this->edges = other.edges;
+    this->nonZeros = other.nonZeros;
+    this->directed = other.directed;
+    this->lightest = other.lightest;
+    this->heaviest = other.heaviest;
+    other.stride = 0;
+    other.storage = Storage::Dense;
+    other.vertices = 0;
+    other.edges = 0;
+    other.nonZeros = 0;
+    other.directed = false;
+    other.lightest = 0;
+    other.heaviest = 0;
+    return *this;
+}
+
+template <typename W>
+BasicGraph<W>::~BasicGraph()
+{
+
+}
+
+template <typename W>
+void BasicGraph<W>::dropResults()
+{
+    this->results.allPairsPaths.reset();
+    this->results.reachability.reset();
+    this->results.connectivity.reset();
+}
+
+template <typename W>
+void BasicGraph<W>::resize(size_t n)
+{
+    this->storage = Storage::Dense;
+    this->vertices = n;
+    this->stride = ariel::AlignedBuffer<W>::rowStride(n);
+    this->adjancencyMatrix = ariel::AlignedBuffer<W>(n * this->stride);
+    this->rowOffsets = ariel::AlignedBuffer<size_t>();
+    this->columnIndices = ariel::AlignedBuffer<size_t>();
+    this->weights = ariel::AlignedBuffer<W>();
+    this->bits = ariel::AlignedBuffer<uint64_t>();
+}
+
+template <typename W>
+void BasicGraph<W>::resizeSparse(size_t n, size_t nonZeros)
+{
+    this->storage = Storage::Sparse;
+    this->vertices = n;
+    this->stride = 0;
+    this->adjancencyMatrix = ariel::AlignedBuffer<W>();
+    this->rowOffsets = ariel::AlignedBuffer<size_t>(n + 1);
+    this->columnIndices = ariel::AlignedBuffer<size_t>(nonZeros);
+    this->weights = ariel::AlignedBuffer<W>(nonZeros);
+    this->bits = ariel::AlignedBuffer<uint64_t>();
+}
+
+template <typename W>
+void BasicGraph<W>::resizeBits(size_t n)
+{
+    this->storage = Storage::Bitset;
+    this->vertices = n;
+    this->stride = ariel::AlignedBuffer<uint64_t>::rowStride((n + WORD_BITS - 1) / WORD_BITS);
+    this->adjancencyMatrix = ariel::AlignedBuffer<W>();
+    this->rowOffsets = ariel::AlignedBuffer<size_t>();
+    this->columnIndices = ariel::AlignedBuffer<size_t>();
+    this->weights = ariel::AlignedBuffer<W>();
+    this->bits = ariel::AlignedBuffer<uint64_t>(n * this->stride);
+}
+
+template <typename W>
+void BasicGraph<W>::resizeSymmetric(size_t n)
+{
+    this->storage = Storage::Symmetric;
+    this->vertices = n;
+    this->stride = 0;
+    this->adjancencyMatrix = ariel::AlignedBuffer<W>(n * (n + 1) / 2);
+    this->rowOffsets = ariel::AlignedBuffer<size_t>();
+    this->columnIndices = ariel::AlignedBuffer<size_t>();
+    this->weights = ariel::AlignedBuffer<W>();
+    this->bits = ariel::AlignedBuffer<uint64_t>();
+}
+
+template <typename W>
+W *BasicGraph<W>::row(size_t i)
+{
+    return this->adjancencyMatrix.data() + i * this->stride;
+}
+
+template <typename W>
+const W *BasicGraph<W>::row(size_t i) const
+{
+    return this->adjancencyMatrix.data() + i * this->stride;
+}
+
+template <typename W>
+uint64_t *BasicGraph<W>::bitRow(size_t i)
+{
+    return this->bits.data() + i * this->stride;
+}
+
+template <typename W>
+const uint64_t *BasicGraph<W>::bitRow(size_t i) const
+{
+    return this->bits.data() + i * this->stride;
+}
+
+template <typename W>
+W *BasicGraph<W>::upperRow(size_t i)
+{
+    // Rows 0 .. i - 1 hold n, n - 1, ..., n - i + 1 cells.
+    return this->adjancencyMatrix.data() + i * (2 * this->vertices - i + 1) / 2;
+}
+
+template <typename W>
+const W *BasicGraph<W>::upperRow(size_t i) const
+{
+    return this->adjancencyMatrix.data() + i * (2 * this->vertices - i + 1) / 2;
+}
+
+template <typename W>
+const W *BasicGraph<W>::denseRow(size_t i, W *scratch) const
+{
+    if (this->storage == Storage::Dense)
+    {
+        return this->row(i);
+    }
+
+    if (this->storage == Storage::Symmetric)
+    {
+        // The cells left of the diagonal go down column i of the triangle, the rest of the row is stored as it is.
+        const W *upper = this->upperRow(i);
+        for (size_t j = 0; j < i; j++)
+        {
+            scratch[j] = this->upperRow(j)[i - j];
+        }
+        copy(upper, upper + this->vertices - i, scratch + i);
+        return scratch;
+    }
+
+    fill(scratch, scratch + this->vertices, 0);
+    if (this->storage == Storage::Bitset)
+    {
+        for (Neighbour neighbour : this->neighbours(i))
+        {
+            scratch[neighbour.vertex] = 1;
+        }
+        return scratch;
+    }
+
+    // Scatter the stored cells of the sparse row into the scratch row.
+    for (size_t k = this->rowOffsets[i]; k < this->rowOffsets[i + 1]; k++)
+    {
+        scratch[this->columnIndices[k]] = this->weights[k];
+    }
+    return scratch;
+}
+
+template <typename W>
+W BasicGraph<W>::cell(size_t i, size_t j) const
+{
+    if (this->storage == Storage::Dense)
+    {
+        return this->row(i)[j];
+    }
+    if (this->storage == Storage::Bitset)
+    {
+        return static_cast<W>((this->bitRow(i)[j / WORD_BITS] >> (j % WORD_BITS)) & 1);
+    }
+    if (this->storage == Storage::Symmetric)
+    {
+        return i <= j ? this->upperRow(i)[j - i] : this->upperRow(j)[i - j];
+    }
+
+    // The columns of a sparse row are sorted, so binary search for j.
+    const size_t *first = this->columnIndices.data() + this->rowOffsets[i];
+    const size_t *last = this->columnIndices.data() + this->rowOffsets[i + 1];
+    const size_t *found = lower_bound(first, last, j);
+    if (found == last || *found != j)
+    {
+        return 0;
+    }
+    return this->weights[static_cast<size_t>(found - this->columnIndices.data())];
+}
+
+template <typename W>
+size_t BasicGraph<W>::countNonZeros() const
+{
+    if (this->storage == Storage::Sparse)
+    {
+        return this->rowOffsets[this->vertices];
+    }
+
+    size_t n = this->vertices;
+    size_t count = 0;
+    if (this->storage == Storage::Bitset)
+    {
+        for (size_t k = 0; k < n * this->stride; k++)
+        {
+            count += static_cast<size_t>(__builtin_popcountll(this->bits[k]));
+        }
+        return count;
+    }
+    if (this->storage == Storage::Symmetric)
+    {
+        CellSummary summary;
+        for (size_t i = 0; i < n; i++)
+        {
+            summary.addUpperRow(this->upperRow(i), n - i);
+        }
+        return summary.nonZeros;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        const W *rowI = this->row(i);
+        for (size_t j = 0; j < n; j++)
+        {
+            count += rowI[j] != 0;
+        }
+    }
+    return count;
+}
+
+template <typename W>
+void BasicGraph<W>::convertTo(Storage target)
+{
+    if (target == this->storage)
+    {
+        return;
+    }
+    size_t n = this->vertices;
+
+    // Symmetric storage is only converted from and to dense storage, the other storages go through it.
+    if ((this->storage == Storage::Symmetric && target != Storage::Dense) || (target == Storage::Symmetric && this->storage != Storage::Dense))
+    {
+        this->convertTo(Storage::Dense);
+        this->convertTo(target);
+        return;
+    }
+
+    if (this->storage == Storage::Symmetric)
+    {
+        // Copy the upper triangle into place, then mirror it tile by tile, so both the rows read and the rows written stay in the cache.
+        ariel::AlignedBuffer<W> packed(move(this->adjancencyMatrix));
+        const W *upper = packed.data();
+        this->resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            copy(upper, upper + n - i, this->row(i) + i);
+            upper += n - i;
+        }
+        for (size_t ib = 0; ib < n; ib += TILE)
+        {
+            for (size_t jb = 0; jb <= ib; jb += TILE)
+            {
+                for (size_t i = ib; i < min(ib + TILE, n); i++)
+                {
+                    W *rowI = this->row(i);
+                    for (size_t j = jb; j < min(jb + TILE, i); j++)
+                    {
+                        rowI[j] = this->row(j)[i];
+                    }
+                }
+            }
+        }
+    }
+    else if (target == Storage::Symmetric)
+    {
+        // Take the dense matrix out and keep the upper triangle of every row.
+        size_t matrixStride = this->stride;
+        ariel::AlignedBuffer<W> matrix(move(this->adjancencyMatrix));
+        this->resizeSymmetric(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            const W *rowI = matrix.data() + i * matrixStride;
+            copy(rowI + i, rowI + n, this->upperRow(i));
+        }
+    }
+    else if (this->storage == Storage::Bitset)
+    {
+        // Take the words out and visit their set bits, the cells of weight 1, row by row.
+        size_t count = this->countNonZeros();
+        size_t words = (n + WORD_BITS - 1) / WORD_BITS;
+        size_t bitsStride = this->stride;
+        ariel::AlignedBuffer<uint64_t> matrix(move(this->bits));
+        if (target == Storage::Sparse)
+        {
+            this->resizeSparse(n, count);
+        }
+        else
+        {
+            this->resize(n);
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            const uint64_t *rowI = matrix.data() + i * bitsStride;
+            if (target == Storage::Sparse)
+            {
+                this->rowOffsets[i] = k;
+            }
+            for (size_t w = 0; w < words; w++)
+            {
+                for (uint64_t word = rowI[w]; word != 0; word &= word - 1)
+                {
+                    size_t j = w * WORD_BITS + static_cast<size_t>(__builtin_ctzll(word));
+                    if (target == Storage::Sparse)
+                    {
+                        this->columnIndices[k] = j;
+                        this->weights[k] = 1;
+                        k++;
+                    }
+                    else
+                    {
+                        this->row(i)[j] = 1;
+                    }
+                }
+            }
+        }
+        if (target == Storage::Sparse)
+        {
+            this->rowOffsets[n] = k;
+        }
+    }
+    else if (target == Storage::Bitset)
+    {
+        // Take the old storage out and set the bit of every non zero cell, they all weigh 1.
+        size_t matrixStride = this->stride;
+        ariel::AlignedBuffer<W> matrix(move(this->adjancencyMatrix));
+        ariel::AlignedBuffer<size_t> offsets(move(this->rowOffsets));
+        ariel::AlignedBuffer<size_t> columns(move(this->columnIndices));
+        bool fromSparse = this->storage == Storage::Sparse;
+        this->resizeBits(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t *rowI = this->bitRow(i);
+            if (fromSparse)
+            {
+                for (size_t k = offsets[i]; k < offsets[i + 1]; k++)
+                {
+                    rowI[columns[k] / WORD_BITS] |= uint64_t(1) << (columns[k] % WORD_BITS);
+                }
+                continue;
+            }
+            const W *cells = matrix.data() + i * matrixStride;
+            for (size_t j = 0; j < n; j++)
+            {
+                rowI[j / WORD_BITS] |= uint64_t(cells[j] != 0) << (j % WORD_BITS);
+            }
+        }
+    }
+    else if (target == Storage::Sparse)
+    {
+        // Take the dense matrix out and pack its non zero cells row by row.
+        size_t count = this->countNonZeros();
+        size_t matrixStride = this->stride;
+        ariel::AlignedBuffer<W> matrix(move(this->adjancencyMatrix));
+        this->resizeSparse(n, count);
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            const W *rowI = matrix.data() + i * matrixStride;
+            this->rowOffsets[i] = k;
+            for (size_t j = 0; j < n; j++)
+            {
+                if (rowI[j] != 0)
+                {
+                    this->columnIndices[k] = j;
+                    this->weights[k] = rowI[j];
+                    k++;
+                }
+            }
+        }
+        this->rowOffsets[n] = k;
+    }
+    else
+    {
+        // Take the sparse rows out and scatter them into a zeroed matrix.
+        ariel::AlignedBuffer<size_t> offsets(move(this->rowOffsets));
+        ariel::AlignedBuffer<size_t> columns(move(this->columnIndices));
+        ariel::AlignedBuffer<W> values(move(this->weights));
+        this->resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            W *rowI = this->row(i);
+            for (size_t k = offsets[i]; k < offsets[i + 1]; k++)
+            {
+                rowI[columns[k]] = values[k];
+            }
+        }
+    }
+}
+
+template <typename W>
+void BasicGraph<W>::selectStorage()
+{
+    size_t n = this->vertices;
+    if (n == 0)
+    {
+        return;
+    }
+    double density = static_cast<double>(this->nonZeros) / (static_cast<double>(n) * static_cast<double>(n));
+    if (density < GraphBase::sparseThreshold)
+    {
+        this->convertTo(Storage::Sparse);
+    }
+    else if (GraphBase::bitsetStorage && this->lightest == 1 && this->heaviest == 1)
+    {
+        this->convertTo(Storage::Bitset);
+    }
+    else if (GraphBase::symmetricStorage && !this->directed)
+    {
+        this->convertTo(Storage::Symmetric);
+    }
+    else
+    {
+        this->convertTo(Storage::Dense);
+    }
+}
+
+template <typename W>
+void BasicGraph<W>::updateMetadata(const CellSummary &summary, bool recheckDirected)
+{
+    if (recheckDirected)
+    {
+        this->directed = !this->isSymmetric();
+    }
+    this->nonZeros = summary.nonZeros;
+    // If the graph is undirected, then every edge is counted twice.
+    this->edges = this->directed ? this->nonZeros : this->nonZeros / 2;
+    this->lightest = summary.nonZeros == 0 ? 0 : summary.lightest;
+    this->heaviest = summary.nonZeros == 0 ? 0 : summary.heaviest;
+    this->selectStorage();
+}
+
+template <typename W>
+void BasicGraph<W>::removeZeroCells()
+{
+    size_t n = this->vertices;
+    size_t k = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t end = this->rowOffsets[i + 1];
+        this->rowOffsets[i] = k;
+        for (size_t p = start; p < end; p++)
+        {
+            if (this->weights[p] != 0)
+            {
+                this->columnIndices[k] = this->columnIndices[p];
+                this->weights[k] = this->weights[p];
+                k++;
+            }
+        }
+        start = end;
+    }
+    this->rowOffsets[n] = k;
+}
+
+/*
+* @brief
+* These functions add step to a weight, or negate it. Integer weights wrap around at the ends of W,
+* as 8 and 16 bit weights always did, instead of overflowing int and int64_t.
+* @param w - the weight.
+* @param step - 1 or -1.
+* @return W - the new weight.
+*/
+template <typename W>
+static W addWrapping(W w, W step, true_type)
+{
+    typedef typename make_unsigned<W>::type U;
+    return static_cast<W>(static_cast<U>(static_cast<U>(w) + static_cast<U>(step)));
+}
+
+template <typename W>
+static W addWrapping(W w, W step, false_type)
+{
+    return w + step;
+}
+
+template <typename W>
+static W negateWrapping(W w, true_type)
+{
+    typedef typename make_unsigned<W>::type U;
+    return static_cast<W>(static_cast<U>(0 - static_cast<U>(w)));
+}
+
+template <typename W>
+static W negateWrapping(W w, false_type)
+{
+    return -w;
+}
+
+/*
+* @brief
+* These functions give the weight of a cell after ++ (--): missing edges stay missing,
+* and an edge of weight -1 (1) jumps to 1 (-1) so it is not removed.
+* @param w - the weight of the cell.
+* @return W - the new weight.
+*/
+template <typename W>
+static W incrementedWeight(W w)
+{
+    return w == 0 ? 0 : (w == -1 ? 1 : addWrapping(w, W(1), is_integral<W>()));
+}
+
+template <typename W>
+static W decrementedWeight(W w)
+{
+    return w == 0 ? 0 : (w == 1 ? -1 : addWrapping(w, W(-1), is_integral<W>()));
+}
+
+template <typename W>
+void BasicGraph<W>::increment()
+{
+    this->dropResults();
+    size_t n = this->vertices;
+    // The weights do not stay 1, give every cell its own W.
+    this->convertTo(this->storage == Storage::Bitset ? Storage::Dense : this->storage);
+
+    // Integer weights keep their order, so only the lightest and heaviest weights change, unless the heaviest wraps around.
+    // A floating point weight in (-1, 0) goes past the weights of -1 that jump to 1,
+    // so then the cells are summarized again, each row as it is written.
+    bool recount = this->nonZeros != 0 && (!is_integral<W>::value || this->heaviest == numeric_limits<W>::max());
+    if (this->nonZeros != 0 && !recount)
+    {
+        this->lightest = incrementedWeight(this->lightest);
+        this->heaviest = incrementedWeight(this->heaviest);
+    }
+    CellSummary summary;
+    for (size_t i = 0; i < n; i++)
+    {
+        // A row of the sparse weights, of the triangle, or of the matrix.
+        W *a;
+        size_t length;
+        if (this->storage == Storage::Sparse)
+        {
+            a = this->weights.data() + this->rowOffsets[i];
+            length = this->rowOffsets[i + 1] - this->rowOffsets[i];
+        }
+        else if (this->storage == Storage::Symmetric)
+        {
+            a = this->upperRow(i);
+            length = n - i;
+        }
+        else
+        {
+            a = this->row(i);
+            length = n;
+        }
+        for (size_t j = 0; j < length; j++)
+        {
+            a[j] = incrementedWeight(a[j]);
+        }
+        if (recount)
+        {
+            summary.addRow(a, length);
+        }
+    }
+    if (recount)
+    {
+        this->lightest = summary.lightest;
+        this->heaviest = summary.heaviest;
+    }
+    // The edges may all weigh 1 now.
+    if (this->storage != Storage::Sparse)
+    {
+        this->selectStorage();
+    }
+}
+
+template <typename W>
+void BasicGraph<W>::decrement()
+{
+    this->dropResults();
+    size_t n = this->vertices;
+    // The weights do not stay 1, give every cell its own W.
+    this->convertTo(this->storage == Storage::Bitset ? Storage::Dense : this->storage);
+
+    // Integer weights keep their order, so only the lightest and heaviest weights change, unless the lightest wraps around.
+    // A floating point weight in (0, 1) goes past the weights of 1 that jump to -1,
+    // so then the cells are summarized again, each row as it is written.
+    bool recount = this->nonZeros != 0 && (!is_integral<W>::value || this->lightest == numeric_limits<W>::lowest());
+    if (this->nonZeros != 0 && !recount)
+    {
+        this->lightest = decrementedWeight(this->lightest);
+        this->heaviest = decrementedWeight(this->heaviest);
+    }
+    CellSummary summary;
+    for (size_t i = 0; i < n; i++)
+    {
+        // A row of the sparse weights, of the triangle, or of the matrix.
+        W *a;
+        size_t length;
+        if (this->storage == Storage::Sparse)
+        {
+            a = this->weights.data() + this->rowOffsets[i];
+            length = this->rowOffsets[i + 1] - this->rowOffsets[i];
+        }
+        else if (this->storage == Storage::Symmetric)
+        {
+            a = this->upperRow(i);
+            length = n - i;
+        }
+        else
+        {
+            a = this->row(i);
+            length = n;
+        }
+        for (size_t j = 0; j < length; j++)
+        {
+            a[j] = decrementedWeight(a[j]);
+        }
+        if (recount)
+        {
+            summary.addRow(a, length);
+        }
+    }
+    if (recount)
+    {
+        this->lightest = summary.lightest;
+        this->heaviest = summary.heaviest;
+    }
+    // The edges may all weigh 1 now.
+    if (this->storage != Storage::Sparse)
+    {
+        this->selectStorage();
+    }
+}
+
+template <typename W>
+void BasicGraph<W>::loadGraph(const vector<vector<W>> &graph)
+{
+    this->loadMatrix(graph, nullptr);
 }
 
-Graph::~Graph()
+template <typename W>
+void BasicGraph<W>::loadGraph(vector<vector<W>> &&graph)
 {
-    
+    this->loadMatrix(graph, &graph);
+    graph.clear();
 }
 
-void Graph::loadGraph(vector<vector<int>> graph)
+template <typename W>
+void BasicGraph<W>::loadMatrix(const vector<vector<W>> &graph, vector<vector<W>> *owned)
 {
-    this->adjancencyMatrix = graph;
-    this->vertices = graph.size();
     size_t n = graph.size();
-    size_t m = graph[0].size();
 
     // If the graph is not a square matrix, throw an exception.
-    if (n != m)
+    if (n == 0)
+    {
+        throw invalid_argument("Invalid graph");
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        if (graph[i].size() != n)
+        {
+            throw invalid_argument("Invalid graph");
+        }
+    }
+
+    // Count the non zero cells first, to pick the storage before copying.
+    CellSummary summary;
+    for (size_t i = 0; i < n; i++)
+    {
+        summary.addRow(graph[i].data(), n);
+    }
+    size_t count = summary.nonZeros;
+
+    if (static_cast<double>(count) < GraphBase::sparseThreshold * static_cast<double>(n) * static_cast<double>(n))
+    {
+        // Pack the non zero cells of every row.
+        this->resizeSparse(n, count);
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            this->rowOffsets[i] = k;
+            for (size_t j = 0; j < n; j++)
+            {
+                if (graph[i][j] != 0)
+                {
+                    this->columnIndices[k] = j;
+                    this->weights[k] = graph[i][j];
+                    k++;
+                }
+            }
+            BasicGraph<W>::releaseRow(owned, i);
+        }
+        this->rowOffsets[n] = k;
+    }
+    else if (GraphBase::bitsetStorage && summary.lightest == 1 && summary.heaviest == 1)
+    {
+        // Every edge weighs 1, pack the cells of every row 64 to a word.
+        this->resizeBits(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t *dst = this->bitRow(i);
+            const W *src = graph[i].data();
+            for (size_t j = 0; j < n; j++)
+            {
+                dst[j / WORD_BITS] |= uint64_t(src[j] != 0) << (j % WORD_BITS);
+            }
+            BasicGraph<W>::releaseRow(owned, i);
+        }
+    }
+    else if (GraphBase::symmetricStorage && isSymmetricMatrix(graph))
+    {
+        // Undirected, copy the upper triangle of every row.
+        this->resizeSymmetric(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            copy(graph[i].begin() + static_cast<ptrdiff_t>(i), graph[i].end(), this->upperRow(i));
+            BasicGraph<W>::releaseRow(owned, i);
+        }
+    }
+    else
+    {
+        // Copy the rows one after the other into the contiguous matrix.
+        this->resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            W *dst = this->row(i);
+            const W *src = graph[i].data();
+            for (size_t j = 0; j < n; j++)
+            {
+                dst[j] = src[j];
+            }
+            BasicGraph<W>::releaseRow(owned, i);
+        }
+    }
+    this->nonZeros = count;
+    this->directed = !this->isSymmetric();
+    this->edges = this->directed ? count : count / 2;
+    this->lightest = count == 0 ? 0 : summary.lightest;
+    this->heaviest = count == 0 ? 0 : summary.heaviest;
+    this->dropResults();
+}
+
+template <typename W>
+void BasicGraph<W>::loadEdges(size_t n, const vector<Edge> &edges, bool directed)
+{
+    this->loadEdgeChunks(n, &edges, 1, nullptr, directed);
+}
+
+template <typename W>
+void BasicGraph<W>::loadEdgeChunks(size_t n, const vector<Edge> *chunks, size_t count, vector<vector<Edge>> *owned, bool directed)
+{
+    if (n == 0)
     {
         throw invalid_argument("Invalid graph");
     }
-    this->directed = this->isDirected();
-    this->edges = this->countEdges();
 
+    // The cells of every row, an undirected edge is both of its cells, a loop is one cell.
+    vector<size_t> starts(n + 1, 0);
+    for (size_t c = 0; c < count; c++)
+    {
+        for (const Edge &edge : chunks[c])
+        {
+            if (edge.from >= n || edge.to >= n)
+            {
+                throw invalid_argument("The edge must be between vertices of the graph.");
+            }
+            starts[edge.from + 1]++;
+            if (!directed && edge.from != edge.to)
+            {
+                starts[edge.to + 1]++;
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        starts[i + 1] += starts[i];
+    }
+
+    // The lists are scattered in order, so the cells of an edge given more than once stay in the order they were given.
+    this->resizeSparse(n, starts[n]);
+    vector<size_t> next(starts.begin(), starts.end() - 1);
+    for (size_t c = 0; c < count; c++)
+    {
+        for (const Edge &edge : chunks[c])
+        {
+            size_t p = next[edge.from]++;
+            this->columnIndices[p] = edge.to;
+            this->weights[p] = edge.weight;
+            if (!directed && edge.from != edge.to)
+            {
+                p = next[edge.to]++;
+                this->columnIndices[p] = edge.from;
+                this->weights[p] = edge.weight;
+            }
+        }
+        if (owned != nullptr)
+        {
+            vector<Edge>().swap((*owned)[c]);
+        }
+    }
+
+    // Every row is sorted by column, stably, when it is not in order already; edges are often listed in order.
+    // The last of the cells with the same column is the one kept, and the rows are packed to the front of the arrays.
+    vector<Neighbour> row;
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t begin = starts[i], end = starts[i + 1];
+        row.clear();
+        for (size_t p = begin; p < end; p++)
+        {
+            row.push_back({this->columnIndices[p], this->weights[p]});
+        }
+        if (!is_sorted(row.begin(), row.end(), [](const Neighbour &a, const Neighbour &b)
+                       { return a.vertex < b.vertex; }))
+        {
+            stable_sort(row.begin(), row.end(), [](const Neighbour &a, const Neighbour &b)
+                        { return a.vertex < b.vertex; });
+        }
+        this->rowOffsets[i] = k;
+        for (size_t p = 0; p < row.size(); p++)
+        {
+            bool last = p + 1 == row.size() || row[p + 1].vertex != row[p].vertex;
+            if (last && row[p].weight != 0)
+            {
+                this->columnIndices[k] = row[p].vertex;
+                this->weights[k] = row[p].weight;
+                k++;
+            }
+        }
+    }
+    this->rowOffsets[n] = k;
+
+    CellSummary summary;
+    summary.addRow(this->weights.data(), k);
+    this->dropResults();
+    // Edges given as directed may still all have their reverse edge, then the graph is undirected.
+    this->directed = directed;
+    this->updateMetadata(summary, directed);
+}
+
+template <typename W>
+void BasicGraph<W>::releaseRow(vector<vector<W>> *owned, size_t i)
+{
+    if (owned != nullptr)
+    {
+        vector<W>().swap((*owned)[i]);
+    }
 }
 
-void Graph::printGraph()
+template <typename W>
+void BasicGraph<W>::printGraph()
 {
-    cout << "Graph with " << this->vertices << " vertices and " << this->countEdges() << " edges." << endl;
+    cout << "Graph with " << this->vertices << " vertices and " << this->edges << " edges." << endl;
 
 }
 
-size_t Graph::getVertices()
+template <typename W>
+size_t BasicGraph<W>::getVertices() const
 {
     return this->vertices;
 }
 
-size_t Graph::getEdges()
+template <typename W>
+size_t BasicGraph<W>::getEdges() const
 {
     return this->edges;
 }
 
-bool Graph::isDirected()
+template <typename W>
+bool BasicGraph<W>::isDirected() const
 {
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
+    return this->directed;
+}
 
-    // Iterate over the matrix and check if the graph is directed.
-    for (size_t i = 0; i < n; i++)
+template <typename W>
+W BasicGraph<W>::getLightestWeight() const
+{
+    return this->lightest;
+}
+
+template <typename W>
+W BasicGraph<W>::getHeaviestWeight() const
+{
+    return this->heaviest;
+}
+
+template <typename W>
+bool BasicGraph<W>::hasNegativeWeights() const
+{
+    return this->lightest < 0;
+}
+
+/*
+* @brief
+* This function transposes a 64 x 64 block of bits in place, bit j of block[i] swaps with bit i of block[j].
+* Every step swaps the off diagonal quarters of the blocks of the step before, from 32 x 32 quarters down to single bits.
+* @param block - the 64 rows of the block.
+* @return void
+*/
+static void transposeBits(uint64_t *block)
+{
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (size_t width = 32; width != 0; width >>= 1, mask ^= mask << width)
     {
-        for (size_t j = 0; j < m; j++)
-        {   
-            // If the graph is directed, the adjacency matrix is not symmetric.
-            if (this->adjancencyMatrix[i][j] != this->adjancencyMatrix[j][i])
-            {
-                return true;
-            }
+        for (size_t k = 0; k < 64; k = (k + width + 1) & ~width)
+        {
+            uint64_t swapped = ((block[k] >> width) ^ block[k + width]) & mask;
+            block[k + width] ^= swapped;
+            block[k] ^= swapped << width;
         }
     }
-    return false;
 }
 
-size_t Graph::countEdges()
+template <typename W>
+bool BasicGraph<W>::isSymmetric() const
 {
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
-    size_t count = 0;
+    size_t n = this->vertices;
 
-    // Iterate over the matrix and count the number of edges.
-    for (size_t i = 0; i < n; i++)
+    // Only the upper triangle is stored.
+    if (this->storage == Storage::Symmetric)
+    {
+        return true;
+    }
+
+    if (this->storage == Storage::Bitset)
+    {
+        // Compare every block of 64 x 64 bits of the upper triangle, transposed, with its mirror block.
+        size_t blocks = (n + WORD_BITS - 1) / WORD_BITS;
+        uint64_t block[WORD_BITS], mirror[WORD_BITS];
+        for (size_t bi = 0; bi < blocks; bi++)
+        {
+            for (size_t bj = bi; bj < blocks; bj++)
+            {
+                for (size_t r = 0; r < WORD_BITS; r++)
+                {
+                    block[r] = bi * WORD_BITS + r < n ? this->bitRow(bi * WORD_BITS + r)[bj] : 0;
+                    mirror[r] = bj * WORD_BITS + r < n ? this->bitRow(bj * WORD_BITS + r)[bi] : 0;
+                }
+                transposeBits(block);
+                if (memcmp(block, mirror, sizeof(block)) != 0)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    if (this->storage == Storage::Sparse)
+    {
+        // Every stored cell must have a mirror cell with the same weight.
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t k = this->rowOffsets[i]; k < this->rowOffsets[i + 1]; k++)
+            {
+                if (this->cell(this->columnIndices[k], i) != this->weights[k])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Compare every tile of the upper triangle with its mirror tile, so both stay in the cache.
+    for (size_t ib = 0; ib < n; ib += TILE)
     {
-        for (size_t j = 0; j < m; j++)
+        size_t iEnd = min(ib + TILE, n);
+        for (size_t jb = ib; jb < n; jb += TILE)
         {
-            // If the value is not 0, then there is an edge.
-            if (this->adjancencyMatrix[i][j] != 0)
+            size_t jEnd = min(jb + TILE, n);
+            for (size_t i = ib; i < iEnd; i++)
             {
-                count++;
+                const W *rowI = this->row(i);
+                for (size_t j = max(jb, i + 1); j < jEnd; j++)
+                {
+                    // If the graph is directed, the adjacency matrix is not symmetric.
+                    if (rowI[j] != this->row(j)[i])
+                    {
+                        return false;
+                    }
+                }
             }
         }
     }
+    return true;
+}
+
+template <typename W>
+size_t BasicGraph<W>::countEdges() const
+{
+    size_t count = this->countNonZeros();
+
     // If the graph is directed, return the count, if the graph is undirected, then every edge is counted twice.
     return this->directed ? count : count / 2;
 }
 
-vector<vector<int>> Graph::getAdjacencyMatrix() 
+template <typename W>
+typename BasicGraph<W>::Storage BasicGraph<W>::getStorage() const
 {
-    return this->adjancencyMatrix;
+    return this->storage;
 }
 
-vector<vector<int>> Graph::getTranspose()
+void GraphBase::setSparseThreshold(double density)
 {
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
-    vector<vector<int>> transpose(n, vector<int>(m, 0));
+    GraphBase::sparseThreshold = density;
+}
 
-    for (size_t i = 0; i < n; i++)
+double GraphBase::getSparseThreshold()
+{
+    return GraphBase::sparseThreshold;
+}
+
+void GraphBase::setBitsetStorage(bool enabled)
+{
+    GraphBase::bitsetStorage = enabled;
+}
+
+bool GraphBase::getBitsetStorage()
+{
+    return GraphBase::bitsetStorage;
+}
+
+void GraphBase::setSymmetricStorage(bool enabled)
+{
+    GraphBase::symmetricStorage = enabled;
+}
+
+bool GraphBase::getSymmetricStorage()
+{
+    return GraphBase::symmetricStorage;
+}
+
+template <typename W>
+typename BasicGraph<W>::NeighbourRange BasicGraph<W>::neighbours(size_t v) const
+{
+    size_t n = this->vertices;
+    if (this->storage == Storage::Dense)
     {
-        
-        for (size_t j = 0; j < m; j++)
-        {
-            transpose[j][i] = this->adjancencyMatrix[i][j];
-        }
+        return NeighbourRange(NeighbourIterator(this->row(v), nullptr, nullptr, nullptr, 0, n),
+                              NeighbourIterator(this->row(v), nullptr, nullptr, nullptr, n, n));
     }
-    return transpose;
+    if (this->storage == Storage::Bitset)
+    {
+        return NeighbourRange(NeighbourIterator(nullptr, this->bitRow(v), nullptr, nullptr, 0, n),
+                              NeighbourIterator(nullptr, this->bitRow(v), nullptr, nullptr, n, n));
+    }
+    if (this->storage == Storage::Symmetric)
+    {
+        // The first cell of the row is cell (0, v) of the triangle.
+        const W *packed = this->adjancencyMatrix.data();
+        return NeighbourRange(NeighbourIterator(nullptr, nullptr, nullptr, nullptr, 0, n, packed + v, v),
+                              NeighbourIterator(nullptr, nullptr, nullptr, nullptr, n, n, packed, v));
+    }
+    size_t first = this->rowOffsets[v];
+    size_t last = this->rowOffsets[v + 1];
+    return NeighbourRange(NeighbourIterator(nullptr, nullptr, this->columnIndices.data(), this->weights.data(), first, last),
+                          NeighbourIterator(nullptr, nullptr, this->columnIndices.data(), this->weights.data(), last, last));
+}
+
+template <typename W>
+typename BasicGraph<W>::RowView BasicGraph<W>::getRow(size_t i) const
+{
+    return RowView(this, i);
+}
+
+template <typename W>
+W BasicGraph<W>::getWeight(size_t i, size_t j) const
+{
+    return this->cell(i, j);
+}
+
+template <typename W>
+shared_ptr<const ariel::BasicAllPairsPaths<W>> BasicGraph<W>::getAllPairsPaths() const
+{
+    lock_guard<mutex> guard(this->results.lock);
+    if (!this->results.allPairsPaths)
+    {
+        this->results.allPairsPaths = make_shared<ariel::BasicAllPairsPaths<W>>(*this);
+    }
+    return this->results.allPairsPaths;
 }
 
-set<pair<int, int>> Graph::getEdgesSet() const
+template <typename W>
+shared_ptr<const ariel::ReachabilityIndex> BasicGraph<W>::getReachability() const
 {
-        size_t n = this->adjancencyMatrix.size();
-        size_t m = this->adjancencyMatrix[0].size();
-        set<pair<int, int>> edges;
+    lock_guard<mutex> guard(this->results.lock);
+    if (!this->results.reachability)
+    {
+        this->results.reachability = make_shared<ariel::ReachabilityIndex>(*this);
+    }
+    return this->results.reachability;
+}
 
+template <typename W>
+shared_ptr<const ariel::DisjointSet> BasicGraph<W>::getConnectivity() const
+{
     if (this->directed)
     {
-        for (size_t i = 0; i < n; i++)
+        throw invalid_argument("The graph must be undirected.");
+    }
+    lock_guard<mutex> guard(this->results.lock);
+    if (!this->results.connectivity)
+    {
+        this->results.connectivity = make_shared<ariel::DisjointSet>(*this);
+    }
+    return this->results.connectivity;
+}
+
+template <typename W>
+BasicGraph<W> BasicGraph<W>::transposed() const
+{
+    size_t n = this->vertices;
+    BasicGraph<W> t;
+
+    if (this->storage == Storage::Symmetric)
+    {
+        // An undirected graph is its own transpose.
+        t = *this;
+        return t;
+    }
+    if (this->storage == Storage::Bitset)
+    {
+        // Block (bi, bj) of 64 x 64 bits, transposed, is block (bj, bi) of the transpose.
+        t.resizeBits(n);
+        size_t blocks = (n + WORD_BITS - 1) / WORD_BITS;
+        uint64_t block[WORD_BITS];
+        for (size_t bi = 0; bi < blocks; bi++)
         {
-            for (size_t j = 0; j < m; j++)
+            for (size_t bj = 0; bj < blocks; bj++)
             {
-                if (this->adjancencyMatrix[i][j] != 0)
+                for (size_t r = 0; r < WORD_BITS; r++)
                 {
-                    
-                    edges.emplace(i, j);
+                    block[r] = bi * WORD_BITS + r < n ? this->bitRow(bi * WORD_BITS + r)[bj] : 0;
+                }
+                transposeBits(block);
+                for (size_t r = 0; r < WORD_BITS && bj * WORD_BITS + r < n; r++)
+                {
+                    t.bitRow(bj * WORD_BITS + r)[bi] = block[r];
                 }
             }
         }
-    } 
-    else 
+    }
+    else if (this->storage == Storage::Dense)
     {
-        for (size_t i = 0; i < n; i++)
+        t.resize(n);
+        // Transpose tile by tile, so both the rows read and the rows written stay in the cache.
+        for (size_t ib = 0; ib < n; ib += TILE)
         {
-            for (size_t j = i; j < m; j++)
+            for (size_t jb = 0; jb < n; jb += TILE)
             {
-                if (this->adjancencyMatrix[i][j] != 0)
+                for (size_t i = ib; i < min(ib + TILE, n); i++)
                 {
-                    edges.emplace(i, j);
+                    const W *rowI = this->row(i);
+                    for (size_t j = jb; j < min(jb + TILE, n); j++)
+                    {
+                        t.row(j)[i] = rowI[j];
+                    }
                 }
             }
         }
     }
+    else
+    {
+        // Counting sort of the cells by column: count the cells of every column, then place them.
+        t.resizeSparse(n, this->nonZeros);
+        for (size_t k = 0; k < this->nonZeros; k++)
+        {
+            t.rowOffsets[this->columnIndices[k] + 1]++;
+        }
+        for (size_t j = 0; j < n; j++)
+        {
+            t.rowOffsets[j + 1] += t.rowOffsets[j];
+        }
+        vector<size_t> next(t.rowOffsets.data(), t.rowOffsets.data() + n);
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t k = this->rowOffsets[i]; k < this->rowOffsets[i + 1]; k++)
+            {
+                size_t position = next[this->columnIndices[k]]++;
+                t.columnIndices[position] = i;
+                t.weights[position] = this->weights[k];
+            }
+        }
+    }
+    t.nonZeros = this->nonZeros;
+    t.edges = this->edges;
+    t.directed = this->directed;
+    t.lightest = this->lightest;
+    t.heaviest = this->heaviest;
+    return t;
+}
+
+template <typename W>
+vector<vector<W>> BasicGraph<W>::getAdjacencyMatrix() const
+{
+    size_t n = this->vertices;
+    vector<vector<W>> matrix(n);
+    vector<W> scratch(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const W *rowI = this->denseRow(i, scratch.data());
+        matrix[i].assign(rowI, rowI + n);
+    }
+    return matrix;
+}
+
+template <typename W>
+vector<vector<W>> BasicGraph<W>::getTranspose() const
+{
+    size_t n = this->vertices;
+    vector<vector<W>> transpose(n, vector<W>(n, 0));
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (Neighbour neighbour : this->neighbours(i))
+        {
+            transpose[neighbour.vertex][i] = neighbour.weight;
+        }
+    }
+    return transpose;
+}
+
+template <typename W>
+set<pair<int, int>> BasicGraph<W>::getEdgesSet() const
+{
+    size_t n = this->vertices;
+    set<pair<int, int>> edges;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        for (Neighbour neighbour : this->neighbours(i))
+        {
+            // An undirected edge appears twice in the matrix, only take it from the upper triangle.
+            if (this->directed || neighbour.vertex >= i)
+            {
+                edges.emplace(i, neighbour.vertex);
+            }
+        }
+    }
     return edges;
 }
 
-vector<int> Graph::getVerticesSet()
+template <typename W>
+vector<int> BasicGraph<W>::getVerticesSet()
 {
-    size_t n = this->adjancencyMatrix.size();
+    size_t n = this->vertices;
     vector<int> vertices;
 
     for (size_t i = 0; i < n; i++)
     {
         vertices.push_back(i);
     }
-    return vertices;
-}
-
-bool Graph::isSubgraph(const Graph &g) const
-{
-    size_t n1 = this->adjancencyMatrix.size();
-    size_t m1 = this->adjancencyMatrix[0].size();
-    size_t n2 = g.adjancencyMatrix.size();
-    size_t m2 = g.adjancencyMatrix[0].size();
+    return vertices;
+}
+
+template <typename W>
+bool BasicGraph<W>::isSubgraph(const BasicGraph &g) const
+{
+    size_t n1 = this->vertices;
+    size_t n2 = g.vertices;
+
+    // Both graphs in bitset storage, with their edges read the same way: compare the rows a word at a time.
+    if (this->storage == Storage::Bitset && g.storage == Storage::Bitset && this->directed == g.directed)
+    {
+        // An undirected edge set holds every edge once, a loop is a single cell of the matrix, any other edge two.
+        auto edgeSetSize = [](const BasicGraph<W> &graph)
+        {
+            size_t loops = 0;
+            for (size_t i = 0; !graph.directed && i < graph.vertices; i++)
+            {
+                loops += (graph.bitRow(i)[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+            }
+            return graph.directed ? graph.nonZeros : (graph.nonZeros + loops) / 2;
+        };
+        if (n1 < n2 || edgeSetSize(*this) <= edgeSetSize(g))
+        {
+            return false;
+        }
+        // g has a smaller or equal number of vertices, so its rows have at most as many words.
+        size_t words = (n2 + WORD_BITS - 1) / WORD_BITS;
+        for (size_t i = 0; i < n2; i++)
+        {
+            const uint64_t *rowThis = this->bitRow(i);
+            const uint64_t *rowG = g.bitRow(i);
+            for (size_t w = 0; w < words; w++)
+            {
+                if ((rowG[w] & ~rowThis[w]) != 0)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
 
     set<pair<int, int>> edges1 = this->getEdgesSet();
     set<pair<int, int>> edges2 = g.getEdgesSet();
 
-    if (n1 < n2 || m1 < m2)
+    if (n1 < n2)
     {
         return false;
     }
@@ -197,18 +1428,167 @@ bool Graph::isSubgraph(const Graph &g) const
     return true;
 }
 
-ostream &ariel::operator<<(ostream &os, const Graph &g)
+// The numbers 00 .. 99 as two characters each, integers are written two digits at a time.
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/*
+* @brief
+* This function writes an integer in decimal, as a stream with the default flags prints it.
+* @param out - where to write, room for at least 20 characters.
+* @param value - the integer.
+* @return char* - the end of the written digits.
+*/
+template <typename T>
+static char *writeInteger(char *out, T value)
+{
+    // The magnitude is taken in 64 bits, so the lowest value of every type, -2^63 too, is negated without overflow.
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    if (value < 0)
+    {
+        *out++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    char digits[20];
+    char *end = digits + sizeof(digits);
+    char *first = end;
+    while (magnitude >= 100)
+    {
+        first -= 2;
+        memcpy(first, DIGIT_PAIRS + magnitude % 100 * 2, 2);
+        magnitude /= 100;
+    }
+    if (magnitude >= 10)
+    {
+        first -= 2;
+        memcpy(first, DIGIT_PAIRS + magnitude * 2, 2);
+    }
+    else
+    {
+        *--first = static_cast<char>('0' + magnitude);
+    }
+    size_t length = static_cast<size_t>(end - first);
+    memcpy(out, first, length);
+    return out + length;
+}
+
+/*
+* @brief
+* These functions write a weight of the matrix, an integer with writeInteger,
+* a floating point weight with %g, which is how a stream with the default flags prints it.
+* @param out - where to write, room for the longest weight at the precision.
+* @param value - the weight.
+* @param precision - the significant digits of a floating point weight.
+* @return char* - the end of the written weight.
+*/
+template <typename W>
+static char *writeCell(char *out, W value, int, true_type)
+{
+    return writeInteger(out, value);
+}
+
+template <typename W>
+static char *writeCell(char *out, W value, int precision, false_type)
+{
+    int length = snprintf(out, static_cast<size_t>(PRINT_MAX_PRECISION) + 16, "%.*g", precision, static_cast<double>(value));
+    return out + length;
+}
+
+template <typename W>
+void BasicGraph<W>::formatRows(int precision, const function<void(const char *, size_t)> &write) const
+{
+    size_t n = this->vertices;
+    vector<W> scratch(n);
+    // The longest cell and its ", ": a sign and 19 digits, or %g with a sign, a point and an exponent of 3 digits.
+    size_t cellBytes = (is_integral<W>::value ? 20 : static_cast<size_t>(PRINT_MAX_PRECISION) + 16) + 2;
+    size_t rowBytes = n * cellBytes + 8;
+    vector<char> buffer(max(PRINT_BUFFER_BYTES, rowBytes));
+    size_t used = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (buffer.size() - used < rowBytes)
+        {
+            write(buffer.data(), used);
+            used = 0;
+        }
+        const W *row = this->denseRow(i, scratch.data());
+        char *out = buffer.data() + used;
+        *out++ = '[';
+        for (size_t j = 0; j < n; j++)
+        {
+            out = writeCell(out, row[j], precision, is_integral<W>());
+            if (j != n - 1)
+            {
+                *out++ = ',';
+                *out++ = ' ';
+            }
+        }
+        *out++ = ']';
+        if (i != n - 1)
+        {
+            *out++ = ',';
+            *out++ = ' ';
+        }
+        *out++ = '\n';
+        used = static_cast<size_t>(out - buffer.data());
+    }
+    // The slack of the last row leaves room for the empty line at the end.
+    buffer[used++] = '\n';
+    write(buffer.data(), used);
+}
+
+template <typename W>
+void BasicGraph<W>::writeMatrix(int descriptor) const
 {
-    size_t n = g.adjancencyMatrix.size();
-    size_t m = g.adjancencyMatrix[0].size();
+    this->formatRows(6, [descriptor](const char *text, size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t written = ::write(descriptor, text, length);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw runtime_error("Writing the graph failed: " + string(strerror(errno)));
+            }
+            text += written;
+            length -= static_cast<size_t>(written);
+        }
+    });
+}
 
+template <typename W>
+ostream &ariel::operator<<(ostream &os, const BasicGraph<W> &g)
+{
+    // formatRows prints what << prints with the default flags, in the classic locale and the C locale of printf.
+    ios::fmtflags flags = os.flags();
+    ios::fmtflags basefield = flags & ios::basefield;
+    bool plain = os.width() == 0 && (flags & (ios::showpos | ios::uppercase | ios::showpoint | ios::showbase)) == 0 &&
+                 basefield != ios::hex && basefield != ios::oct && os.getloc() == locale::classic() &&
+                 (is_integral<W>::value || ((flags & ios::floatfield) == 0 && os.precision() <= PRINT_MAX_PRECISION &&
+                                            strcmp(localeconv()->decimal_point, ".") == 0));
+    if (plain)
+    {
+        g.formatRows(static_cast<int>(os.precision()), [&os](const char *text, size_t length)
+        {
+            os.write(text, static_cast<streamsize>(length));
+        });
+        os.flush();
+        return os;
+    }
+    size_t n = g.vertices;
+    vector<W> scratch(n);
     for (size_t i = 0; i < n; i++)
     {
+        const W *row = g.denseRow(i, scratch.data());
         os << "[";
-        for (size_t j = 0; j < m; j++)
+        for (size_t j = 0; j < n; j++)
         {
-            os << g.adjancencyMatrix[i][j];
-            if (j != m - 1)
+            // Unary + prints 8 bit weights as numbers, not as characters.
+            os << +row[j];
+            if (j != n - 1)
             {
                 os << ", ";
             }
@@ -224,340 +1604,708 @@ ostream &ariel::operator<<(ostream &os, const Graph &g)
     return os;
 }
 
-Graph ariel::operator+(const Graph &g1, const Graph &g2)
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator+=(const BasicGraph &g)
 {
-    size_t n1 = g1.adjancencyMatrix.size();
-    size_t m1 = g1.adjancencyMatrix[0].size();
-    size_t n2 = g2.adjancencyMatrix.size();
-    size_t m2 = g2.adjancencyMatrix[0].size();
+    size_t n = this->vertices;
 
     // If the matrices are not the same size, throw an exception.
-    if (n1 != n2 || m1 != m2)
+    if (n != g.vertices)
     {
         throw invalid_argument("The matrices must be the same size.");
     }
-    vector<vector<int>> sum(n1, vector<int>(m1, 0));
-
-    // Iterate over the matrices and add the values.
-    for (size_t i = 0; i < n1; i++)
+    // Adding edges without negative weights to an undirected graph can't remove an edge, it only joins components.
+    shared_ptr<ariel::DisjointSet> connectivity;
+    if (!this->directed && !g.directed && !this->hasNegativeWeights() && !g.hasNegativeWeights())
     {
-        for (size_t j = 0; j < m1; j++)
+        connectivity = this->results.connectivity;
+    }
+    this->dropResults();
+    CellSummary summary;
+    // Two undirected graphs in symmetric storage: only the upper triangles are added.
+    if (this->storage == Storage::Symmetric && g.storage == Storage::Symmetric)
+    {
+        for (size_t i = 0; i < n; i++)
         {
-            sum[i][j] = g1.adjancencyMatrix[i][j] + g2.adjancencyMatrix[i][j];
+            W *a = this->upperRow(i);
+            const W *b = g.upperRow(i);
+            for (size_t j = 0; j < n - i; j++)
+            {
+                a[j] += b[j];
+            }
+            summary.addUpperRow(a, n - i);
         }
     }
-    Graph g;
-    g.loadGraph(sum);
-    return g;
-}
-
-Graph Graph::operator+=(Graph &g)
-{
-    size_t n1 = this->adjancencyMatrix.size();
-    size_t m1 = this->adjancencyMatrix[0].size();
-    size_t n2 = g.adjancencyMatrix.size();
-    size_t m2 = g.adjancencyMatrix[0].size();
-
-    // If the matrices are not the same size, throw an exception.
-    if (n1 != n2 || m1 != m2)
+    else
     {
-        throw invalid_argument("The matrices must be the same size.");
-    }
+        this->convertTo(Storage::Dense);
+        // Only a sparse g needs a scratch row.
+        vector<W> scratch(g.storage == Storage::Dense ? 0 : n);
 
-    // Iterate over the matrices and add the values.
-    for (size_t i = 0; i < n1; i++)
+        // Iterate over the matrices and add the values.
+        for (size_t i = 0; i < n; i++)
+        {
+            W *a = this->row(i);
+            const W *b = g.denseRow(i, scratch.data());
+            for (size_t j = 0; j < n; j++)
+            {
+                a[j] += b[j];
+            }
+            summary.addRow(a, n);
+        }
+    }
+    // The sum of two symmetric matrices is symmetric, otherwise check again.
+    this->updateMetadata(summary, this->directed || g.directed);
+    if (connectivity)
     {
-        for (size_t j = 0; j < m1; j++)
+        // Another graph or a caller still holds the components of the graph before the sum.
+        if (connectivity.use_count() > 1)
         {
-            this->adjancencyMatrix[i][j] += g.adjancencyMatrix[i][j];
+            connectivity = make_shared<ariel::DisjointSet>(*connectivity);
         }
+        connectivity->unite(g);
+        this->results.connectivity = connectivity;
     }
-    this->edges = this->countEdges();
     return *this;
 }
 
-Graph Graph::operator+()
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator+()
 {
     return *this;
 }
 
-Graph Graph::operator++()
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator++()
 {
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
+    this->increment();
+    return *this;
+}
 
-    // Iterate over the matrix and increment the values.
-    for (size_t i = 0; i < n; i++)
+template <typename W>
+BasicGraph<W> BasicGraph<W>::operator++(int)
+{
+    BasicGraph<W> g = *this;
+    this->increment();
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator-=(const BasicGraph &g)
+{
+    size_t n = this->vertices;
+
+    // If the matrices are not the same size, throw an exception.
+    if (n != g.vertices)
+    {
+        throw invalid_argument("The matrices must be the same size.");
+    }
+    this->dropResults();
+    CellSummary summary;
+    // Two undirected graphs in symmetric storage: only the upper triangles are subtracted.
+    if (this->storage == Storage::Symmetric && g.storage == Storage::Symmetric)
     {
-        for (size_t j = 0; j < m; j++)
+        for (size_t i = 0; i < n; i++)
         {
-            if (this->adjancencyMatrix[i][j] != 0 && this->adjancencyMatrix[i][j] != -1)
+            W *a = this->upperRow(i);
+            const W *b = g.upperRow(i);
+            for (size_t j = 0; j < n - i; j++)
             {
-                this->adjancencyMatrix[i][j]++;
+                a[j] -= b[j];
             }
+            summary.addUpperRow(a, n - i);
+        }
+    }
+    else
+    {
+        this->convertTo(Storage::Dense);
+        // Only a sparse g needs a scratch row.
+        vector<W> scratch(g.storage == Storage::Dense ? 0 : n);
 
-            else if (this->adjancencyMatrix[i][j] == -1)
+        // Iterate over the matrices and subtract the values.
+        for (size_t i = 0; i < n; i++)
+        {
+            W *a = this->row(i);
+            const W *b = g.denseRow(i, scratch.data());
+            for (size_t j = 0; j < n; j++)
             {
-                this->adjancencyMatrix[i][j] = 1;
+                a[j] -= b[j];
             }
+            summary.addRow(a, n);
         }
     }
-    this->edges = this->countEdges();
+    // The difference of two symmetric matrices is symmetric, otherwise check again.
+    this->updateMetadata(summary, this->directed || g.directed);
     return *this;
 }
 
-Graph Graph::operator++(int)
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator-()
 {
-    Graph g = *this;
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
-
-    // Iterate over the matrix and increment the values.
-    for (size_t i = 0; i < n; i++)
+    this->dropResults();
+    size_t n = this->vertices;
+    // Negating reverses the order of the weights, but the lowest integer stays itself,
+    // so with a cell of that weight the cells are summarized again, each row as it is written.
+    bool recount = is_integral<W>::value && this->nonZeros != 0 && this->lightest == numeric_limits<W>::lowest();
+    W lightest = this->lightest;
+    this->lightest = negateWrapping(this->heaviest, is_integral<W>());
+    this->heaviest = negateWrapping(lightest, is_integral<W>());
+    this->convertTo(this->storage == Storage::Bitset ? Storage::Dense : this->storage);
+
+    CellSummary summary;
+    if (this->storage == Storage::Sparse)
     {
-        for (size_t j = 0; j < m; j++)
+        for (size_t k = 0; k < this->nonZeros; k++)
         {
-            if (this->adjancencyMatrix[i][j] != 0 && this->adjancencyMatrix[i][j] != -1)
+            this->weights[k] = negateWrapping(this->weights[k], is_integral<W>());
+        }
+        if (recount)
+        {
+            summary.addRow(this->weights.data(), this->nonZeros);
+        }
+    }
+    else if (this->storage == Storage::Symmetric)
+    {
+        W *a = this->adjancencyMatrix.data();
+        for (size_t k = 0; k < n * (n + 1) / 2; k++)
+        {
+            a[k] = negateWrapping(a[k], is_integral<W>());
+        }
+        if (recount)
+        {
+            summary.addRow(a, n * (n + 1) / 2);
+        }
+    }
+    else
+    {
+        // Iterate over the matrix and negate the values.
+        for (size_t i = 0; i < n; i++)
+        {
+            W *a = this->row(i);
+            for (size_t j = 0; j < n; j++)
             {
-                this->adjancencyMatrix[i][j]++;
+                a[j] = negateWrapping(a[j], is_integral<W>());
             }
-
-            else if (this->adjancencyMatrix[i][j] == -1)
+            if (recount)
             {
-                this->adjancencyMatrix[i][j] = 1;
+                summary.addRow(a, n);
             }
         }
     }
-    this->edges = this->countEdges();
+    if (recount)
+    {
+        this->lightest = summary.lightest;
+        this->heaviest = summary.heaviest;
+    }
+    // The edges may all weigh 1 now.
+    if (this->storage != Storage::Sparse)
+    {
+        this->selectStorage();
+    }
+    return *this;
+}
+
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator--()
+{
+    this->decrement();
+    return *this;
+}
+
+template <typename W>
+BasicGraph<W> BasicGraph<W>::operator--(int)
+{
+    BasicGraph<W> g = *this;
+    this->decrement();
     return g;
 }
 
-Graph ariel::operator-(const Graph &g1, const Graph &g2)
+template <typename W>
+BasicGraph<W> ariel::operator*(const BasicGraph<W> &g1, const BasicGraph<W> &g2)
 {
-    size_t n1 = g1.adjancencyMatrix.size();
-    size_t m1 = g1.adjancencyMatrix[0].size();
-    size_t n2 = g2.adjancencyMatrix.size();
-    size_t m2 = g2.adjancencyMatrix[0].size();
+    return ariel::multiply(g1, g2, 0);
+}
 
-    // If the matrices are not the same size, throw an exception.
-    if (n1 != n2 || m1 != m2)
+template <typename W>
+BasicGraph<W> ariel::multiply(const BasicGraph<W> &g1, const BasicGraph<W> &g2, size_t threads)
+{
+    size_t n = g1.vertices;
+
+    if (n != g2.vertices)
     {
-        throw invalid_argument("The matrices must be the same size.");
+        throw invalid_argument("The number of columns in the first matrix must be equal to the number of rows in the second matrix");
     }
-    vector<vector<int>> diff(n1, vector<int>(m1, 0));
 
-    // Iterate over the matrices and subtract the values.
-    for (size_t i = 0; i < n1; i++)
+    // Both operands are below the sparse threshold, most of the dense product would be multiplications by zero.
+    if (g1.storage == BasicGraph<W>::Storage::Sparse && g2.storage == BasicGraph<W>::Storage::Sparse)
     {
-        for (size_t j = 0; j < m1; j++)
-        {
-            diff[i][j] = g1.adjancencyMatrix[i][j] - g2.adjancencyMatrix[i][j];
-        }
+        return BasicGraph<W>::multiplySparse(g1, g2, threads);
+    }
+    // Both operands hold only 0 and 1, 64 cells of a row and a column are multiplied and summed by an and and a popcount.
+    if (g1.storage == BasicGraph<W>::Storage::Bitset && g2.storage == BasicGraph<W>::Storage::Bitset)
+    {
+        return BasicGraph<W>::multiplyBits(g1, g2, threads);
     }
-    Graph g;
-    g.loadGraph(diff);
+
+    BasicGraph<W> g;
+    g.resize(n);
+    BasicGraph<W>::multiplyDense(g1, g2, g, threads);
     return g;
 }
 
-Graph Graph::operator-=(Graph &g)
+template <typename W>
+BasicGraph<W> ariel::operator*(BasicGraph<W> &&g1, const BasicGraph<W> &g2)
 {
-    size_t n1 = this->adjancencyMatrix.size();
-    size_t m1 = this->adjancencyMatrix[0].size();
-    size_t n2 = g.adjancencyMatrix.size();
-    size_t m2 = g.adjancencyMatrix[0].size();
-
-    // If the matrices are not the same size, throw an exception.
-    if (n1 != n2 || m1 != m2)
-    {
-        throw invalid_argument("The matrices must be the same size.");
-    }
-
-    // Iterate over the matrices and subtract the values.
-    for (size_t i = 0; i < n1; i++)
+    // The rows of g1 can only be written over in dense storage, and if g2 is another graph.
+    if (g1.storage != BasicGraph<W>::Storage::Dense || &g1 == &g2 || g2.storage == BasicGraph<W>::Storage::Sparse || g1.vertices != g2.vertices)
     {
-        for (size_t j = 0; j < m1; j++)
-        {
-            this->adjancencyMatrix[i][j] -= g.adjancencyMatrix[i][j];
-        }
+        return ariel::multiply(g1, g2, 0);
     }
-    this->edges = this->countEdges();
-    return *this;
+    BasicGraph<W>::multiplyDense(g1, g2, g1, 0);
+    return move(g1);
 }
 
-Graph Graph::operator-()
+template <typename W>
+void BasicGraph<W>::multiplyDense(const BasicGraph &g1, const BasicGraph &g2, BasicGraph &g, size_t threads)
 {
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
+    size_t n = g1.vertices;
 
-    // Iterate over the matrix and negate the values.
-    for (size_t i = 0; i < n; i++)
+    // The product reads whole rows of g2, so it needs g2 in dense storage.
+    BasicGraph<W> denseCopy;
+    const BasicGraph<W> *b = &g2;
+    if (g2.storage != BasicGraph<W>::Storage::Dense)
+    {
+        denseCopy = g2;
+        denseCopy.convertTo(BasicGraph<W>::Storage::Dense);
+        b = &denseCopy;
+    }
+
+    // When g is g1, a group of product rows is kept aside until the rows of g1 it is computed from are no longer read.
+    bool inPlace = &g == &g1;
+    size_t groups = (n + MULTIPLY_ROWS - 1) / MULTIPLY_ROWS;
+    size_t chunks = min(groups, MULTIPLY_CHUNKS * (threads == 0 ? ariel::ThreadPool::getThreadCount() : threads));
+    // A sparse g1 is scattered into dense rows, a dense one is read in place.
+    vector<W> scratch(g1.storage == BasicGraph<W>::Storage::Dense ? 0 : chunks * MULTIPLY_ROWS * n);
+    vector<W> aside(inPlace ? chunks * MULTIPLY_ROWS * n : 0);
+    vector<CellSummary> summaries(chunks);
+    // The square of a symmetric matrix is symmetric, any other product has to be checked.
+    bool recheckDirected = &g1 != &g2 || g1.directed;
+
+    // i-k-j order: row i of the product is the sum of the rows k of g2, scaled by g1[i][k].
+    // The rows of g2 are read in blocks of MULTIPLY_K_BLOCK x MULTIPLY_J_BLOCK that stay in the cache,
+    // while the product rows are computed MULTIPLY_ROWS at a time, so every cell of g2 loaded is used MULTIPLY_ROWS times.
+    // Every group of rows is computed by one thread in the same order, so the product does not depend on the number of threads.
+    ariel::ThreadPool::instance().parallelFor(chunks, threads, [&](size_t chunk)
     {
-        for (size_t j = 0; j < m; j++)
+        W *chunkScratch = scratch.empty() ? nullptr : scratch.data() + chunk * MULTIPLY_ROWS * n;
+        W *chunkAside = aside.empty() ? nullptr : aside.data() + chunk * MULTIPLY_ROWS * n;
+        for (size_t group = groups * chunk / chunks; group < groups * (chunk + 1) / chunks; group++)
         {
-            if (this->adjancencyMatrix[i][j] != 0)
+            size_t i = group * MULTIPLY_ROWS;
+            size_t rows = min(MULTIPLY_ROWS, n - i);
+            const W *a[MULTIPLY_ROWS];
+            W *c[MULTIPLY_ROWS];
+            for (size_t r = 0; r < rows; r++)
+            {
+                a[r] = g1.denseRow(i + r, chunkScratch + r * n);
+                c[r] = inPlace ? chunkAside + r * n : g.row(i + r);
+            }
+            if (inPlace)
+            {
+                fill(chunkAside, chunkAside + rows * n, 0);
+            }
+            for (size_t jb = 0; jb < n; jb += MULTIPLY_J_BLOCK)
+            {
+                size_t jEnd = min(jb + MULTIPLY_J_BLOCK, n);
+                for (size_t kb = 0; kb < n; kb += MULTIPLY_K_BLOCK)
+                {
+                    size_t kEnd = min(kb + MULTIPLY_K_BLOCK, n);
+                    if (rows == MULTIPLY_ROWS)
+                    {
+                        BasicGraph<W>::multiplyRows(a, c, b, kb, kEnd, jb, jEnd);
+                    }
+                    else
+                    {
+                        for (size_t r = 0; r < rows; r++)
+                        {
+                            BasicGraph<W>::multiplyRow(a[r], c[r], b, kb, kEnd, jb, jEnd);
+                        }
+                    }
+                }
+            }
+            for (size_t r = 0; r < rows; r++)
             {
-                this->adjancencyMatrix[i][j] = -this->adjancencyMatrix[i][j];
+                summaries[chunk].addRow(c[r], n);
+                if (inPlace)
+                {
+                    copy(c[r], c[r] + n, g.row(i + r));
+                }
             }
         }
+    });
+
+    CellSummary summary;
+    for (const CellSummary &chunkSummary : summaries)
+    {
+        summary.add(chunkSummary);
     }
-    return *this;
+    g.dropResults();
+    g.directed = false;
+    g.updateMetadata(summary, recheckDirected);
 }
 
-Graph Graph::operator--()
+template <typename W>
+BasicGraph<W> BasicGraph<W>::multiplySparse(const BasicGraph &g1, const BasicGraph &g2, size_t threads)
 {
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
-
-    // Iterate over the matrix and decrement the values.
-    for (size_t i = 0; i < n; i++)
+    size_t n = g1.vertices;
+    size_t chunks = min(n, MULTIPLY_CHUNKS * (threads == 0 ? ariel::ThreadPool::getThreadCount() : threads));
+    vector<vector<size_t>> chunkColumns(chunks);
+    vector<vector<W>> chunkWeights(chunks);
+    // Number of non zero cells of every row of the product.
+    vector<size_t> rowCells(n);
+    vector<CellSummary> summaries(chunks);
+
+    // Gustavson: row i of the product is the sum of the rows k of g2 scaled by g1[i][k], over the stored cells only.
+    // The sums are gathered in a dense accumulator row, and the columns it touched are kept to read them back in order.
+    ariel::ThreadPool::instance().parallelFor(chunks, threads, [&](size_t chunk)
     {
-        for (size_t j = 0; j < m; j++)
+        size_t iBegin = n * chunk / chunks;
+        size_t iEnd = n * (chunk + 1) / chunks;
+        vector<W> accumulator(n, 0);
+        vector<char> touched(n, 0);
+        vector<size_t> touchedColumns;
+        vector<size_t> &columns = chunkColumns[chunk];
+        vector<W> &weights = chunkWeights[chunk];
+
+        for (size_t i = iBegin; i < iEnd; i++)
         {
-            if (this->adjancencyMatrix[i][j] != 0 && this->adjancencyMatrix[i][j] != 1)
+            for (size_t p = g1.rowOffsets[i]; p < g1.rowOffsets[i + 1]; p++)
             {
-                this->adjancencyMatrix[i][j]--;
+                size_t k = g1.columnIndices[p];
+                W aik = g1.weights[p];
+                for (size_t q = g2.rowOffsets[k]; q < g2.rowOffsets[k + 1]; q++)
+                {
+                    size_t j = g2.columnIndices[q];
+                    if (!touched[j])
+                    {
+                        touched[j] = 1;
+                        touchedColumns.push_back(j);
+                    }
+                    accumulator[j] += aik * g2.weights[q];
+                }
             }
 
-            else if (this->adjancencyMatrix[i][j] == 1)
+            // Cells whose products cancel out are not edges.
+            sort(touchedColumns.begin(), touchedColumns.end());
+            size_t before = columns.size();
+            for (size_t j : touchedColumns)
             {
-                this->adjancencyMatrix[i][j] = -1;
+                if (accumulator[j] != 0)
+                {
+                    columns.push_back(j);
+                    weights.push_back(accumulator[j]);
+                }
+                accumulator[j] = 0;
+                touched[j] = 0;
             }
+            touchedColumns.clear();
+            rowCells[i] = columns.size() - before;
         }
+        summaries[chunk].addRow(weights.data(), weights.size());
+    });
+
+    CellSummary summary;
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+        summary.add(summaries[chunk]);
     }
-    this->edges = this->countEdges();
-    return *this;
+    size_t total = summary.nonZeros;
+    BasicGraph<W> g;
+    g.resizeSparse(n, total);
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        g.rowOffsets[i] = k;
+        k += rowCells[i];
+    }
+    g.rowOffsets[n] = k;
+    // The chunks hold consecutive rows, in order.
+    k = 0;
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+        copy(chunkColumns[chunk].begin(), chunkColumns[chunk].end(), g.columnIndices.data() + k);
+        copy(chunkWeights[chunk].begin(), chunkWeights[chunk].end(), g.weights.data() + k);
+        k += chunkColumns[chunk].size();
+    }
+
+    // The square of a symmetric matrix is symmetric, any other product has to be checked.
+    g.updateMetadata(summary, &g1 != &g2 || g1.directed);
+    return g;
 }
 
-Graph Graph::operator--(int)
+template <typename W>
+BasicGraph<W> BasicGraph<W>::multiplyBits(const BasicGraph &g1, const BasicGraph &g2, size_t threads)
 {
-    Graph g = *this;
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
-
-    // Iterate over the matrix and decrement the values.
-    for (size_t i = 0; i < n; i++)
+    size_t n = g1.vertices;
+    size_t words = (n + WORD_BITS - 1) / WORD_BITS;
+    size_t chunks = min(n, MULTIPLY_CHUNKS * (threads == 0 ? ariel::ThreadPool::getThreadCount() : threads));
+    vector<CellSummary> summaries(chunks);
+    // Column j of g2 is row j of its transpose, so every cell of the product reads two rows of words.
+    BasicGraph<W> columns = g2.transposed();
+    BasicGraph<W> g;
+    g.resize(n);
+
+    // The columns are taken MULTIPLY_BITS_BLOCK at a time, and every row of the chunk is multiplied by the block while it is in the cache.
+    ariel::ThreadPool::instance().parallelFor(chunks, threads, [&](size_t chunk)
     {
-        for (size_t j = 0; j < m; j++)
+        size_t iBegin = n * chunk / chunks;
+        size_t iEnd = n * (chunk + 1) / chunks;
+        for (size_t jb = 0; jb < n; jb += MULTIPLY_BITS_BLOCK)
         {
-            if (this->adjancencyMatrix[i][j] != 0 && this->adjancencyMatrix[i][j] != 1)
-            {
-                this->adjancencyMatrix[i][j]--;
-            }
-
-            else if (this->adjancencyMatrix[i][j] == 1)
+            size_t jEnd = min(jb + MULTIPLY_BITS_BLOCK, n);
+            for (size_t i = iBegin; i < iEnd; i++)
             {
-                this->adjancencyMatrix[i][j] = -1;
+                const uint64_t *a = g1.bitRow(i);
+                W *c = g.row(i);
+                for (size_t j = jb; j < jEnd; j++)
+                {
+                    const uint64_t *b = columns.bitRow(j);
+                    int count = 0;
+                    for (size_t w = 0; w < words; w++)
+                    {
+                        count += __builtin_popcountll(a[w] & b[w]);
+                    }
+                    c[j] = static_cast<W>(count);
+                }
             }
         }
+        for (size_t i = iBegin; i < iEnd; i++)
+        {
+            summaries[chunk].addRow(g.row(i), n);
+        }
+    });
+
+    CellSummary summary;
+    for (const CellSummary &chunkSummary : summaries)
+    {
+        summary.add(chunkSummary);
     }
-    this->edges = this->countEdges();
+    // The square of a symmetric matrix is symmetric, any other product has to be checked.
+    g.updateMetadata(summary, &g1 != &g2 || g1.directed);
     return g;
 }
 
-Graph ariel::operator*(const Graph &g1, const Graph &g2)
+template <typename W>
+void BasicGraph<W>::multiplyRows(const W *const *a, W *const *c, const BasicGraph *b, size_t kBegin, size_t kEnd, size_t jBegin, size_t jEnd)
 {
-    size_t n1 = g1.adjancencyMatrix.size();
-    size_t m1 = g1.adjancencyMatrix[0].size();
-    size_t n2 = g2.adjancencyMatrix.size();
-    size_t m2 = g2.adjancencyMatrix[0].size();
-
-    if ((n1 != m2) || (m1 != n2))
+    W *c0 = c[0], *c1 = c[1], *c2 = c[2], *c3 = c[3];
+    for (size_t k = kBegin; k < kEnd; k++)
     {
-        throw invalid_argument("The number of columns in the first matrix must be equal to the number of rows in the second matrix");
+        W a0 = a[0][k], a1 = a[1][k], a2 = a[2][k], a3 = a[3][k];
+        // Most 0/1 graphs have many zero cells, skip the rows of g2 no product row needs.
+        if (a0 == 0 && a1 == 0 && a2 == 0 && a3 == 0)
+        {
+            continue;
+        }
+        // Every cell of row k of g2 is loaded once and added to the four product rows, the loop vectorizes.
+        const W *bk = b->row(k);
+        for (size_t j = jBegin; j < jEnd; j++)
+        {
+            W bkj = bk[j];
+            c0[j] += a0 * bkj;
+            c1[j] += a1 * bkj;
+            c2[j] += a2 * bkj;
+            c3[j] += a3 * bkj;
+        }
     }
+}
 
-    vector<vector<int>> diff(n1, vector<int>(m2, 0));
-
-    for (size_t i = 0; i < n1; i++)
+template <typename W>
+void BasicGraph<W>::multiplyRow(const W *a, W *c, const BasicGraph *b, size_t kBegin, size_t kEnd, size_t jBegin, size_t jEnd)
+{
+    for (size_t k = kBegin; k < kEnd; k++)
     {
-        for (size_t j = 0; j < m2; j++)
+        W aik = a[k];
+        if (aik == 0)
         {
-            for (size_t k = 0; k < m1; k++)
-            {
-                diff[i][j] += g1.adjancencyMatrix[i][k] * g2.adjancencyMatrix[k][j];
-            }
+            continue;
+        }
+        const W *bk = b->row(k);
+        for (size_t j = jBegin; j < jEnd; j++)
+        {
+            c[j] += aik * bk[j];
         }
     }
-
-    Graph g;
-    g.loadGraph(diff);
-    return g;
-
 }
 
-Graph Graph::operator*=(int scalar)
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator*=(W scalar)
 {
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
+    this->dropResults();
+    size_t n = this->vertices;
+    this->convertTo(this->storage == Storage::Bitset ? Storage::Dense : this->storage);
 
-    for (size_t i = 0; i < n; i++)
+    CellSummary summary;
+    if (this->storage == Storage::Sparse)
+    {
+        for (size_t k = 0; k < this->nonZeros; k++)
+        {
+            this->weights[k] *= scalar;
+        }
+        this->removeZeroCells();
+        summary.addRow(this->weights.data(), this->rowOffsets[n]);
+    }
+    else if (this->storage == Storage::Symmetric)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            W *a = this->upperRow(i);
+            for (size_t j = 0; j < n - i; j++)
+            {
+                a[j] *= scalar;
+            }
+            summary.addUpperRow(a, n - i);
+        }
+    }
+    else
     {
-        for (size_t j = 0; j < m; j++)
+        for (size_t i = 0; i < n; i++)
         {
-            this->adjancencyMatrix[i][j] *= scalar;
+            W *a = this->row(i);
+            for (size_t j = 0; j < n; j++)
+            {
+                a[j] *= scalar;
+            }
+            summary.addRow(a, n);
         }
     }
-    this->edges = this->countEdges();
+    // Scaling keeps a symmetric matrix symmetric, otherwise check again.
+    this->updateMetadata(summary, this->directed);
     return *this;
 }
 
-Graph Graph::operator/=(int scalar)
+template <typename W>
+BasicGraph<W> &BasicGraph<W>::operator/=(W scalar)
 {
     if (scalar == 0)
     {
         throw invalid_argument("Cannot divide by 0.");
     }
-    size_t n = this->adjancencyMatrix.size();
-    size_t m = this->adjancencyMatrix[0].size();
+    this->dropResults();
+    size_t n = this->vertices;
+    this->convertTo(this->storage == Storage::Bitset ? Storage::Dense : this->storage);
 
-    for (size_t i = 0; i < n; i++)
+    CellSummary summary;
+    if (this->storage == Storage::Sparse)
+    {
+        for (size_t k = 0; k < this->nonZeros; k++)
+        {
+            this->weights[k] /= scalar;
+        }
+        this->removeZeroCells();
+        summary.addRow(this->weights.data(), this->rowOffsets[n]);
+    }
+    else if (this->storage == Storage::Symmetric)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            W *a = this->upperRow(i);
+            for (size_t j = 0; j < n - i; j++)
+            {
+                a[j] /= scalar;
+            }
+            summary.addUpperRow(a, n - i);
+        }
+    }
+    else
     {
-        for (size_t j = 0; j < m; j++)
+        for (size_t i = 0; i < n; i++)
         {
-            this->adjancencyMatrix[i][j] /= scalar;
+            W *a = this->row(i);
+            for (size_t j = 0; j < n; j++)
+            {
+                a[j] /= scalar;
+            }
+            summary.addRow(a, n);
         }
     }
-    this->edges = this->countEdges();
+    // Dividing keeps a symmetric matrix symmetric, otherwise check again.
+    this->updateMetadata(summary, this->directed);
     return *this;
 }
 
-bool ariel::operator==(const Graph &g1, const Graph &g2)
+/*
+* @brief
+* This function compares two arrays of weights. Integer weights are compared as bytes,
+* floating point weights by value, 0.0 and -0.0 are both a missing edge.
+* @param a - first array.
+* @param b - second array.
+* @param count - number of weights in each array.
+* @return bool - true if the weights are equal.
+*/
+template <typename W>
+static bool equalCells(const W *a, const W *b, size_t count)
 {
-    size_t n1 = g1.adjancencyMatrix.size();
-    size_t m1 = g1.adjancencyMatrix[0].size();
-    size_t n2 = g2.adjancencyMatrix.size();
-    size_t m2 = g2.adjancencyMatrix[0].size();
-    bool flag = false;
-    if (n1 != n2 || m1 != m2)
+    if (is_floating_point<W>::value)
+    {
+        return equal(a, a + count, b);
+    }
+    return memcmp(a, b, count * sizeof(W)) == 0;
+}
+
+template <typename W>
+bool ariel::operator==(const BasicGraph<W> &g1, const BasicGraph<W> &g2)
+{
+    size_t n = g1.vertices;
+    if (n != g2.vertices || g1.nonZeros != g2.nonZeros)
+    {
+        return false;
+    }
+
+    // Two sparse graphs are equal when their stored cells are.
+    if (g1.storage == BasicGraph<W>::Storage::Sparse && g2.storage == BasicGraph<W>::Storage::Sparse)
+    {
+        return memcmp(g1.rowOffsets.data(), g2.rowOffsets.data(), (n + 1) * sizeof(size_t)) == 0 &&
+               (g1.nonZeros == 0 ||
+                (memcmp(g1.columnIndices.data(), g2.columnIndices.data(), g1.nonZeros * sizeof(size_t)) == 0 &&
+                 equalCells(g1.weights.data(), g2.weights.data(), g1.nonZeros)));
+    }
+
+    // Two bitset graphs of the same size have the same stride, and 0 in the bits past the last vertex.
+    if (g1.storage == BasicGraph<W>::Storage::Bitset && g2.storage == BasicGraph<W>::Storage::Bitset)
+    {
+        return memcmp(g1.bits.data(), g2.bits.data(), n * g1.stride * sizeof(uint64_t)) == 0;
+    }
+
+    // Two undirected graphs are equal when their upper triangles are.
+    if (g1.storage == BasicGraph<W>::Storage::Symmetric && g2.storage == BasicGraph<W>::Storage::Symmetric)
     {
-        return flag;
+        return equalCells(g1.adjancencyMatrix.data(), g2.adjancencyMatrix.data(), n * (n + 1) / 2);
     }
 
-    for (size_t i = 0; i < n1; i++)
+    // Compare whole rows at once.
+    vector<W> scratch1(n), scratch2(n);
+    for (size_t i = 0; i < n; i++)
     {
-        for (size_t j = 0; j < m1; j++)
+        if (!equalCells(g1.denseRow(i, scratch1.data()), g2.denseRow(i, scratch2.data()), n))
         {
-            if (g1.adjancencyMatrix[i][j] != g2.adjancencyMatrix[i][j])
-            {
-                return flag;
-            }
+            return false;
         }
     }
-    flag = true;
-    return flag;
+    return true;
 }
 
-bool ariel::operator!=(const Graph &g1, const Graph &g2)
+template <typename W>
+bool ariel::operator!=(const BasicGraph<W> &g1, const BasicGraph<W> &g2)
 {
     return !((g1 == g2) && !(g1 < g2) && !(g2 < g1));
 }
 
-bool ariel::operator<(const Graph &g1, const Graph &g2)
+template <typename W>
+bool ariel::operator<(const BasicGraph<W> &g1, const BasicGraph<W> &g2)
 {
-    size_t n1 = g1.adjancencyMatrix.size();
-    size_t m1 = g1.adjancencyMatrix[0].size();
-    size_t n2 = g2.adjancencyMatrix.size();
-    size_t m2 = g2.adjancencyMatrix[0].size();
+    size_t n1 = g1.vertices;
+    size_t n2 = g2.vertices;
     size_t edges1 = g1.edges;
     size_t edges2 = g2.edges;
     bool flag = false;
@@ -572,22 +2320,22 @@ bool ariel::operator<(const Graph &g1, const Graph &g2)
 
     else if (edges1 == edges2)
     {
-        flag = (n1 < n2) || (m1 < m2);
+        flag = n1 < n2;
     }
     return flag;
 }
 
-bool ariel::operator<=(const Graph &g1, const Graph &g2)
+template <typename W>
+bool ariel::operator<=(const BasicGraph<W> &g1, const BasicGraph<W> &g2)
 {
     return (g1 < g2) || (g1 == g2);
 }
 
-bool ariel::operator>(const Graph &g1, const Graph &g2)
+template <typename W>
+bool ariel::operator>(const BasicGraph<W> &g1, const BasicGraph<W> &g2)
 {
-    size_t n1 = g1.adjancencyMatrix.size();
-    size_t m1 = g1.adjancencyMatrix[0].size();
-    size_t n2 = g2.adjancencyMatrix.size();
-    size_t m2 = g2.adjancencyMatrix[0].size();
+    size_t n1 = g1.vertices;
+    size_t n2 = g2.vertices;
     size_t edges1 = g1.edges;
     size_t edges2 = g2.edges;
     bool flag = false;
@@ -602,15 +2350,28 @@ bool ariel::operator>(const Graph &g1, const Graph &g2)
 
     else if (edges1 == edges2)
     {
-        flag = (n1 > n2) || (m1 > m2);
+        flag = n1 > n2;
     }
     return flag;
 }
 
-bool ariel::operator>=(const Graph &g1, const Graph &g2)
+template <typename W>
+bool ariel::operator>=(const BasicGraph<W> &g1, const BasicGraph<W> &g2)
 {
     return (g1 > g2) || (g1 == g2);
 }
 
-
-
+// The graphs of every weight type, and the operators on them.
+#define ARIEL_INSTANTIATE_GRAPH(W)                                                                       \
+    template class ariel::BasicGraph<W>;                                                                 \
+    template ostream &ariel::operator<<(ostream &os, const BasicGraph<W> &g);                            \
+    template BasicGraph<W> ariel::operator*(const BasicGraph<W> &g1, const BasicGraph<W> &g2);           \
+    template BasicGraph<W> ariel::operator*(BasicGraph<W> &&g1, const BasicGraph<W> &g2);                \
+    template BasicGraph<W> ariel::multiply(const BasicGraph<W> &g1, const BasicGraph<W> &g2, size_t threads); \
+    template bool ariel::operator==(const BasicGraph<W> &g1, const BasicGraph<W> &g2);                   \
+    template bool ariel::operator!=(const BasicGraph<W> &g1, const BasicGraph<W> &g2);                   \
+    template bool ariel::operator<(const BasicGraph<W> &g1, const BasicGraph<W> &g2);                    \
+    template bool ariel::operator<=(const BasicGraph<W> &g1, const BasicGraph<W> &g2);                   \
+    template bool ariel::operator>(const BasicGraph<W> &g1, const BasicGraph<W> &g2);                    \
+    template bool ariel::operator>=(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_GRAPH)
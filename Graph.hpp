@@ -7,23 +7,749 @@
 #include <vector>
 #include <iostream>
 #include <set>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include <functional>
+#include "AlignedBuffer.hpp"
 using namespace std;
+
+// Expands INSTANTIATE(W) for every weight type graphs are compiled for.
+// The templates are defined in the source files, which instantiate them with it.
+#define ARIEL_FOR_EACH_WEIGHT(INSTANTIATE) \
+    INSTANTIATE(int8_t)                     \
+    INSTANTIATE(int16_t)                    \
+    INSTANTIATE(int32_t)                    \
+    INSTANTIATE(int64_t)                    \
+    INSTANTIATE(float)                      \
+    INSTANTIATE(double)
+
 namespace ariel
 {
+    template <typename W>
+    class BasicAllPairsPaths;
+    class ReachabilityIndex;
+    class DisjointSet;
+    template <typename E>
+    class GraphExpression;
+    template <typename W>
+    class GraphTerminal;
+
+    /*
+    * @brief
+    * The distance of a pair of vertices with no path between them, for Floyd-Warshall distances of type D.
+    */
+    template <typename D>
+    struct DistanceTraits
+    {
+        /*
+        * @brief
+        * This function returns the distance of a pair of vertices with no path between them.
+        * For integers it is half the largest distance, so adding two distances never overflows.
+        * @return D - infinity for floating point distances, half the largest value otherwise.
+        */
+        static D infinity()
+        {
+            return numeric_limits<D>::has_infinity ? numeric_limits<D>::infinity() : numeric_limits<D>::max() / 2;
+        }
+    };
+
+    /*
+    * @brief
+    * The types the algorithms compute with for graphs of weight type W.
+    * PathLength - the length of a path found by a single source search, wide enough for the sum of its weights.
+    * Distance - the cells of the Floyd-Warshall distance matrix. 8 and 16 bit weights are widened to int,
+    * a path of a few edges would overflow them, and 32 bit weights to int64_t, so every weight is below infinity().
+    * 64 bit and floating point weights are kept as they are.
+    */
+    template <typename W>
+    struct WeightTraits
+    {
+        typedef typename conditional<is_floating_point<W>::value, double, long long>::type PathLength;
+        typedef typename conditional<is_floating_point<W>::value, W,
+                                     typename conditional<(sizeof(W) < sizeof(int)), int, int64_t>::type>::type Distance;
+
+        /*
+        * @brief
+        * This function returns the distance of a pair of vertices with no path between them, DistanceTraits<Distance>::infinity().
+        * @return Distance - infinity for floating point weights, half the largest distance otherwise.
+        */
+        static Distance infinity()
+        {
+            return DistanceTraits<Distance>::infinity();
+        }
+    };
+
+    /*
+    * @brief
+    * The part of a graph that does not depend on the type of its weights: the ways the matrix can be stored,
+    * and the settings that choose between them, shared by the graphs of every weight type.
+    */
+    class GraphBase
+    {
+    public:
+        /*
+        * @brief
+        * The ways the adjacency matrix can be kept in memory.
+        * Dense - the full N x N matrix.
+        * Sparse - compressed sparse rows, only the non zero cells of every row.
+        * Bitset - one bit per cell, 64 vertices to a word, for graphs whose edges all weigh 1.
+        * Symmetric - the upper triangle of the matrix, diagonal included, row after row, for undirected graphs.
+        */
+        enum class Storage
+        {
+            Dense,
+            Sparse,
+            Bitset,
+            Symmetric
+        };
+
+        /*
+        * @brief
+        * This function sets the density (fraction of non zero cells) below which graphs are kept in sparse storage.
+        * It applies to graphs loaded or computed from now on.
+        * @param density - the new threshold, 0 never uses sparse storage.
+        * @return void
+        */
+        static void setSparseThreshold(double density);
+
+        /*
+        * @brief
+        * This function returns the density below which graphs are kept in sparse storage.
+        * @return double - the sparse threshold.
+        */
+        static double getSparseThreshold();
+
+        /*
+        * @brief
+        * This function sets whether graphs whose edges all weigh 1 are kept in bitset storage, 32 times smaller than dense storage.
+        * Like the sparse threshold, it applies to graphs loaded or computed from now on, and sparse storage comes first.
+        * @param enabled - true to use bitset storage, false to keep such graphs dense.
+        * @return void
+        */
+        static void setBitsetStorage(bool enabled);
+
+        /*
+        * @brief
+        * This function returns whether graphs whose edges all weigh 1 are kept in bitset storage.
+        * @return bool - true if bitset storage is used.
+        */
+        static bool getBitsetStorage();
+
+        /*
+        * @brief
+        * This function sets whether undirected graphs are kept in symmetric storage, the upper triangle of the matrix only.
+        * It takes half the memory of dense storage, and the operators that keep a graph undirected (+, -, scaling, ++, --)
+        * compute only the upper triangle. Like the sparse threshold, it applies to graphs loaded or computed from now on,
+        * and sparse and bitset storage come first.
+        * @param enabled - true to use symmetric storage, false to keep undirected graphs dense.
+        * @return void
+        */
+        static void setSymmetricStorage(bool enabled);
+
+        /*
+        * @brief
+        * This function returns whether undirected graphs are kept in symmetric storage.
+        * @return bool - true if symmetric storage is used.
+        */
+        static bool getSymmetricStorage();
 
-    class Graph
+    protected:
+        // Graphs with a smaller fraction of non zero cells are kept in sparse storage.
+        static double sparseThreshold;
+        // Whether graphs whose edges all weigh 1 are kept in bitset storage.
+        static bool bitsetStorage;
+        // Whether undirected graphs are kept in symmetric storage.
+        static bool symmetricStorage;
+    };
+
+    /*
+    * @brief
+    * A graph whose edge weights are of type W, kept as its adjacency matrix.
+    * It is compiled for int8_t, int16_t, int32_t, int64_t, float and double weights, Graph is the graph of int weights.
+    * Narrow weights take less memory and the operators process more of them per vector instruction,
+    * but the cells of the results are W too, so a sum or product that does not fit in W wraps around.
+    */
+    template <typename W>
+    class BasicGraph : public GraphBase
     {
+    public:
+        /*
+        * @brief
+        * An edge leaving a vertex: the vertex it enters and its weight.
+        */
+        struct Neighbour
+        {
+            size_t vertex;
+            W weight;
+        };
+
+        /*
+        * @brief
+        * An edge of an edge list: the vertex it leaves, the vertex it enters and its weight.
+        */
+        struct Edge
+        {
+            size_t from;
+            size_t to;
+            W weight;
+        };
+
+        /*
+        * @brief
+        * Iterates over the non zero cells of one row of the adjacency matrix, in increasing column order.
+        * Over a dense row it skips the zero cells, over a sparse row it only visits the stored cells,
+        * over a bitset row it jumps from one set bit to the next, a word at a time.
+        * Over a row in symmetric storage it reads the column of the vertex up to the diagonal, then the rest of its row.
+        */
+        class NeighbourIterator
+        {
+        private:
+            // The dense row, or nullptr when iterating over a sparse, bitset or symmetric row.
+            const W *denseRow;
+            // The words of a bitset row, or nullptr.
+            const uint64_t *bits;
+            // The columns and weights of the stored cells of a sparse row.
+            const size_t *columns;
+            const W *weights;
+            size_t position;
+            size_t end;
+            // Symmetric storage: the cell at the position, or nullptr, and the row being iterated over.
+            const W *packed;
+            size_t diagonal;
+
+            void advancePacked()
+            {
+                // Above the diagonal the cell below is in the next row of the triangle, which starts
+                // end - position - 1 cells further, past the diagonal the cells of the row are next to each other.
+                this->packed += this->position < this->diagonal ? this->end - this->position - 1 : 1;
+                this->position++;
+            }
+
+            void skipZeros()
+            {
+                if (this->denseRow != nullptr)
+                {
+                    while (this->position < this->end && this->denseRow[this->position] == 0)
+                    {
+                        this->position++;
+                    }
+                }
+                else if (this->packed != nullptr)
+                {
+                    while (this->position < this->end && *this->packed == 0)
+                    {
+                        this->advancePacked();
+                    }
+                }
+                else if (this->bits != nullptr)
+                {
+                    while (this->position < this->end)
+                    {
+                        uint64_t word = this->bits[this->position / 64] >> (this->position % 64);
+                        if (word != 0)
+                        {
+                            this->position += static_cast<size_t>(__builtin_ctzll(word));
+                            return;
+                        }
+                        // No bit left in this word, go on from the first bit of the next one.
+                        this->position = (this->position / 64 + 1) * 64;
+                    }
+                    this->position = this->end;
+                }
+            }
+
+        public:
+            NeighbourIterator(const W *denseRow, const uint64_t *bits, const size_t *columns, const W *weights, size_t position, size_t end,
+                              const W *packed = nullptr, size_t diagonal = 0)
+                : denseRow(denseRow), bits(bits), columns(columns), weights(weights), position(position), end(end), packed(packed), diagonal(diagonal)
+            {
+                this->skipZeros();
+            }
+
+            Neighbour operator*() const
+            {
+                if (this->denseRow != nullptr)
+                {
+                    return Neighbour{this->position, this->denseRow[this->position]};
+                }
+                if (this->packed != nullptr)
+                {
+                    return Neighbour{this->position, *this->packed};
+                }
+                if (this->bits != nullptr)
+                {
+                    return Neighbour{this->position, W(1)};
+                }
+                return Neighbour{this->columns[this->position], this->weights[this->position]};
+            }
+
+            NeighbourIterator &operator++()
+            {
+                if (this->packed != nullptr)
+                {
+                    this->advancePacked();
+                }
+                else
+                {
+                    this->position++;
+                }
+                this->skipZeros();
+                return *this;
+            }
+
+            bool operator==(const NeighbourIterator &other) const { return this->position == other.position; }
+            bool operator!=(const NeighbourIterator &other) const { return this->position != other.position; }
+        };
+
+        /*
+        * @brief
+        * The neighbours of one vertex, for use in a range based for loop.
+        */
+        class NeighbourRange
+        {
+        private:
+            NeighbourIterator first;
+            NeighbourIterator last;
+
+        public:
+            NeighbourRange(const NeighbourIterator &first, const NeighbourIterator &last) : first(first), last(last) {}
+            NeighbourIterator begin() const { return this->first; }
+            NeighbourIterator end() const { return this->last; }
+        };
+
+        class RowView;
+
+
     private:
-        vector<vector<int>> adjancencyMatrix;
+        // Dense storage: the adjacency matrix is stored row after row in one contiguous buffer.
+        // Every row is padded to a whole number of cache lines, so row i starts at adjancencyMatrix[i * stride].
+        AlignedBuffer<W> adjancencyMatrix;
+        size_t stride;
+        // Sparse storage: the non zero cells of row i are the entries rowOffsets[i] .. rowOffsets[i + 1] - 1
+        // of columnIndices (their columns, in increasing order) and of weights (their values).
+        AlignedBuffer<size_t> rowOffsets;
+        AlignedBuffer<size_t> columnIndices;
+        AlignedBuffer<W> weights;
+        // Bitset storage: bit j % 64 of word j / 64 of row i is set when there is an edge from i to j,
+        // row i starts at bits[i * stride], and the bits past the last vertex are 0.
+        AlignedBuffer<uint64_t> bits;
+        // Symmetric storage uses adjancencyMatrix too, with the n - i cells (i, i) .. (i, n - 1) of every row i
+        // one after the other, n * (n + 1) / 2 cells in all. Cell (i, j) below the diagonal is read as cell (j, i).
+        Storage storage;
         size_t vertices;
         size_t edges;
+        // Number of non zero cells in the adjacency matrix.
+        size_t nonZeros;
         bool directed;
+        // The smallest and largest edge weights, both 0 when there are no edges.
+        W lightest;
+        W heaviest;
+
+        // The all-pairs shortest paths, the reachability index and the connected components of the graph,
+        // computed on the first request. Every function that changes the matrix drops them, a caller holding one keeps the old result.
+        // operator+= adds its edges to the connected components instead, copying them first if they are shared.
+        // The const functions read and fill them under lock, so several threads may query and copy one graph at once.
+        struct Results
+        {
+            mutable mutex lock;
+            shared_ptr<const BasicAllPairsPaths<W>> allPairsPaths;
+            shared_ptr<const ReachabilityIndex> reachability;
+            shared_ptr<DisjointSet> connectivity;
+
+            Results()
+            {
+
+            }
+
+            // A copy takes the results of other, not its lock.
+            Results(const Results &other)
+            {
+                *this = other;
+            }
+
+            Results &operator=(const Results &other)
+            {
+                if (this != &other)
+                {
+                    lock_guard<mutex> guard(other.lock);
+                    this->allPairsPaths = other.allPairsPaths;
+                    this->reachability = other.reachability;
+                    this->connectivity = other.connectivity;
+                }
+                return *this;
+            }
+        };
+        mutable Results results;
+
+        // The number of non zero cells of a new matrix and the lightest and heaviest of them,
+        // gathered by the functions that write the cells, one row at a time while the row is still in the cache.
+        struct CellSummary
+        {
+            size_t nonZeros = 0;
+            W lightest = numeric_limits<W>::max();
+            W heaviest = numeric_limits<W>::lowest();
+
+            // An unsigned integer as wide as a cell, so counting the cells takes as many of them to a vector register as they take.
+            typedef typename conditional<sizeof(W) == 1, uint8_t,
+                                         typename conditional<sizeof(W) == 2, uint16_t,
+                                                              typename conditional<sizeof(W) == 4, uint32_t, uint64_t>::type>::type>::type
+                Counter;
+
+            // The cell, or fill if the cell is 0. Integer cells are selected with a mask,
+            // GCC does not vectorize a min or max reduction over the select of ?:.
+            template <typename T>
+            static T nonZeroOr(T w, T fill, true_type)
+            {
+                return static_cast<T>(w | (static_cast<T>(-(w == 0)) & fill));
+            }
+
+            template <typename T>
+            static T nonZeroOr(T w, T fill, false_type)
+            {
+                return w == 0 ? fill : w;
+            }
+
+            void addRow(const W *row, size_t n)
+            {
+                // Local copies, so the loop vectorizes: the cells written could otherwise alias the fields.
+                size_t count = this->nonZeros;
+                W low = this->lightest, high = this->heaviest;
+                // The cells are counted in blocks of 255, that an 8 bit counter can count.
+                for (size_t jb = 0; jb < n; jb += 255)
+                {
+                    size_t end = min(jb + 255, n);
+                    Counter blockCount = 0;
+                    for (size_t j = jb; j < end; j++)
+                    {
+                        W w = row[j];
+                        blockCount = static_cast<Counter>(blockCount + (w != 0));
+                        low = min(low, nonZeroOr(w, numeric_limits<W>::max(), is_integral<W>()));
+                        high = max(high, nonZeroOr(w, numeric_limits<W>::lowest(), is_integral<W>()));
+                    }
+                    count += blockCount;
+                }
+                this->nonZeros = count;
+                this->lightest = low;
+                this->heaviest = high;
+            }
+
+            // Row i of symmetric storage: every cell but the one on the diagonal stands for two cells of the matrix.
+            void addUpperRow(const W *row, size_t length)
+            {
+                size_t before = this->nonZeros;
+                this->addRow(row, length);
+                this->nonZeros += this->nonZeros - before - (row[0] != 0);
+            }
+
+            void add(const CellSummary &other)
+            {
+                this->nonZeros += other.nonZeros;
+                this->lightest = min(this->lightest, other.lightest);
+                this->heaviest = max(this->heaviest, other.heaviest);
+            }
+        };
+
+        /*
+        * @brief
+        * This function drops the results computed from the matrix, called by every function that changes it.
+        * @return void
+        */
+        void dropResults();
+
+        /*
+        * @brief
+        * This function allocates a zeroed n x n adjacency matrix, dropping the old one.
+        * @param n - number of vertices.
+        * @return void
+        */
+        void resize(size_t n);
+
+        /*
+        * @brief
+        * This function allocates an n vertex graph in sparse storage, with room for the given number of non zero cells.
+        * The row offsets, columns and weights are left for the caller to fill.
+        * @param n - number of vertices.
+        * @param nonZeros - number of non zero cells.
+        * @return void
+        */
+        void resizeSparse(size_t n, size_t nonZeros);
+
+        /*
+        * @brief
+        * This function allocates an n vertex graph with no edges in bitset storage.
+        * @param n - number of vertices.
+        * @return void
+        */
+        void resizeBits(size_t n);
+
+        /*
+        * @brief
+        * This function allocates an n vertex graph with no edges in symmetric storage.
+        * @param n - number of vertices.
+        * @return void
+        */
+        void resizeSymmetric(size_t n);
+
+        /*
+        * @brief
+        * This function removes the cells that became 0 from the sparse storage.
+        * @return void
+        */
+        void removeZeroCells();
+
+        /*
+        * @brief
+        * These functions add 1 to (subtract 1 from) the weight of every edge, without adding or removing edges.
+        * @return void
+        */
+        void increment();
+        void decrement();
+
+        /*
+        * @brief
+        * This function returns a pointer to the first cell of a row of the adjacency matrix.
+        * @param i - row index.
+        * @return W* - pointer to the row.
+        */
+        W *row(size_t i);
+        const W *row(size_t i) const;
+
+        /*
+        * @brief
+        * This function returns a pointer to the first word of a row in bitset storage.
+        * @param i - row index.
+        * @return uint64_t* - pointer to the row.
+        */
+        uint64_t *bitRow(size_t i);
+        const uint64_t *bitRow(size_t i) const;
+
+        /*
+        * @brief
+        * This function returns a pointer to the cell on the diagonal of a row in symmetric storage,
+        * the cells of the row right of the diagonal follow it.
+        * @param i - row index.
+        * @return W* - pointer to cell (i, i).
+        */
+        W *upperRow(size_t i);
+        const W *upperRow(size_t i) const;
+
+        /*
+        * @brief
+        * This function returns a row of the adjacency matrix as a dense array, whatever the storage is.
+        * A dense row is returned in place, the other storages are expanded into the scratch array.
+        * @param i - row index.
+        * @param scratch - array of at least getVertices() cells, used for sparse rows.
+        * @return const W* - pointer to the dense row.
+        */
+        const W *denseRow(size_t i, W *scratch) const;
+
+        /*
+        * @brief
+        * This function renders the adjacency matrix in the text of operator<< into a large buffer,
+        * with integers turned into digits two at a time and floating point weights printed with %g,
+        * and hands the buffer to write whenever the next row may not fit in it, and once more at the end.
+        * @param precision - the significant digits of floating point weights, at most 17.
+        * @param write - called with the text and its length, in order.
+        * @return void
+        */
+        void formatRows(int precision, const function<void(const char *, size_t)> &write) const;
+
+        /*
+        * @brief
+        * This function returns the value of a single cell of the adjacency matrix, whatever the storage is.
+        * @param i - row index.
+        * @param j - column index.
+        * @return W - the weight of the edge from i to j, 0 if there is no edge.
+        */
+        W cell(size_t i, size_t j) const;
+
+        /*
+        * @brief
+        * This function counts the non zero cells of the adjacency matrix.
+        * @return size_t - number of non zero cells.
+        */
+        size_t countNonZeros() const;
+
+        /*
+        * @brief
+        * This function compares the adjacency matrix with its transpose, stopping at the first cell that differs.
+        * @return bool - true if the matrix is symmetric, false otherwise.
+        */
+        bool isSymmetric() const;
+
+        /*
+        * @brief
+        * This function converts the graph to the given storage, keeping the matrix unchanged.
+        * @param target - the storage to convert to.
+        * @return void
+        */
+        void convertTo(Storage target);
+
+        /*
+        * @brief
+        * This function moves the graph to sparse storage if its density is below the sparse threshold,
+        * to bitset storage if all its edges weigh 1, to symmetric storage if it is undirected, and to dense storage otherwise.
+        * @return void
+        */
+        void selectStorage();
+
+        /*
+        * @brief
+        * This function multiplies two graphs in sparse storage row by row, visiting only their stored cells.
+        * The product is built in sparse storage, then moved to dense storage if it is dense enough.
+        * @param g1 - first graph, in sparse storage.
+        * @param g2 - second graph, in sparse storage, with the same number of vertices.
+        * @param threads - the most threads the product may run on, 0 uses Algorithms::getThreadCount() threads.
+        * @return BasicGraph - the multiplication of the two graphs.
+        */
+        static BasicGraph multiplySparse(const BasicGraph &g1, const BasicGraph &g2, size_t threads);
+
+        /*
+        * @brief
+        * This function multiplies two graphs in bitset storage. Cell (i, j) of the product is the number of vertices k
+        * with edges i -> k and k -> j, the popcount of the and of row i of g1 and column j of g2, 64 vertices at a time.
+        * @param g1 - first graph, in bitset storage.
+        * @param g2 - second graph, in bitset storage, with the same number of vertices.
+        * @param threads - the most threads the product may run on, 0 uses Algorithms::getThreadCount() threads.
+        * @return BasicGraph - the multiplication of the two graphs.
+        */
+        static BasicGraph multiplyBits(const BasicGraph &g1, const BasicGraph &g2, size_t threads);
+
+        /*
+        * @brief
+        * This function computes the product of two graphs with the tiled dense kernel into g.
+        * @param g1 - first graph.
+        * @param g2 - second graph, with the same number of vertices.
+        * @param g - the product, either a zeroed dense graph of the same size, or g1 itself in dense storage.
+        * @param threads - the most threads the product may run on, 0 uses Algorithms::getThreadCount() threads.
+        * @return void
+        */
+        static void multiplyDense(const BasicGraph &g1, const BasicGraph &g2, BasicGraph &g, size_t threads);
+
+        /*
+        * @brief
+        * These functions add the product of rows of a and the block kBegin .. kEnd - 1 x jBegin .. jEnd - 1
+        * of the dense graph b to the matching rows of c.
+        * multiplyRows handles four rows of a and c at once, multiplyRow a single one.
+        * @param a - rows of the left operand, as dense arrays.
+        * @param c - rows of the product.
+        * @param b - the right operand, in dense storage.
+        * @param kBegin, kEnd - the rows of the block of b.
+        * @param jBegin, jEnd - the columns of the block of b.
+        * @return void
+        */
+        static void multiplyRows(const W *const *a, W *const *c, const BasicGraph *b, size_t kBegin, size_t kEnd, size_t jBegin, size_t jEnd);
+        static void multiplyRow(const W *a, W *c, const BasicGraph *b, size_t kBegin, size_t kEnd, size_t jBegin, size_t jEnd);
+
+        /*
+        * @brief
+        * This function loads the graph from a 2D vector, see loadGraph.
+        * @param graph - 2D vector representing the graph.
+        * @param owned - the same vector when the graph may release its rows once they are copied, nullptr otherwise.
+        * @return void
+        * @throw invalid_argument - if the vector is empty or not square.
+        */
+        void loadMatrix(const vector<vector<W>> &graph, vector<vector<W>> *owned);
+
+        /*
+        * @brief
+        * This function frees row i of a vector loaded by loadMatrix, if the vector is owned.
+        * @param owned - the vector, or nullptr.
+        * @param i - row index.
+        * @return void
+        */
+        static void releaseRow(vector<vector<W>> *owned, size_t i);
+
+        /*
+        * @brief
+        * This function loads the graph from lists of edges, see loadEdges. The cells of every row are counted over all the lists,
+        * then the lists are scattered one after the other straight into the sparse rows, so the rows hold their cells
+        * in the order they were given, and every row is sorted by column on its own.
+        * @param n - number of vertices.
+        * @param chunks - the lists of edges, in the order they were given.
+        * @param count - the number of lists.
+        * @param owned - the vector of the lists when the graph may release each of them once its cells are in the rows, nullptr otherwise.
+        * @param directed - false if every edge stands for both directions, true otherwise.
+        * @return void
+        * @throw invalid_argument - if there are no vertices or an edge has a vertex that is not in the graph.
+        */
+        void loadEdgeChunks(size_t n, const vector<Edge> *chunks, size_t count, vector<vector<Edge>> *owned, bool directed);
+
+        /*
+        * @brief
+        * This function sets the metadata after the matrix has changed, from the summary of the cells written,
+        * and selects the storage. The symmetry of the matrix is only checked again when asked to.
+        * @param summary - the non zero cells of the new matrix.
+        * @param recheckDirected - false if the matrix is known to be symmetric.
+        * @return void
+        */
+        void updateMetadata(const CellSummary &summary, bool recheckDirected);
+
+        /*
+        * @brief
+        * This function replaces the matrix with the cells of an expression, computed in one pass over its rows.
+        * The graph may be one of the operands only when it is dense and has the size of the result.
+        * @param expression - the expression, see GraphExpression.
+        * @return void
+        */
+        template <typename E>
+        void evaluate(const E &expression);
+
+        /*
+        * @brief
+        * This function writes the cells begin .. end - 1 of the row of an expression loaded last.
+        * The cells are computed into a block on the stack and copied from there: a store to a row of 8 bit weights
+        * may alias the row pointers of the operands, which would be read again for every cell and keep the loop from vectorizing.
+        * @param expression - the expression, see GraphExpression.
+        * @param out - the row of the result, cell j is out[j].
+        * @param begin, end - the cells to write.
+        * @return void
+        */
+        template <typename E>
+        static void writeCells(const E &expression, W *out, size_t begin, size_t end);
+
+        // The operand of an expression reads the rows of the graph.
+        friend class GraphTerminal<W>;
 
     public:
+        // The type of the edge weights.
+        typedef W Weight;
+
         // Constructor
-        Graph();
+        BasicGraph();
+
+        /*
+        * @brief
+        * This constructor computes the graph of an expression of +, -, unary - and scaling, such as g1 + g2 - g3.
+        * @param expression - the expression.
+        */
+        template <typename E>
+        BasicGraph(const GraphExpression<E> &expression);
+
+        /*
+        * @brief
+        * This function replaces the graph with the graph of an expression, in a single pass and a single allocation.
+        * The graph may itself be an operand of the expression, as in g1 = g1 + g2.
+        * @param expression - the expression.
+        * @return BasicGraph& - the graph.
+        */
+        template <typename E>
+        BasicGraph &operator=(const GraphExpression<E> &expression);
+
         // Destructor
-        ~Graph();
+        ~BasicGraph();
+
+        // Copying a graph copies its matrix, moving a graph hands its buffers to the new graph
+        // and leaves it an empty graph of 0 vertices, as a new graph is.
+        BasicGraph(const BasicGraph &other) = default;
+        BasicGraph(BasicGraph &&other) noexcept;
+        BasicGraph &operator=(const BasicGraph &other) = default;
+        BasicGraph &operator=(BasicGraph &&other) noexcept;
 
         /*
         * @brief
@@ -35,8 +761,98 @@ namespace ariel
         * @return void
         */
 
-        void loadGraph(vector<vector<int>> graph);
-        
+        void loadGraph(const vector<vector<W>> &graph);
+
+        /*
+        * @brief
+        * This function loads the graph from a 2D vector it takes over, like loadGraph(const vector<vector<W>> &).
+        * Every row of the vector is released as soon as it is copied, so the matrix is never held twice.
+        * @param graph - 2D vector representing the graph, left empty.
+        * @return void
+        */
+        void loadGraph(vector<vector<W>> &&graph);
+
+        /*
+        * @brief
+        * This function loads the graph from a list of edges, straight into the storage the graph picks,
+        * without building the adjacency matrix first: the edges are counted and scattered into sparse rows in O(V + E),
+        * and a row whose columns are not already in order is sorted on its own.
+        * An edge given twice keeps the weight given last, and an edge of weight 0 is no edge.
+        * @param n - number of vertices.
+        * @param edges - the edges, an undirected edge u - v is given once, as u -> v or v -> u.
+        * @param directed - false if every edge stands for both directions, true otherwise.
+        * @return void
+        * @throw invalid_argument - if there are no vertices or an edge has a vertex that is not in the graph.
+        */
+        void loadEdges(size_t n, const vector<Edge> &edges, bool directed);
+
+        /*
+        * @brief
+        * This function writes the graph to a binary file: a versioned header with the number of vertices and edges,
+        * the direction, the weight type and the storage, then the arrays of the storage as they are in memory,
+        * each starting on a cache line. loadBinary maps such a file back.
+        * @param path - the file to write, replaced if it exists.
+        * @return void
+        * @throw invalid_argument - if the file cannot be created.
+        * @throw runtime_error - if writing the file fails.
+        */
+        void saveBinary(const string &path) const;
+
+        /*
+        * @brief
+        * This function loads a graph written by saveBinary, in the storage it was written in.
+        * The file is mapped into memory and the graph uses its arrays in place, without copying or parsing them.
+        * The mapping is private: a change to the graph copies the pages it writes and never changes the file.
+        * The graph keeps the mapping until its storage is replaced, and so does a copy.
+        * The sizes of the arrays and the columns of sparse rows are checked. The number of edges, the lightest and heaviest
+        * weights and the direction are found again in one pass over the arrays, those in the header are not trusted.
+        * @param path - the file to load.
+        * @return void
+        * @throw invalid_argument - if the file cannot be opened, is not a graph file of this version,
+        * holds weights of another type, its arrays do not match its header, a sparse cell is 0
+        * or a directed graph is in symmetric storage.
+        * @throw runtime_error - if mapping the file fails.
+        */
+        void loadBinary(const string &path);
+
+        /*
+        * @brief
+        * These functions load the graph from a text file of edges, one edge to a line.
+        * The file is mapped into memory and cut into chunks of whole lines that are parsed on Algorithms::getThreadCount() threads,
+        * without iostreams, into a list of edges per chunk. The lists are scattered straight into sparse rows, each released
+        * once it is in, so the edges are never copied into one list, and the graph is moved to the storage it picks,
+        * never through a vector of rows.
+        * An edge given twice keeps the weight given last, and an edge of weight 0 is no edge, as in loadEdges.
+        *
+        * loadEdgeList - lines "u v" or "u v w", vertices from 0, weight 1 when it is missing.
+        * The graph has the vertices up to the largest one in the file. Blank lines and lines starting with # or % are skipped.
+        * loadDimacs - the shortest path format of the DIMACS challenge (.gr): "p sp n m" before the edges,
+        * then lines "a u v w" for directed edges, vertices from 1, and comment lines starting with c.
+        * loadMatrixMarket - a square Matrix Market coordinate matrix (.mtx): the "%%MatrixMarket matrix coordinate" line
+        * with an integer, real or pattern field and general or symmetric symmetry, then "rows columns entries",
+        * then lines "i j v", or "i j" for a pattern, vertices from 1. A symmetric matrix is an undirected graph.
+        * @param path - the file to load.
+        * @param directed - loadEdgeList only: false if every edge stands for both directions, true otherwise.
+        * @return void
+        * @throw invalid_argument - if the file cannot be opened, has no edges (edge list), or has a line that is not valid,
+        * the message gives its line number. A weight that does not fit in W is not valid, and neither is a vertex
+        * or a number of vertices beyond 2^20 plus 8 for every byte of the file.
+        * @throw runtime_error - if mapping the file fails.
+        */
+        void loadEdgeList(const string &path, bool directed);
+        void loadDimacs(const string &path);
+        void loadMatrixMarket(const string &path);
+
+        /*
+        * @brief
+        * This function writes the graph to a file descriptor with write(2), in the text operator<< prints
+        * with the default format of a stream, without going through iostreams.
+        * @param descriptor - an open file descriptor, left open.
+        * @return void
+        * @throw runtime_error - if writing fails.
+        */
+        void writeMatrix(int descriptor) const;
+
         /*
         * @brief
         * This function prints the graph.
@@ -51,7 +867,7 @@ namespace ariel
         * @return size_t - number of vertices in the graph.
         */
 
-        size_t getVertices();
+        size_t getVertices() const;
 
         /*
         * @brief
@@ -59,21 +875,111 @@ namespace ariel
         * @return size_t - number of edges in the graph.
         */
 
-        size_t getEdges();
+        size_t getEdges() const;
 
         /*
         * @brief
         * This function checks if the graph is directed.
+        * The direction is kept up to date by the functions that change the matrix, so this takes O(1).
         * @return bool - true if the graph is directed, false otherwise.
         */
-        bool isDirected();
+        bool isDirected() const;
 
         /*
         * @brief
-        * This counts the number of edges in the graph.
+        * This counts the number of edges in the graph, by scanning the whole matrix.
+        * getEdges returns the same number in O(1).
         * @return size_t - number of edges in the graph.
         */
-        size_t countEdges();
+        size_t countEdges() const;
+
+        /*
+        * @brief
+        * These functions return the smallest and the largest edge weight, kept up to date like the number of edges.
+        * @return W - the weight, 0 if the graph has no edges.
+        */
+        W getLightestWeight() const;
+        W getHeaviestWeight() const;
+
+        /*
+        * @brief
+        * This function checks if the graph has an edge of negative weight, in O(1).
+        * @return bool - true if some edge weight is negative, false otherwise.
+        */
+        bool hasNegativeWeights() const;
+
+        /*
+        * @brief
+        * This function returns the way the adjacency matrix is stored.
+        * loadGraph and the operators pick sparse storage when the density of the graph is below the sparse threshold,
+        * then bitset storage when all its edges weigh 1, then symmetric storage when the graph is undirected.
+        * @return Storage - the current storage.
+        */
+        Storage getStorage() const;
+
+        /*
+        * @brief
+        * This function returns the neighbours of a vertex, the non zero cells of its row.
+        * In sparse storage this takes time proportional to the degree of the vertex.
+        * @param v - the vertex.
+        * @return NeighbourRange - range of Neighbour values, in increasing vertex order.
+        */
+        NeighbourRange neighbours(size_t v) const;
+
+        /*
+        * @brief
+        * This function returns a read-only view of a row of the adjacency matrix, without copying it.
+        * The view is valid until the graph is changed or destroyed.
+        * @param i - row index.
+        * @return RowView - view of the edges leaving vertex i.
+        */
+        RowView getRow(size_t i) const;
+
+        /*
+        * @brief
+        * This function returns the weight of a single edge, without copying the adjacency matrix.
+        * In sparse storage it binary searches the row, so it takes O(log(degree)).
+        * @param i - source vertex.
+        * @param j - destination vertex.
+        * @return W - the weight of the edge from i to j, 0 if there is no edge.
+        */
+        W getWeight(size_t i, size_t j) const;
+
+        /*
+        * @brief
+        * This function returns the shortest paths between all the pairs of vertices.
+        * They are computed with Floyd-Warshall on the first call and kept until the graph is changed,
+        * so later calls on the same graph return the same object. Several threads may call it on one graph at once,
+        * the first builds the paths and the others wait for them.
+        * @return shared_ptr<const BasicAllPairsPaths<W>> - the shortest paths of the graph as it is now.
+        */
+        shared_ptr<const BasicAllPairsPaths<W>> getAllPairsPaths() const;
+
+        /*
+        * @brief
+        * This function returns which vertices can be reached from which, answered in O(1) per pair.
+        * The index is built on the first call and kept until the graph is changed, like getAllPairsPaths.
+        * @return shared_ptr<const ReachabilityIndex> - the reachability of the graph as it is now.
+        */
+        shared_ptr<const ReachabilityIndex> getReachability() const;
+
+        /*
+        * @brief
+        * This function returns the connected components of an undirected graph, answered in O(1) per query.
+        * They are found on the first call and kept until the graph is changed, like getAllPairsPaths,
+        * but operator+= adds the edges of the other graph to them instead of finding them again, as long as no edge
+        * can cancel out: both graphs undirected and without negative weights.
+        * @return shared_ptr<const DisjointSet> - the connected components of the graph as it is now.
+        * @throw invalid_argument - if the graph is directed.
+        */
+        shared_ptr<const DisjointSet> getConnectivity() const;
+
+        /*
+        * @brief
+        * This function returns the graph with the direction of every edge reversed, in the same storage.
+        * @return BasicGraph - the transposed graph.
+        */
+        BasicGraph transposed() const;
 
         /*
         * @brief
@@ -100,16 +1006,16 @@ namespace ariel
         /*
         * @brief
         * This function returns the adjacency matrix of the graph.
-        * @return vector<vector<int>> - adjacency matrix of the graph.
+        * @return vector<vector<W>> - adjacency matrix of the graph.
         */
-        vector<vector<int>> getAdjacencyMatrix();
+        vector<vector<W>> getAdjacencyMatrix() const;
 
         /*
         * @brief
         * This function returns the transpose of the adjacency matrix.
-        * @return vector<vector<int>> - transpose of the adjacency matrix.
+        * @return vector<vector<W>> - transpose of the adjacency matrix.
         */
-        vector<vector<int>> getTranspose();
+        vector<vector<W>> getTranspose() const;
 
         /*
         * @brief
@@ -117,134 +1023,143 @@ namespace ariel
         * @param g - graph to check if it is a subgraph.
         * @return bool - true if the graph is a subgraph, false otherwise.
         */
-        bool isSubgraph(const Graph &g) const;
+        bool isSubgraph(const BasicGraph &g) const;
 
         /*
         * @brief
         * This function overloads the << operator to print the graph.
+        * The rows are rendered into a buffer and written in large blocks, and the stream is flushed once at the end.
+        * A stream with flags that change how numbers print (hex, showpos, fixed, a width, a locale) gets every cell through <<.
         * @param os - output stream.
         * @param g - graph to print.
         * @return ostream - output stream.
         */
 
-        friend ostream &operator<<(ostream &os, const Graph &g);
-
-        /*
-        * @brief
-        * This function overloads the + operator to sum two graphs.
-        * @param g1 - first graph.
-        * @param g2 - second graph.
-        * @return Graph - the sum of the two graphs.
-        */
-
-        friend Graph operator+(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend ostream &operator<<(ostream &os, const BasicGraph<V> &g);
 
         /*
         * @brief
         * This function overloads the += operator to add a graph to the current graph.
         * @param g - graph to add.
-        * 
+        * @return BasicGraph& - the current graph.
         */
 
-        Graph operator+=(Graph &g);
+        BasicGraph &operator+=(const BasicGraph &g);
 
         /*
         * @brief
         * This function overloads the unary + operator to return the graph.
+        * @return BasicGraph& - the current graph.
         */
 
-        Graph operator+();
+        BasicGraph &operator+();
 
         /*
         * @brief
         * This function overloads the ++ operator to increment the graph by 1.
         * This is the prefix version of the operator.
-        * @return Graph - the incremented graph.
+        * @return BasicGraph& - the incremented graph.
         */
 
-        Graph operator++();
+        BasicGraph &operator++();
 
         /*
         * @brief
         * This function overloads the ++ operator to increment the graph by 1.
         * This is the postfix version of the operator.
-        * @return Graph - the pre-incremented graph.
-        */
-
-        Graph operator++(int);
-
-        /*
-        * @brief
-        * This function overloads the - operator to subtract two graphs.
-        * @param g1 - first graph.
-        * @param g2 - second graph.
+        * @return BasicGraph - the pre-incremented graph.
         */
 
-        friend Graph operator-(const Graph &g1, const Graph &g2);
+        BasicGraph operator++(int);
 
         /*
         * @brief
         * This function overloads the -= operator to subtract a graph from the current graph.
         * @param g - graph to subtract.
-        * @return Graph - the subtracted graph.
+        * @return BasicGraph& - the subtracted graph.
         */
 
-        Graph operator-=(Graph &g);
+        BasicGraph &operator-=(const BasicGraph &g);
 
         /*
         * @brief
-        * This function overloads the unary - operator to return the negative of the graph.
-        * @return Graph - the negative of the graph.
+        * This function overloads the unary - operator to negate the graph itself.
+        * @return BasicGraph& - the negative of the graph.
         */
 
-        Graph operator-();
+        BasicGraph &operator-();
 
         /*
         * @brief
         * This function overloads the -- operator to decrement the graph by 1.
         * This is the prefix version of the operator.
-        * @return Graph - the decremented graph.
+        * @return BasicGraph& - the decremented graph.
         */
 
-        Graph operator--();
+        BasicGraph &operator--();
 
         /*
         * @brief
         * This function overloads the -- operator to decrement the graph by 1.
         * This is the postfix version of the operator.
-        * @return Graph - the decremented graph.
+        * @return BasicGraph - the decremented graph.
         */
 
-        Graph operator--(int);
+        BasicGraph operator--(int);
 
         /*
         * @brief
         * This function overloads the * operator to multiply two graphs.
         * @param g1 - first graph.
         * @param g2 - second graph.
-        * @return Graph - the multiplication of the two graphs.
+        * @return BasicGraph - the multiplication of the two graphs.
         */
 
-        friend Graph operator*(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend BasicGraph<V> operator*(const BasicGraph<V> &g1, const BasicGraph<V> &g2);
+
+        /*
+        * @brief
+        * This function overloads the * operator for a first graph that is about to be destroyed, such as the result of another product.
+        * The rows of the product are written over the rows of g1, so no new matrix is allocated.
+        * @param g1 - first graph, its matrix is reused for the product.
+        * @param g2 - second graph.
+        * @return BasicGraph - the multiplication of the two graphs.
+        */
+        template <typename V>
+        friend BasicGraph<V> operator*(BasicGraph<V> &&g1, const BasicGraph<V> &g2);
+
+        /*
+        * @brief
+        * This function multiplies two graphs like the * operator, on at most the given number of threads.
+        * The product is the same for every number of threads.
+        * @param g1 - first graph.
+        * @param g2 - second graph.
+        * @param threads - the most threads the product may run on, 0 uses Algorithms::getThreadCount() threads.
+        * @return BasicGraph - the multiplication of the two graphs.
+        */
+        template <typename V>
+        friend BasicGraph<V> multiply(const BasicGraph<V> &g1, const BasicGraph<V> &g2, size_t threads);
 
         /*
         * @brief
         * This function overloads the *= operator to multiply the current graph by some scalar.
         * @param scalar - scalar to multiply the graph by.
-        * @return Graph - the multiplied graph.
+        * @return BasicGraph& - the multiplied graph.
         */
 
-        Graph operator*=(int scalar);
+        BasicGraph &operator*=(W scalar);
 
         /*
         * @brief
         * This function overloads the /= operator to divide the current graph by some scalar.
         * @param scalar - scalar to divide the graph by.
-        * @return Graph - the divided graph.
+        * @return BasicGraph& - the divided graph.
         * @throw invalid_argument - if the scalar is 0.
         */
 
-        Graph operator/=(int scalar);
+        BasicGraph &operator/=(W scalar);
 
         /*
         * @brief
@@ -254,7 +1169,8 @@ namespace ariel
         * @return bool - true if the graphs are equal, false otherwise.
         */
 
-        friend bool operator==(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend bool operator==(const BasicGraph<V> &g1, const BasicGraph<V> &g2);
 
         /*
         * @brief
@@ -264,7 +1180,8 @@ namespace ariel
         * @return bool - true if the graphs are not equal, false otherwise.
         */
 
-        friend bool operator!=(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend bool operator!=(const BasicGraph<V> &g1, const BasicGraph<V> &g2);
 
         /*
         * @brief
@@ -274,7 +1191,8 @@ namespace ariel
         * @return bool - true if the first graph is less than the second graph, false otherwise.
         */
 
-        friend bool operator<(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend bool operator<(const BasicGraph<V> &g1, const BasicGraph<V> &g2);
 
          /*
         * @brief
@@ -284,7 +1202,8 @@ namespace ariel
         * @return bool - true if the first graph is less than or equal to the second graph, false otherwise.
         */
 
-        friend bool operator<=(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend bool operator<=(const BasicGraph<V> &g1, const BasicGraph<V> &g2);
 
         /*
         * @brief
@@ -294,7 +1213,8 @@ namespace ariel
         * @return bool - true if the first graph is greater than the second graph, false otherwise.
         */
 
-        friend bool operator>(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend bool operator>(const BasicGraph<V> &g1, const BasicGraph<V> &g2);
 
         /*
         * @brief
@@ -304,12 +1224,65 @@ namespace ariel
         * @return bool - true if the first graph is greater than or equal to the second graph, false otherwise.
         */
 
-        friend bool operator>=(const Graph &g1, const Graph &g2);
+        template <typename V>
+        friend bool operator>=(const BasicGraph<V> &g1, const BasicGraph<V> &g2);
 
-       
+    };
 
-        
+    /*
+    * @brief
+    * A read-only view of one row of the adjacency matrix of a graph.
+    * Indexing it reads a single cell, iterating over it visits the neighbours of the vertex, neither copies the row.
+    */
+    template <typename W>
+    class BasicGraph<W>::RowView
+    {
+    private:
+        const BasicGraph *graph;
+        size_t index;
+
+    public:
+        RowView(const BasicGraph *graph, size_t index) : graph(graph), index(index) {}
+
+        // Number of cells in the row, the number of vertices of the graph.
+        size_t size() const { return this->graph->getVertices(); }
+        // Weight of the edge to vertex j, 0 if there is no edge.
+        W operator[](size_t j) const { return this->graph->getWeight(this->index, j); }
+        // The row as a contiguous array in dense storage, nullptr in the other storages.
+        const W *data() const { return this->graph->storage == Storage::Dense ? this->graph->row(this->index) : nullptr; }
+        // The words of the row in bitset storage, (getVertices() + 63) / 64 of them, nullptr in the other storages.
+        const uint64_t *bits() const { return this->graph->storage == Storage::Bitset ? this->graph->bitRow(this->index) : nullptr; }
+        NeighbourIterator begin() const { return this->graph->neighbours(this->index).begin(); }
+        NeighbourIterator end() const { return this->graph->neighbours(this->index).end(); }
     };
+
+    template <typename W>
+    ostream &operator<<(ostream &os, const BasicGraph<W> &g);
+    template <typename W>
+    BasicGraph<W> operator*(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+    template <typename W>
+    BasicGraph<W> operator*(BasicGraph<W> &&g1, const BasicGraph<W> &g2);
+    template <typename W>
+    BasicGraph<W> multiply(const BasicGraph<W> &g1, const BasicGraph<W> &g2, size_t threads);
+    template <typename W>
+    bool operator==(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+    template <typename W>
+    bool operator!=(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+    template <typename W>
+    bool operator<(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+    template <typename W>
+    bool operator<=(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+    template <typename W>
+    bool operator>(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+    template <typename W>
+    bool operator>=(const BasicGraph<W> &g1, const BasicGraph<W> &g2);
+
+    // The graph of int weights.
+    typedef BasicGraph<int> Graph;
+    // The shortest paths of a graph of int weights.
+    typedef BasicAllPairsPaths<int> AllPairsPaths;
 }
 
+#include "GraphExpression.hpp"
+
 #endif
\ No newline at end of file
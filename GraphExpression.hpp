@@ -0,0 +1,499 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _GRAPH_EXPRESSION_HPP_
+#define _GRAPH_EXPRESSION_HPP_
+
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include "Graph.hpp"
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * The base of the lazy results of +, -, unary - and scaling by a weight.
+    * An expression only remembers its operands, its cells are computed when it is assigned to a Graph
+    * (or converted to one), in a single pass over the rows into the destination matrix.
+    * The operands are held by reference, so an expression must be used before the full expression that created it ends,
+    * as in Graph g = g1 + g2 - g3. Keeping one in an auto variable leaves it pointing at destroyed temporaries.
+    *
+    * An expression E provides:
+    * Weight - the weight type of its operands and of the result, the operands of an expression all have the same one.
+    * getVertices() - the number of vertices of the result.
+    * loadRow(i) - prepares row i of every operand, called before the cells of the row are read.
+    * loadUpperRow(i) - like loadRow(i), for a symmetric result, when only the cells j >= i of the row are read.
+    * operator[](j) - the cell j of the row loaded last.
+    * mayBeDirected() - false if the result is known to be symmetric.
+    * references(g) - true if the graph g is one of the operands.
+    */
+    template <typename E>
+    class GraphExpression
+    {
+    public:
+        const E &derived() const { return static_cast<const E &>(*this); }
+        size_t getVertices() const { return this->derived().getVertices(); }
+    };
+
+    /*
+    * @brief
+    * A graph used as an operand of an expression. A dense row is read in place, a sparse row is expanded into a scratch row.
+    * The upper part of a row in symmetric storage is read in place too.
+    */
+    template <typename W>
+    class GraphTerminal : public GraphExpression<GraphTerminal<W>>
+    {
+    private:
+        const BasicGraph<W> *graph;
+        mutable const W *current;
+        // Allocated on the first sparse row, so copying a terminal into an expression is cheap.
+        mutable vector<W> scratch;
+
+    public:
+        typedef W Weight;
+
+        explicit GraphTerminal(const BasicGraph<W> &graph) : graph(&graph), current(nullptr) {}
+
+        size_t getVertices() const { return this->graph->vertices; }
+
+        void loadRow(size_t i) const
+        {
+            if (this->graph->storage != GraphBase::Storage::Dense && this->scratch.empty())
+            {
+                this->scratch.resize(this->graph->vertices);
+            }
+            this->current = this->graph->denseRow(i, this->scratch.data());
+        }
+
+        void loadUpperRow(size_t i) const
+        {
+            // Cell j of the row is upperRow(i)[j - i], the start of the row is never read.
+            if (this->graph->storage == GraphBase::Storage::Symmetric)
+            {
+                this->current = this->graph->upperRow(i) - i;
+                return;
+            }
+            this->loadRow(i);
+        }
+
+        W operator[](size_t j) const { return this->current[j]; }
+        bool mayBeDirected() const { return this->graph->directed; }
+        bool references(const BasicGraph<W> &g) const { return this->graph == &g; }
+    };
+
+    // The cell operations of the binary expressions.
+    struct AddCells
+    {
+        template <typename W>
+        static W apply(W a, W b) { return a + b; }
+    };
+
+    struct SubtractCells
+    {
+        template <typename W>
+        static W apply(W a, W b) { return a - b; }
+    };
+
+    /*
+    * @brief
+    * The cell by cell sum or difference of two expressions of the same size.
+    */
+    template <typename L, typename R, typename Op>
+    class GraphBinaryExpression : public GraphExpression<GraphBinaryExpression<L, R, Op>>
+    {
+    private:
+        L left;
+        R right;
+
+    public:
+        static_assert(is_same<typename L::Weight, typename R::Weight>::value, "The graphs must have the same weight type.");
+        typedef typename L::Weight Weight;
+
+        GraphBinaryExpression(const L &left, const R &right) : left(left), right(right)
+        {
+            // If the matrices are not the same size, throw an exception.
+            if (left.getVertices() != right.getVertices())
+            {
+                throw invalid_argument("The matrices must be the same size.");
+            }
+        }
+
+        size_t getVertices() const { return this->left.getVertices(); }
+
+        void loadRow(size_t i) const
+        {
+            this->left.loadRow(i);
+            this->right.loadRow(i);
+        }
+
+        void loadUpperRow(size_t i) const
+        {
+            this->left.loadUpperRow(i);
+            this->right.loadUpperRow(i);
+        }
+
+        Weight operator[](size_t j) const { return Op::apply(this->left[j], this->right[j]); }
+        // The sum and the difference of symmetric matrices are symmetric.
+        bool mayBeDirected() const { return this->left.mayBeDirected() || this->right.mayBeDirected(); }
+        bool references(const BasicGraph<Weight> &g) const { return this->left.references(g) || this->right.references(g); }
+    };
+
+    /*
+    * @brief
+    * An expression with every cell multiplied by a weight, -e is e scaled by -1.
+    */
+    template <typename E>
+    class GraphScaling : public GraphExpression<GraphScaling<E>>
+    {
+    public:
+        typedef typename E::Weight Weight;
+
+    private:
+        E operand;
+        Weight scalar;
+
+    public:
+        GraphScaling(const E &operand, Weight scalar) : operand(operand), scalar(scalar) {}
+
+        size_t getVertices() const { return this->operand.getVertices(); }
+        void loadRow(size_t i) const { this->operand.loadRow(i); }
+        void loadUpperRow(size_t i) const { this->operand.loadUpperRow(i); }
+        Weight operator[](size_t j) const { return this->scalar * this->operand[j]; }
+        bool mayBeDirected() const { return this->operand.mayBeDirected(); }
+        bool references(const BasicGraph<Weight> &g) const { return this->operand.references(g); }
+    };
+
+    /*
+    * @brief
+    * The expression an operand of +, - or scaling becomes: a graph becomes a GraphTerminal, an expression stays itself.
+    * Defined only for graphs and expressions, so the operators below do not take part in overload resolution for other types.
+    */
+    template <typename T, typename = void>
+    struct GraphOperand
+    {
+    };
+
+    template <typename W>
+    struct GraphOperand<BasicGraph<W>>
+    {
+        typedef GraphTerminal<W> type;
+        static GraphTerminal<W> wrap(const BasicGraph<W> &g) { return GraphTerminal<W>(g); }
+    };
+
+    template <typename T>
+    struct GraphOperand<T, typename enable_if<is_base_of<GraphExpression<T>, T>::value>::type>
+    {
+        typedef T type;
+        static const T &wrap(const T &e) { return e; }
+    };
+
+    template <typename L, typename R>
+    using GraphSum = GraphBinaryExpression<typename GraphOperand<L>::type, typename GraphOperand<R>::type, AddCells>;
+    template <typename L, typename R>
+    using GraphDifference = GraphBinaryExpression<typename GraphOperand<L>::type, typename GraphOperand<R>::type, SubtractCells>;
+    template <typename T>
+    using GraphScaled = GraphScaling<typename GraphOperand<T>::type>;
+    // The graph of the weight type of T, for the operators that are only defined when T is a graph or an expression.
+    template <typename T>
+    using GraphResult = BasicGraph<typename GraphOperand<T>::type::Weight>;
+    // The weight type of T, for the scalar of a scaling.
+    template <typename T>
+    using GraphWeight = typename GraphOperand<T>::type::Weight;
+
+    /*
+    * @brief
+    * This function overloads the + operator to sum two graphs or expressions.
+    * @param g1 - first graph or expression.
+    * @param g2 - second graph or expression.
+    * @return GraphSum - the lazy sum, evaluated when assigned to a Graph.
+    * @throw invalid_argument - if the graphs are not the same size.
+    */
+    template <typename L, typename R>
+    GraphSum<L, R> operator+(const L &g1, const R &g2)
+    {
+        return GraphSum<L, R>(GraphOperand<L>::wrap(g1), GraphOperand<R>::wrap(g2));
+    }
+
+    /*
+    * @brief
+    * This function overloads the - operator to subtract two graphs or expressions.
+    * @param g1 - first graph or expression.
+    * @param g2 - second graph or expression.
+    * @return GraphDifference - the lazy difference, evaluated when assigned to a Graph.
+    * @throw invalid_argument - if the graphs are not the same size.
+    */
+    template <typename L, typename R>
+    GraphDifference<L, R> operator-(const L &g1, const R &g2)
+    {
+        return GraphDifference<L, R>(GraphOperand<L>::wrap(g1), GraphOperand<R>::wrap(g2));
+    }
+
+    /*
+    * @brief
+    * These functions overload + and - for a graph operand that is about to be destroyed, such as the result of a product.
+    * The result is written over the matrix of that operand, so no new matrix is allocated.
+    * @param g1 - first graph or expression.
+    * @param g2 - second graph or expression.
+    * @return Graph - the sum or difference, in the matrix of the expiring operand.
+    * @throw invalid_argument - if the graphs are not the same size.
+    */
+    template <typename W, typename R>
+    GraphResult<R> operator+(BasicGraph<W> &&g1, const R &g2)
+    {
+        g1 = g1 + g2;
+        return move(g1);
+    }
+
+    template <typename W, typename L>
+    GraphResult<L> operator+(const L &g1, BasicGraph<W> &&g2)
+    {
+        g2 = g1 + g2;
+        return move(g2);
+    }
+
+    template <typename W>
+    BasicGraph<W> operator+(BasicGraph<W> &&g1, BasicGraph<W> &&g2)
+    {
+        g1 = g1 + g2;
+        return move(g1);
+    }
+
+    template <typename W, typename R>
+    GraphResult<R> operator-(BasicGraph<W> &&g1, const R &g2)
+    {
+        g1 = g1 - g2;
+        return move(g1);
+    }
+
+    template <typename W, typename L>
+    GraphResult<L> operator-(const L &g1, BasicGraph<W> &&g2)
+    {
+        g2 = g1 - g2;
+        return move(g2);
+    }
+
+    template <typename W>
+    BasicGraph<W> operator-(BasicGraph<W> &&g1, BasicGraph<W> &&g2)
+    {
+        g1 = g1 - g2;
+        return move(g1);
+    }
+
+    /*
+    * @brief
+    * This function overloads the unary - operator of an expression.
+    * The unary - of a Graph is a member of Graph that negates the graph itself.
+    * @param e - the expression.
+    * @return GraphScaling - the lazy negative of the expression.
+    */
+    template <typename E>
+    GraphScaling<E> operator-(const GraphExpression<E> &e)
+    {
+        return GraphScaling<E>(e.derived(), -1);
+    }
+
+    /*
+    * @brief
+    * These functions overload the * operator to multiply every edge weight of a graph or expression by a weight.
+    * @param g - the graph or expression.
+    * @param scalar - the weight, of the weight type of g.
+    * @return GraphScaled - the lazy scaled graph, evaluated when assigned to a Graph.
+    */
+    template <typename T>
+    GraphScaled<T> operator*(const T &g, GraphWeight<T> scalar)
+    {
+        return GraphScaled<T>(GraphOperand<T>::wrap(g), scalar);
+    }
+
+    template <typename T>
+    GraphScaled<T> operator*(GraphWeight<T> scalar, const T &g)
+    {
+        return GraphScaled<T>(GraphOperand<T>::wrap(g), scalar);
+    }
+
+    /*
+    * @brief
+    * The graph an operand of <<, a comparison or a product stands for: a graph is used as it is, an expression is evaluated.
+    * Those operators are templates on BasicGraph<W>, and template argument deduction does not look at the conversion
+    * of an expression to a graph, so the overloads below take expressions and pass their graphs on.
+    */
+    template <typename W>
+    const BasicGraph<W> &evaluateOperand(const BasicGraph<W> &g)
+    {
+        return g;
+    }
+
+    template <typename E>
+    BasicGraph<typename E::Weight> evaluateOperand(const GraphExpression<E> &e)
+    {
+        return BasicGraph<typename E::Weight>(e);
+    }
+
+    // T, for the operators on two graphs or expressions of the same weight type, at least one of them an expression.
+    template <typename L, typename R, typename T>
+    using IfExpressionOperands = typename enable_if<(is_base_of<GraphExpression<L>, L>::value || is_base_of<GraphExpression<R>, R>::value) &&
+                                                        is_same<GraphWeight<L>, GraphWeight<R>>::value,
+                                                    T>::type;
+
+    /*
+    * @brief
+    * This function overloads the << operator to print the graph an expression evaluates to.
+    * @param os - output stream.
+    * @param e - the expression.
+    * @return ostream - output stream.
+    */
+    template <typename E>
+    ostream &operator<<(ostream &os, const GraphExpression<E> &e)
+    {
+        return os << evaluateOperand(e);
+    }
+
+    /*
+    * @brief
+    * These functions overload the comparison operators and the product for an expression operand.
+    * @param g1 - first graph or expression.
+    * @param g2 - second graph or expression.
+    * @return bool - the comparison of the graphs, or Graph - their product.
+    * @throw invalid_argument - if the graphs are not the same size (product only).
+    */
+    template <typename L, typename R>
+    IfExpressionOperands<L, R, bool> operator==(const L &g1, const R &g2)
+    {
+        return evaluateOperand(g1) == evaluateOperand(g2);
+    }
+
+    template <typename L, typename R>
+    IfExpressionOperands<L, R, bool> operator!=(const L &g1, const R &g2)
+    {
+        return evaluateOperand(g1) != evaluateOperand(g2);
+    }
+
+    template <typename L, typename R>
+    IfExpressionOperands<L, R, bool> operator<(const L &g1, const R &g2)
+    {
+        return evaluateOperand(g1) < evaluateOperand(g2);
+    }
+
+    template <typename L, typename R>
+    IfExpressionOperands<L, R, bool> operator<=(const L &g1, const R &g2)
+    {
+        return evaluateOperand(g1) <= evaluateOperand(g2);
+    }
+
+    template <typename L, typename R>
+    IfExpressionOperands<L, R, bool> operator>(const L &g1, const R &g2)
+    {
+        return evaluateOperand(g1) > evaluateOperand(g2);
+    }
+
+    template <typename L, typename R>
+    IfExpressionOperands<L, R, bool> operator>=(const L &g1, const R &g2)
+    {
+        return evaluateOperand(g1) >= evaluateOperand(g2);
+    }
+
+    template <typename L, typename R>
+    IfExpressionOperands<L, R, GraphResult<L>> operator*(const L &g1, const R &g2)
+    {
+        return evaluateOperand(g1) * evaluateOperand(g2);
+    }
+
+    template <typename W>
+    template <typename E>
+    BasicGraph<W>::BasicGraph(const GraphExpression<E> &expression) : BasicGraph()
+    {
+        this->evaluate(expression.derived());
+    }
+
+    template <typename W>
+    template <typename E>
+    BasicGraph<W> &BasicGraph<W>::operator=(const GraphExpression<E> &expression)
+    {
+        // A dense matrix of the same size is written over in place, each cell of the operands is read before it is replaced,
+        // and so is a triangle of the same size in symmetric storage when the result is undirected too.
+        // Otherwise, if the graph is one of the operands, its rows are still needed while the result is written.
+        bool sameSize = this->vertices == expression.getVertices();
+        bool inPlace = (this->storage == Storage::Dense && sameSize) ||
+                       (this->storage == Storage::Symmetric && sameSize && GraphBase::symmetricStorage && !expression.derived().mayBeDirected());
+        if (!inPlace && expression.derived().references(*this))
+        {
+            BasicGraph result(expression);
+            *this = move(result);
+            return *this;
+        }
+        this->evaluate(expression.derived());
+        return *this;
+    }
+
+    template <typename W>
+    template <typename E>
+    void BasicGraph<W>::evaluate(const E &expression)
+    {
+        static_assert(is_same<typename E::Weight, W>::value, "The graph must have the weight type of the expression.");
+        size_t n = expression.getVertices();
+        // Asked before the matrix is written, the graph may be one of the operands.
+        bool mayBeDirected = expression.mayBeDirected();
+        this->dropResults();
+        CellSummary summary;
+
+        // An undirected result is computed in symmetric storage, only its upper triangle,
+        // unless the graph is an operand in dense storage, which is written over in place.
+        if (!mayBeDirected && GraphBase::symmetricStorage && !(this->storage == Storage::Dense && expression.references(*this)))
+        {
+            if (this->storage != Storage::Symmetric || this->vertices != n)
+            {
+                this->resizeSymmetric(n);
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                expression.loadUpperRow(i);
+                W *out = this->upperRow(i) - i;
+                writeCells(expression, out, i, n);
+                summary.addUpperRow(out + i, n - i);
+            }
+            this->directed = false;
+            this->updateMetadata(summary, false);
+            return;
+        }
+
+        // The padding at the end of the rows is never written, so a dense matrix of the same size can be reused as it is.
+        if (this->storage != Storage::Dense || this->vertices != n)
+        {
+            this->resize(n);
+        }
+
+        // One pass: every row of the result is computed from the operands and summarized while it is in the cache.
+        for (size_t i = 0; i < n; i++)
+        {
+            expression.loadRow(i);
+            W *out = this->row(i);
+            writeCells(expression, out, 0, n);
+            summary.addRow(out, n);
+        }
+        // A result known to be symmetric is not checked again.
+        this->directed = false;
+        this->updateMetadata(summary, mayBeDirected);
+    }
+
+    template <typename W>
+    template <typename E>
+    void BasicGraph<W>::writeCells(const E &expression, W *out, size_t begin, size_t end)
+    {
+        const size_t BLOCK = 256;
+        W block[BLOCK];
+        for (size_t jb = begin; jb < end; jb += BLOCK)
+        {
+            size_t count = min(BLOCK, end - jb);
+            for (size_t j = 0; j < count; j++)
+            {
+                block[j] = expression[jb + j];
+            }
+            copy(block, block + count, out + jb);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,878 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Graph.hpp"
+#include "ThreadPool.hpp"
+using ariel::AlignedBuffer;
+using ariel::BasicGraph;
+using ariel::GraphBase;
+using namespace std;
+
+// The first bytes of every graph file.
+static const char BINARY_MAGIC[8] = {'A', 'R', 'I', 'E', 'L', 'G', 'R', 'F'};
+// Changes whenever the layout of the file changes, a file of another version is not loaded.
+static const uint32_t BINARY_VERSION = 1;
+// Written as it is in memory, it reads back the same only on a machine with the same byte order.
+static const uint32_t BINARY_BYTE_ORDER = 0x01020304;
+// The arrays start at multiples of this in the file, the file is mapped at a page, so they are as aligned as AlignedBuffer.
+static const size_t BINARY_ALIGNMENT = AlignedBuffer<char>::ALIGNMENT;
+// The text formats are parsed in chunks of about this many bytes, cut at the ends of lines, one chunk to a thread at a time.
+static const size_t PARSE_CHUNK_BYTES = 1 << 20;
+// A text file may name vertices up to this many per byte of the file, on top of MIN_TEXT_VERTICES,
+// so the rows of the graph it makes stay in proportion to the file. A larger vertex is taken as a damaged line.
+static const uint64_t TEXT_VERTICES_PER_BYTE = 8;
+static const uint64_t MIN_TEXT_VERTICES = 1 << 20;
+// The arrays of a graph, in the order of the file: the dense or symmetric matrix, the row offsets,
+// columns and weights of sparse storage, and the words of bitset storage. Those the storage does not use are empty.
+static const size_t BINARY_ARRAYS = 5;
+
+/*
+* @brief
+* The header at the start of a graph file, followed by the arrays.
+* The lightest and heaviest weights take the first bytes of their fields.
+*/
+struct BinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    // The size of a weight in bytes, plus 0x100 for floating point weights.
+    uint32_t weightType;
+    uint32_t storage;
+    uint32_t directed;
+    uint32_t reserved;
+    uint64_t vertices;
+    uint64_t edges;
+    uint64_t nonZeros;
+    uint64_t stride;
+    uint8_t lightest[8];
+    uint8_t heaviest[8];
+    // The offset of every array in bytes and its number of elements.
+    uint64_t offsets[BINARY_ARRAYS];
+    uint64_t lengths[BINARY_ARRAYS];
+};
+
+template <typename W>
+static uint32_t weightType()
+{
+    return static_cast<uint32_t>(sizeof(W)) | (is_floating_point<W>::value ? 0x100u : 0u);
+}
+
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT * BINARY_ALIGNMENT;
+}
+
+/*
+* @brief
+* This function returns an array of a mapped graph file as a buffer over the mapping, empty if the file has no such array.
+* @param base - the start of the mapping.
+* @param header - the header of the file, its arrays already checked.
+* @param index - the array.
+* @param mapping - keeps the mapping alive.
+* @return AlignedBuffer<T> - the array, in place.
+*/
+template <typename T>
+static AlignedBuffer<T> mappedArray(char *base, const BinaryHeader &header, size_t index, const shared_ptr<const void> &mapping)
+{
+    if (header.lengths[index] == 0)
+    {
+        return AlignedBuffer<T>();
+    }
+    return AlignedBuffer<T>(reinterpret_cast<T *>(base + header.offsets[index]), static_cast<size_t>(header.lengths[index]), mapping);
+}
+
+/*
+* @brief
+* This function maps a whole file into memory, privately, so writes to the memory never reach the file.
+* @param path - the file.
+* @param protection - PROT_READ, or PROT_READ | PROT_WRITE to be able to change the memory.
+* @param fileSize - set to the size of the file.
+* @return shared_ptr<const void> - the start of the mapping, unmapped with the last copy, nullptr for an empty file.
+* @throw invalid_argument - if the file cannot be opened.
+* @throw runtime_error - if mapping the file fails.
+*/
+static shared_ptr<const void> mapFile(const string &path, int protection, size_t &fileSize)
+{
+    int descriptor = open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        if (descriptor >= 0)
+        {
+            close(descriptor);
+        }
+        throw invalid_argument("Cannot open the file " + path);
+    }
+    fileSize = static_cast<size_t>(status.st_size);
+    if (fileSize == 0)
+    {
+        close(descriptor);
+        return nullptr;
+    }
+    void *address = mmap(nullptr, fileSize, protection, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED)
+    {
+        throw runtime_error("Mapping the file " + path + " failed.");
+    }
+    size_t length = fileSize;
+    return shared_ptr<const void>(address, [length](const void *memory)
+                                  { munmap(const_cast<void *>(memory), length); });
+}
+
+template <typename W>
+void BasicGraph<W>::saveBinary(const string &path) const
+{
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.byteOrder = BINARY_BYTE_ORDER;
+    header.weightType = weightType<W>();
+    header.storage = static_cast<uint32_t>(this->storage);
+    header.directed = this->directed;
+    header.vertices = this->vertices;
+    header.edges = this->edges;
+    header.nonZeros = this->nonZeros;
+    header.stride = this->stride;
+    memcpy(header.lightest, &this->lightest, sizeof(W));
+    memcpy(header.heaviest, &this->heaviest, sizeof(W));
+
+    const char *arrays[BINARY_ARRAYS] = {
+        reinterpret_cast<const char *>(this->adjancencyMatrix.data()), reinterpret_cast<const char *>(this->rowOffsets.data()),
+        reinterpret_cast<const char *>(this->columnIndices.data()), reinterpret_cast<const char *>(this->weights.data()),
+        reinterpret_cast<const char *>(this->bits.data())};
+    size_t bytes[BINARY_ARRAYS] = {
+        this->adjancencyMatrix.size() * sizeof(W), this->rowOffsets.size() * sizeof(size_t),
+        this->columnIndices.size() * sizeof(size_t), this->weights.size() * sizeof(W), this->bits.size() * sizeof(uint64_t)};
+    size_t lengths[BINARY_ARRAYS] = {this->adjancencyMatrix.size(), this->rowOffsets.size(), this->columnIndices.size(),
+                                     this->weights.size(), this->bits.size()};
+    uint64_t offset = alignOffset(sizeof(header));
+    for (size_t a = 0; a < BINARY_ARRAYS; a++)
+    {
+        header.offsets[a] = lengths[a] == 0 ? 0 : offset;
+        header.lengths[a] = lengths[a];
+        offset = alignOffset(offset + bytes[a]);
+    }
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file)
+    {
+        throw invalid_argument("Cannot create the file " + path);
+    }
+    static const char padding[BINARY_ALIGNMENT] = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    uint64_t written = sizeof(header);
+    for (size_t a = 0; a < BINARY_ARRAYS; a++)
+    {
+        if (lengths[a] == 0)
+        {
+            continue;
+        }
+        file.write(padding, static_cast<streamsize>(header.offsets[a] - written));
+        file.write(arrays[a], static_cast<streamsize>(bytes[a]));
+        written = header.offsets[a] + bytes[a];
+    }
+    file.close();
+    if (!file)
+    {
+        throw runtime_error("Writing the file " + path + " failed.");
+    }
+}
+
+/*
+* @brief
+* This function checks that the arrays of a graph file are inside the file, aligned, and have the lengths the storage needs,
+* and that the row offsets and columns of sparse storage and the bits past the last vertex of bitset storage are valid,
+* so that no function of the graph reads outside its arrays.
+* @param header - the header of the file.
+* @param base - the start of the mapping.
+* @param fileSize - the size of the file in bytes.
+* @param weightSize - the size of a weight in bytes.
+* @param denseStride - the row stride of dense storage of this many vertices.
+* @param bitStride - the row stride of bitset storage of this many vertices.
+* @return string - what is wrong with the file, empty if it is valid.
+*/
+static string checkArrays(const BinaryHeader &header, const char *base, uint64_t fileSize, size_t weightSize, uint64_t denseStride, uint64_t bitStride)
+{
+    uint64_t n = header.vertices;
+    const uint64_t elementSizes[BINARY_ARRAYS] = {weightSize, sizeof(size_t), sizeof(size_t), weightSize, sizeof(uint64_t)};
+    for (size_t a = 0; a < BINARY_ARRAYS; a++)
+    {
+        if (header.lengths[a] != 0 && (header.offsets[a] % BINARY_ALIGNMENT != 0 || header.offsets[a] < sizeof(BinaryHeader) ||
+                                       header.offsets[a] > fileSize || header.lengths[a] > (fileSize - header.offsets[a]) / elementSizes[a]))
+        {
+            return "an array is outside the file";
+        }
+    }
+
+    if (header.storage > static_cast<uint32_t>(GraphBase::Storage::Symmetric))
+    {
+        return "the storage is unknown";
+    }
+    // The arrays the storage uses, by their index, and those it does not use must be empty.
+    GraphBase::Storage storage = static_cast<GraphBase::Storage>(header.storage);
+    bool sparse = storage == GraphBase::Storage::Sparse;
+    bool used[BINARY_ARRAYS] = {storage == GraphBase::Storage::Dense || storage == GraphBase::Storage::Symmetric, sparse, sparse, sparse,
+                                storage == GraphBase::Storage::Bitset};
+    for (size_t a = 0; a < BINARY_ARRAYS; a++)
+    {
+        if (!used[a] && header.lengths[a] != 0)
+        {
+            return "an array does not belong to the storage";
+        }
+    }
+    // Every array is checked to fit in the file before its length is compared, so the lengths below cannot overflow.
+    if (storage == GraphBase::Storage::Dense)
+    {
+        if (header.stride != denseStride || header.lengths[0] / denseStride != n || header.lengths[0] % denseStride != 0)
+        {
+            return "the matrix does not have the size of the graph";
+        }
+    }
+    else if (storage == GraphBase::Storage::Symmetric)
+    {
+        if (n > 0xFFFFFFFFu || header.lengths[0] != n * (n + 1) / 2)
+        {
+            return "the matrix does not have the size of the graph";
+        }
+    }
+    else if (storage == GraphBase::Storage::Bitset)
+    {
+        if (header.stride != bitStride || header.lengths[4] / bitStride != n || header.lengths[4] % bitStride != 0)
+        {
+            return "the bits do not have the size of the graph";
+        }
+        // Only the words of a row past the last vertex may hold bits that are not edges.
+        const uint64_t *bits = reinterpret_cast<const uint64_t *>(base + header.offsets[4]);
+        uint64_t lastWord = n / 64;
+        uint64_t lastMask = n % 64 == 0 ? 0 : ~uint64_t(0) << (n % 64);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            const uint64_t *row = bits + i * bitStride;
+            for (uint64_t w = lastWord; w < bitStride; w++)
+            {
+                if ((row[w] & (w == lastWord ? lastMask : ~uint64_t(0))) != 0)
+                {
+                    return "a row has bits past the last vertex";
+                }
+            }
+        }
+    }
+    else
+    {
+        // n + 1 must not wrap around to 0, and the row offsets must not be empty, or offsets[0] would be read outside the file.
+        if (n >= fileSize / sizeof(size_t) || header.lengths[1] == 0 || header.lengths[1] != n + 1 ||
+            header.lengths[2] != header.lengths[3])
+        {
+            return "the sparse rows do not have the size of the graph";
+        }
+        const size_t *offsets = reinterpret_cast<const size_t *>(base + header.offsets[1]);
+        const size_t *columns = reinterpret_cast<const size_t *>(base + header.offsets[2]);
+        if (offsets[0] != 0 || offsets[n] != header.lengths[2])
+        {
+            return "the sparse rows do not have the size of the graph";
+        }
+        for (uint64_t i = 0; i < n; i++)
+        {
+            if (offsets[i + 1] < offsets[i] || offsets[i + 1] > offsets[n])
+            {
+                return "the row offsets are not increasing";
+            }
+            for (size_t p = offsets[i]; p < offsets[i + 1]; p++)
+            {
+                if (columns[p] >= n || (p > offsets[i] && columns[p] <= columns[p - 1]))
+                {
+                    return "the columns of a row are not increasing vertices of the graph";
+                }
+            }
+        }
+    }
+    return "";
+}
+
+template <typename W>
+void BasicGraph<W>::loadBinary(const string &path)
+{
+    // A private, writable mapping: the graph may change its cells in place, the pages it writes are copied and the file stays as it is.
+    size_t fileSize;
+    shared_ptr<const void> mapping = mapFile(path, PROT_READ | PROT_WRITE, fileSize);
+    if (fileSize < sizeof(BinaryHeader))
+    {
+        throw invalid_argument("The file " + path + " is not a graph file.");
+    }
+    char *base = static_cast<char *>(const_cast<void *>(mapping.get()));
+
+    BinaryHeader header;
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw invalid_argument("The file " + path + " is not a graph file.");
+    }
+    if (header.version != BINARY_VERSION || header.byteOrder != BINARY_BYTE_ORDER || sizeof(size_t) != sizeof(uint64_t))
+    {
+        throw invalid_argument("The graph file " + path + " was written by another version or on another kind of machine.");
+    }
+    if (header.weightType != weightType<W>())
+    {
+        throw invalid_argument("The graph file " + path + " holds weights of another type.");
+    }
+    if (header.vertices == 0 || header.directed > 1)
+    {
+        throw invalid_argument("Invalid graph");
+    }
+    uint64_t n = header.vertices;
+    // n is not yet known to fit in the file, a dense matrix of more vertices than bytes in the file fails the checks anyway.
+    uint64_t denseStride = AlignedBuffer<W>::rowStride(static_cast<size_t>(min(n, static_cast<uint64_t>(fileSize))));
+    uint64_t bitStride = AlignedBuffer<uint64_t>::rowStride(static_cast<size_t>(n / 64 + (n % 64 != 0)));
+    string problem = checkArrays(header, base, fileSize, sizeof(W), denseStride, bitStride);
+    if (!problem.empty())
+    {
+        throw invalid_argument("The graph file " + path + " is damaged: " + problem + ".");
+    }
+
+    Storage storage = static_cast<Storage>(header.storage);
+    if (storage == Storage::Symmetric && header.directed != 0)
+    {
+        throw invalid_argument("The graph file " + path + " is damaged: a directed graph is in symmetric storage.");
+    }
+
+    // The graph is built aside, so a damaged file leaves this graph as it was.
+    BasicGraph<W> g;
+    g.storage = storage;
+    g.vertices = static_cast<size_t>(n);
+    g.stride = static_cast<size_t>(header.stride);
+    g.adjancencyMatrix = mappedArray<W>(base, header, 0, mapping);
+    g.rowOffsets = mappedArray<size_t>(base, header, 1, mapping);
+    g.columnIndices = mappedArray<size_t>(base, header, 2, mapping);
+    g.weights = mappedArray<W>(base, header, 3, mapping);
+    g.bits = mappedArray<uint64_t>(base, header, 4, mapping);
+
+    // The counts, the weights and the direction in the header are not trusted, they are found again from the arrays.
+    size_t vertices = g.vertices;
+    CellSummary summary;
+    if (storage == Storage::Dense)
+    {
+        for (size_t i = 0; i < vertices; i++)
+        {
+            summary.addRow(g.row(i), vertices);
+        }
+    }
+    else if (storage == Storage::Symmetric)
+    {
+        for (size_t i = 0; i < vertices; i++)
+        {
+            summary.addUpperRow(g.upperRow(i), vertices - i);
+        }
+    }
+    else if (storage == Storage::Sparse)
+    {
+        size_t cells = static_cast<size_t>(header.lengths[3]);
+        summary.addRow(g.weights.data(), cells);
+        if (summary.nonZeros != cells)
+        {
+            throw invalid_argument("The graph file " + path + " is damaged: a sparse cell is 0.");
+        }
+    }
+    else
+    {
+        // Every edge of bitset storage weighs 1.
+        summary.nonZeros = g.countNonZeros();
+        summary.lightest = 1;
+        summary.heaviest = 1;
+    }
+    g.directed = !g.isSymmetric();
+    g.nonZeros = summary.nonZeros;
+    g.edges = g.directed ? g.nonZeros : g.nonZeros / 2;
+    g.lightest = summary.nonZeros == 0 ? 0 : summary.lightest;
+    g.heaviest = summary.nonZeros == 0 ? 0 : summary.heaviest;
+    *this = move(g);
+}
+
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static const char *skipBlanks(const char *p, const char *end)
+{
+    while (p < end && isBlank(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+// Whether only blanks are left of the line.
+static bool atLineEnd(const char *p, const char *end)
+{
+    return skipBlanks(p, end) == end;
+}
+
+/*
+* @brief
+* This function finds the line that starts at p.
+* @param p - the start of the line.
+* @param end - the end of the text.
+* @param contentEnd - set to the end of the line, without its \n or \r\n.
+* @return const char* - the start of the next line, end if this is the last one.
+*/
+static const char *readLine(const char *p, const char *end, const char *&contentEnd)
+{
+    const char *newline = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    const char *lineEnd = newline == nullptr ? end : newline;
+    contentEnd = lineEnd > p && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+    return newline == nullptr ? end : newline + 1;
+}
+
+/*
+* @brief
+* This function reads an unsigned decimal number, after the blanks before it, that ends at a blank or at the end of the line.
+* @param p - the position, moved past the number.
+* @param end - the end of the line.
+* @param value - set to the number.
+* @return bool - false if there is no such number there, or it does not fit in 64 bits.
+*/
+static bool readNumber(const char *&p, const char *end, uint64_t &value)
+{
+    p = skipBlanks(p, end);
+    const char *start = p;
+    uint64_t number = 0;
+    while (p < end && static_cast<unsigned>(*p - '0') < 10)
+    {
+        uint64_t digit = static_cast<uint64_t>(*p - '0');
+        if (number > (UINT64_MAX - digit) / 10)
+        {
+            return false;
+        }
+        number = number * 10 + digit;
+        p++;
+    }
+    value = number;
+    return p != start && (p == end || isBlank(*p));
+}
+
+/*
+* @brief
+* This function reads a word, after the blanks before it, in lower case.
+* @param p - the position, moved past the word.
+* @param end - the end of the line.
+* @return string - the word, empty at the end of the line.
+*/
+static string readWord(const char *&p, const char *end)
+{
+    p = skipBlanks(p, end);
+    string word;
+    for (; p < end && !isBlank(*p); p++)
+    {
+        word += static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+    }
+    return word;
+}
+
+/*
+* @brief
+* These functions read a weight of type W, after the blanks before it, that ends at a blank or at the end of the line.
+* An integer weight is an optional sign and digits, in the range of W. A floating point weight is anything strtod reads.
+* @param p - the position, moved past the weight.
+* @param end - the end of the line.
+* @param value - set to the weight.
+* @return bool - false if there is no such weight there.
+*/
+template <typename W>
+static bool readWeight(const char *&p, const char *end, W &value, true_type)
+{
+    p = skipBlanks(p, end);
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        p++;
+    }
+    uint64_t magnitude;
+    if (p == end || isBlank(*p) || !readNumber(p, end, magnitude))
+    {
+        return false;
+    }
+    uint64_t limit = negative ? static_cast<uint64_t>(-(numeric_limits<W>::lowest() + 1)) + 1 : static_cast<uint64_t>(numeric_limits<W>::max());
+    if (magnitude > limit)
+    {
+        return false;
+    }
+    // The magnitude of the lowest value is one more than the largest value, so it is negated one less than it.
+    value = negative && magnitude != 0 ? static_cast<W>(-static_cast<int64_t>(magnitude - 1) - 1) : static_cast<W>(magnitude);
+    return true;
+}
+
+template <typename W>
+static bool readWeight(const char *&p, const char *end, W &value, false_type)
+{
+    p = skipBlanks(p, end);
+    // strtod reads until the number ends, which may be past the end of a mapped file, so the number is copied first.
+    char text[64];
+    size_t length = 0;
+    while (p + length < end && !isBlank(p[length]) && length + 1 < sizeof(text))
+    {
+        text[length] = p[length];
+        length++;
+    }
+    if (length == 0 || (p + length < end && !isBlank(p[length])))
+    {
+        return false;
+    }
+    text[length] = '\0';
+    char *parsed;
+    double number = strtod(text, &parsed);
+    if (parsed != text + length)
+    {
+        return false;
+    }
+    value = static_cast<W>(number);
+    p += length;
+    return true;
+}
+
+/*
+* @brief
+* This function returns the error message of a line of a text file: the file, the line number and what is wrong.
+* @param path - the file.
+* @param text - the start of the file.
+* @param line - the start of the line.
+* @param problem - what is wrong with the line.
+* @return string - the message.
+*/
+static string lineError(const string &path, const char *text, const char *line, const string &problem)
+{
+    size_t number = static_cast<size_t>(count(text, line, '\n')) + 1;
+    return path + ":" + to_string(number) + ": " + problem;
+}
+
+/*
+* @brief
+* This function parses the lines from begin to end of a text file into edges. The lines are cut into chunks
+* of about PARSE_CHUNK_BYTES, every chunk is parsed on one of the threads of the library into a list of its own.
+* The lists are not joined: loadEdgeChunks scatters them in the order of the file straight into the sparse rows,
+* releasing each once it is in, so the edges are never held twice and the edge given last in the file is still the last one.
+* @param path - the file, for the error messages.
+* @param text - the start of the file, to count the lines before an error.
+* @param begin, end - the lines to parse.
+* @param parseLine - parses a line without its end of line into the edges, returns what is wrong with it or nullptr.
+* @return vector<vector<Edge>> - the edges of the lines of every chunk, in the order of the file.
+* @throw invalid_argument - with the line number and the problem of the first line that is not valid.
+*/
+template <typename Edge, typename ParseLine>
+static vector<vector<Edge>> parseLines(const string &path, const char *text, const char *begin, const char *end, const ParseLine &parseLine)
+{
+    size_t size = static_cast<size_t>(end - begin);
+    size_t chunks = max(size / PARSE_CHUNK_BYTES, static_cast<size_t>(1));
+    vector<vector<Edge>> chunkEdges(chunks);
+    // The first line of every chunk that is not valid, and what is wrong with it.
+    vector<const char *> errorLines(chunks, nullptr);
+    vector<const char *> errors(chunks, nullptr);
+
+    // The lines of a chunk are those that start in its bytes: it starts after the first end of line from its first byte - 1 on.
+    auto chunkStart = [&](size_t chunk)
+    {
+        if (chunk == 0 || chunk == chunks)
+        {
+            return chunk == 0 ? begin : end;
+        }
+        const char *contentEnd;
+        return readLine(begin + size / chunks * chunk - 1, end, contentEnd);
+    };
+    ariel::ThreadPool::instance().parallelFor(chunks, 0, [&](size_t chunk)
+    {
+        const char *chunkEnd = chunkStart(chunk + 1);
+        vector<Edge> &edges = chunkEdges[chunk];
+        for (const char *p = chunkStart(chunk); p < chunkEnd;)
+        {
+            const char *contentEnd;
+            const char *next = readLine(p, chunkEnd, contentEnd);
+            const char *problem = parseLine(p, contentEnd, edges);
+            if (problem != nullptr)
+            {
+                errorLines[chunk] = p;
+                errors[chunk] = problem;
+                return;
+            }
+            p = next;
+        }
+    });
+
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+        if (errors[chunk] != nullptr)
+        {
+            throw invalid_argument(lineError(path, text, errorLines[chunk], errors[chunk]));
+        }
+    }
+    return chunkEdges;
+}
+
+/*
+* @brief
+* This function returns the most vertices a text file of this size may give a graph, see TEXT_VERTICES_PER_BYTE.
+* @param fileSize - the size of the file in bytes.
+* @return uint64_t - the number of vertices.
+*/
+static uint64_t textVertexLimit(size_t fileSize)
+{
+    return MIN_TEXT_VERTICES + TEXT_VERTICES_PER_BYTE * static_cast<uint64_t>(fileSize);
+}
+
+// A line of an edge list: "u v" or "u v w", vertices from 0 and less than vertices.
+template <typename W>
+struct EdgeListLine
+{
+    uint64_t vertices;
+
+    const char *operator()(const char *p, const char *end, vector<typename BasicGraph<W>::Edge> &edges) const
+    {
+        p = skipBlanks(p, end);
+        if (p == end || *p == '#' || *p == '%')
+        {
+            return nullptr;
+        }
+        uint64_t from, to;
+        W weight = 1;
+        if (!readNumber(p, end, from) || !readNumber(p, end, to))
+        {
+            return "expected an edge \"u v\" or \"u v w\"";
+        }
+        if (from >= this->vertices || to >= this->vertices)
+        {
+            return "the vertex is too large for the size of the file";
+        }
+        if (!atLineEnd(p, end) && !readWeight(p, end, weight, is_integral<W>()))
+        {
+            return "the weight is not a number of the weight type";
+        }
+        if (!atLineEnd(p, end))
+        {
+            return "unexpected text after the edge";
+        }
+        edges.push_back({static_cast<size_t>(from), static_cast<size_t>(to), weight});
+        return nullptr;
+    }
+};
+
+// A line after the problem line of a DIMACS file: "a u v w", vertices from 1, or a comment.
+template <typename W>
+struct DimacsLine
+{
+    uint64_t vertices;
+
+    const char *operator()(const char *p, const char *end, vector<typename BasicGraph<W>::Edge> &edges) const
+    {
+        p = skipBlanks(p, end);
+        if (p == end || *p == 'c')
+        {
+            return nullptr;
+        }
+        if (*p != 'a' || p + 1 == end || !isBlank(p[1]))
+        {
+            return "expected an arc \"a u v w\"";
+        }
+        p++;
+        uint64_t from, to;
+        W weight;
+        if (!readNumber(p, end, from) || !readNumber(p, end, to))
+        {
+            return "expected an arc \"a u v w\"";
+        }
+        if (from == 0 || to == 0 || from > this->vertices || to > this->vertices)
+        {
+            return "the vertex is not one of 1 .. n";
+        }
+        if (!readWeight(p, end, weight, is_integral<W>()))
+        {
+            return "the weight is not a number of the weight type";
+        }
+        if (!atLineEnd(p, end))
+        {
+            return "unexpected text after the arc";
+        }
+        edges.push_back({static_cast<size_t>(from - 1), static_cast<size_t>(to - 1), weight});
+        return nullptr;
+    }
+};
+
+// A line after the size line of a Matrix Market file: "i j v", or "i j" for a pattern, vertices from 1.
+template <typename W>
+struct MatrixMarketLine
+{
+    uint64_t vertices;
+    bool pattern;
+
+    const char *operator()(const char *p, const char *end, vector<typename BasicGraph<W>::Edge> &edges) const
+    {
+        p = skipBlanks(p, end);
+        if (p == end || *p == '%')
+        {
+            return nullptr;
+        }
+        uint64_t row, column;
+        W weight = 1;
+        if (!readNumber(p, end, row) || !readNumber(p, end, column))
+        {
+            return "expected an entry \"i j v\"";
+        }
+        if (row == 0 || column == 0 || row > this->vertices || column > this->vertices)
+        {
+            return "the entry is not inside the matrix";
+        }
+        if (!this->pattern && !readWeight(p, end, weight, is_integral<W>()))
+        {
+            return "the value is not a number of the weight type";
+        }
+        if (!atLineEnd(p, end))
+        {
+            return "unexpected text after the entry";
+        }
+        edges.push_back({static_cast<size_t>(row - 1), static_cast<size_t>(column - 1), weight});
+        return nullptr;
+    }
+};
+
+template <typename W>
+void BasicGraph<W>::loadEdgeList(const string &path, bool directed)
+{
+    size_t fileSize;
+    shared_ptr<const void> mapping = mapFile(path, PROT_READ, fileSize);
+    const char *text = static_cast<const char *>(mapping.get());
+    vector<vector<Edge>> chunks = parseLines<Edge>(path, text, text, text + fileSize, EdgeListLine<W>{textVertexLimit(fileSize)});
+    size_t n = 0;
+    for (const vector<Edge> &chunk : chunks)
+    {
+        for (const Edge &edge : chunk)
+        {
+            n = max(n, max(edge.from, edge.to) + 1);
+        }
+    }
+    this->loadEdgeChunks(n, chunks.data(), chunks.size(), &chunks, directed);
+}
+
+template <typename W>
+void BasicGraph<W>::loadDimacs(const string &path)
+{
+    size_t fileSize;
+    shared_ptr<const void> mapping = mapFile(path, PROT_READ, fileSize);
+    const char *text = static_cast<const char *>(mapping.get());
+    const char *end = text + fileSize;
+
+    // Comments, then the problem line "p sp n m", then the arcs.
+    const char *p = text;
+    uint64_t n = 0, arcs = 0;
+    bool problem = false;
+    while (p < end && !problem)
+    {
+        const char *line = p, *contentEnd;
+        p = readLine(p, end, contentEnd);
+        const char *q = skipBlanks(line, contentEnd);
+        if (q == contentEnd || *q == 'c')
+        {
+            continue;
+        }
+        if (readWord(q, contentEnd) != "p" || readWord(q, contentEnd) != "sp" || !readNumber(q, contentEnd, n) ||
+            !readNumber(q, contentEnd, arcs) || !atLineEnd(q, contentEnd))
+        {
+            throw invalid_argument(lineError(path, text, line, "expected the problem line \"p sp n m\""));
+        }
+        if (n > textVertexLimit(fileSize))
+        {
+            throw invalid_argument(lineError(path, text, line, "the number of vertices is too large for the size of the file"));
+        }
+        problem = true;
+    }
+    if (!problem)
+    {
+        throw invalid_argument("The file " + path + " has no problem line \"p sp n m\".");
+    }
+    vector<vector<Edge>> chunks = parseLines<Edge>(path, text, p, end, DimacsLine<W>{n});
+    this->loadEdgeChunks(static_cast<size_t>(n), chunks.data(), chunks.size(), &chunks, true);
+}
+
+template <typename W>
+void BasicGraph<W>::loadMatrixMarket(const string &path)
+{
+    size_t fileSize;
+    shared_ptr<const void> mapping = mapFile(path, PROT_READ, fileSize);
+    const char *text = static_cast<const char *>(mapping.get());
+    const char *end = text + fileSize;
+
+    // The banner "%%MatrixMarket matrix coordinate field symmetry", its words in any case.
+    const char *contentEnd;
+    const char *p = text == end ? end : readLine(text, end, contentEnd);
+    const char *q = text;
+    if (text == end || readWord(q, contentEnd) != "%%matrixmarket" || readWord(q, contentEnd) != "matrix")
+    {
+        throw invalid_argument(lineError(path, text, text, "expected the banner \"%%MatrixMarket matrix coordinate ...\""));
+    }
+    string format = readWord(q, contentEnd), field = readWord(q, contentEnd), symmetry = readWord(q, contentEnd);
+    if (format != "coordinate")
+    {
+        throw invalid_argument(lineError(path, text, text, "only coordinate matrices are graphs"));
+    }
+    if (field != "integer" && field != "real" && field != "double" && field != "pattern")
+    {
+        throw invalid_argument(lineError(path, text, text, "the field must be integer, real or pattern"));
+    }
+    if ((symmetry != "general" && symmetry != "symmetric") || !atLineEnd(q, contentEnd))
+    {
+        throw invalid_argument(lineError(path, text, text, "the symmetry must be general or symmetric"));
+    }
+
+    // Comments, then the size line "rows columns entries".
+    uint64_t rows = 0, columns = 0, entries = 0;
+    bool size = false;
+    while (p < end && !size)
+    {
+        const char *line = p;
+        p = readLine(p, end, contentEnd);
+        q = skipBlanks(line, contentEnd);
+        if (q == contentEnd || *q == '%')
+        {
+            continue;
+        }
+        if (!readNumber(q, contentEnd, rows) || !readNumber(q, contentEnd, columns) || !readNumber(q, contentEnd, entries) ||
+            !atLineEnd(q, contentEnd))
+        {
+            throw invalid_argument(lineError(path, text, line, "expected the size line \"rows columns entries\""));
+        }
+        if (rows != columns)
+        {
+            throw invalid_argument(lineError(path, text, line, "the matrix of a graph must be square"));
+        }
+        if (rows > textVertexLimit(fileSize))
+        {
+            throw invalid_argument(lineError(path, text, line, "the number of vertices is too large for the size of the file"));
+        }
+        size = true;
+    }
+    if (!size)
+    {
+        throw invalid_argument("The file " + path + " has no size line \"rows columns entries\".");
+    }
+    vector<vector<Edge>> chunks = parseLines<Edge>(path, text, p, end, MatrixMarketLine<W>{rows, field == "pattern"});
+    // A symmetric matrix keeps only the entries on and below the diagonal, each stands for both of its cells.
+    this->loadEdgeChunks(static_cast<size_t>(rows), chunks.data(), chunks.size(), &chunks, symmetry != "symmetric");
+}
+
+// Reading and writing graph files, for graphs of every weight type.
+#define ARIEL_INSTANTIATE_GRAPH_FILE(W)                                          \
+    template void BasicGraph<W>::saveBinary(const string &path) const;          \
+    template void BasicGraph<W>::loadBinary(const string &path);                \
+    template void BasicGraph<W>::loadEdgeList(const string &path, bool directed); \
+    template void BasicGraph<W>::loadDimacs(const string &path);                \
+    template void BasicGraph<W>::loadMatrixMarket(const string &path);
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_GRAPH_FILE)
@@ -0,0 +1,365 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include "GraphGenerator.hpp"
+using ariel::BasicGraph;
+using ariel::GraphGenerator;
+using namespace std;
+
+typedef mt19937_64 Engine;
+
+// A number in [0, 1), from the top 53 bits of the engine.
+static double uniform(Engine &rng)
+{
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// A number in [0, bound), bound > 0. The few values that would make some numbers likelier are drawn again.
+static uint64_t below(Engine &rng, uint64_t bound)
+{
+    uint64_t threshold = (0 - bound) % bound;
+    uint64_t x = rng();
+    while (x < threshold)
+    {
+        x = rng();
+    }
+    return x % bound;
+}
+
+// A weight in [minWeight, maxWeight] other than 0, for integer weights.
+template <typename W>
+static W drawWeight(Engine &rng, W minWeight, W maxWeight, true_type)
+{
+    uint64_t low = static_cast<uint64_t>(static_cast<int64_t>(minWeight));
+    // The number of weights in the range, 0 when it is every int64_t.
+    uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(maxWeight)) - low + 1;
+    W w = 0;
+    while (w == 0)
+    {
+        w = static_cast<W>(static_cast<int64_t>(low + (span == 0 ? rng() : below(rng, span))));
+    }
+    return w;
+}
+
+// A weight in [minWeight, maxWeight] other than 0, for floating point weights.
+template <typename W>
+static W drawWeight(Engine &rng, W minWeight, W maxWeight, false_type)
+{
+    W w = 0;
+    while (w == 0)
+    {
+        w = minWeight == maxWeight ? minWeight : static_cast<W>(minWeight + (maxWeight - minWeight) * uniform(rng));
+    }
+    return w;
+}
+
+template <typename W>
+static W drawWeight(Engine &rng, W minWeight, W maxWeight)
+{
+    return drawWeight(rng, minWeight, maxWeight, is_integral<W>());
+}
+
+/*
+ * @brief
+ * This function picks every cell of a set of rows with probability p, and calls visit(i, c) for the cells picked,
+ * where c is the index of the cell among the candidates(i) cells of row i.
+ * It jumps from a picked cell to the next over a geometric number of cells, so it takes O(rows + cells picked).
+ * @param rows - the number of rows.
+ * @param candidates - the number of cells of every row.
+ * @param p - the probability of every cell.
+ * @param rng - the engine.
+ * @param visit - called for every cell picked, in order.
+ * @return void
+ */
+template <typename Candidates, typename Visit>
+static void sampleCells(size_t rows, Candidates candidates, double p, Engine &rng, Visit visit)
+{
+    if (p <= 0)
+    {
+        return;
+    }
+    double logMiss = log1p(-p);
+    size_t i = 0;
+    uint64_t c = 0;
+    while (true)
+    {
+        if (p < 1)
+        {
+            // The number of cells missed before the next one picked.
+            double skip = floor(log1p(-uniform(rng)) / logMiss);
+            if (skip >= 1e18)
+            {
+                return;
+            }
+            c += static_cast<uint64_t>(skip);
+        }
+        while (i < rows && c >= candidates(i))
+        {
+            c -= candidates(i);
+            i++;
+        }
+        if (i >= rows)
+        {
+            return;
+        }
+        visit(i, c);
+        c++;
+    }
+}
+
+// The vertices in a random order, the first count of them are a random sample.
+static vector<size_t> shuffledVertices(size_t n, size_t count, Engine &rng)
+{
+    vector<size_t> order(n);
+    for (size_t v = 0; v < n; v++)
+    {
+        order[v] = v;
+    }
+    for (size_t k = 0; k < count && k + 1 < n; k++)
+    {
+        swap(order[k], order[k + static_cast<size_t>(below(rng, n - k))]);
+    }
+    return order;
+}
+
+template <typename W>
+void GraphGenerator::checkWeights(W minWeight, W maxWeight)
+{
+    if (minWeight > maxWeight || (minWeight == 0 && maxWeight == 0))
+    {
+        throw invalid_argument("The range of the weights must have a weight other than 0.");
+    }
+}
+
+void GraphGenerator::checkProbability(double p)
+{
+    if (!(p >= 0 && p <= 1))
+    {
+        throw invalid_argument("The probability must be between 0 and 1.");
+    }
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::erdosRenyi(size_t n, double p, bool directed, W minWeight, W maxWeight, uint64_t seed)
+{
+    checkWeights(minWeight, maxWeight);
+    checkProbability(p);
+    Engine rng(seed);
+    vector<typename BasicGraph<W>::Edge> edges;
+    if (directed)
+    {
+        // Row i has the n - 1 cells other than (i, i).
+        sampleCells(n, [n](size_t) { return static_cast<uint64_t>(n - 1); }, p, rng, [&](size_t i, uint64_t c)
+                    { edges.push_back({i, c < i ? c : c + 1, drawWeight(rng, minWeight, maxWeight)}); });
+    }
+    else
+    {
+        // Row i has the cells to the right of the diagonal, every undirected edge once.
+        sampleCells(n, [n](size_t i) { return static_cast<uint64_t>(n - 1 - i); }, p, rng, [&](size_t i, uint64_t c)
+                    { edges.push_back({i, i + 1 + c, drawWeight(rng, minWeight, maxWeight)}); });
+    }
+    BasicGraph<W> g;
+    g.loadEdges(n, edges, directed);
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::barabasiAlbert(size_t n, size_t m, W minWeight, W maxWeight, uint64_t seed)
+{
+    checkWeights(minWeight, maxWeight);
+    if (m == 0)
+    {
+        throw invalid_argument("Every new vertex must have at least one edge.");
+    }
+    Engine rng(seed);
+    vector<typename BasicGraph<W>::Edge> edges;
+    // Every vertex appears once for every edge it has, so a uniform pick from it is proportional to the degree.
+    vector<size_t> endpoints;
+    auto join = [&](size_t u, size_t v)
+    {
+        edges.push_back({u, v, drawWeight(rng, minWeight, maxWeight)});
+        endpoints.push_back(u);
+        endpoints.push_back(v);
+    };
+
+    size_t clique = min(n, m + 1);
+    for (size_t u = 0; u < clique; u++)
+    {
+        for (size_t v = u + 1; v < clique; v++)
+        {
+            join(u, v);
+        }
+    }
+    vector<size_t> targets;
+    for (size_t v = clique; v < n; v++)
+    {
+        // The clique has m + 1 vertices, so there are always m different ones to pick.
+        targets.clear();
+        while (targets.size() < m)
+        {
+            size_t t = endpoints[static_cast<size_t>(below(rng, endpoints.size()))];
+            if (find(targets.begin(), targets.end(), t) == targets.end())
+            {
+                targets.push_back(t);
+            }
+        }
+        for (size_t t : targets)
+        {
+            join(v, t);
+        }
+    }
+    BasicGraph<W> g;
+    g.loadEdges(n, edges, false);
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::rmat(size_t scale, size_t edgeFactor, double a, double b, double c, bool directed, W minWeight, W maxWeight, uint64_t seed)
+{
+    checkWeights(minWeight, maxWeight);
+    checkProbability(a);
+    checkProbability(b);
+    checkProbability(c);
+    if (a + b + c > 1 || scale > 30)
+    {
+        throw invalid_argument("The quarters must have probabilities that sum to at most 1, and the scale must be at most 30.");
+    }
+    Engine rng(seed);
+    size_t n = static_cast<size_t>(1) << scale;
+    vector<typename BasicGraph<W>::Edge> edges;
+    edges.reserve(edgeFactor * n);
+    for (size_t e = 0; e < edgeFactor * n; e++)
+    {
+        // One bit of the row and one of the column at every level, from the highest.
+        size_t u = 0, v = 0;
+        for (size_t level = 0; level < scale; level++)
+        {
+            double r = uniform(rng);
+            size_t down = r >= a + b ? 1 : 0;
+            size_t right = (r >= a && r < a + b) || r >= a + b + c ? 1 : 0;
+            u = 2 * u + down;
+            v = 2 * v + right;
+        }
+        W w = drawWeight(rng, minWeight, maxWeight);
+        if (u != v)
+        {
+            edges.push_back({u, v, w});
+        }
+    }
+    BasicGraph<W> g;
+    g.loadEdges(n, edges, directed);
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::grid(size_t rows, size_t columns, W minWeight, W maxWeight, uint64_t seed)
+{
+    checkWeights(minWeight, maxWeight);
+    Engine rng(seed);
+    vector<typename BasicGraph<W>::Edge> edges;
+    for (size_t r = 0; r < rows; r++)
+    {
+        for (size_t c = 0; c < columns; c++)
+        {
+            size_t v = r * columns + c;
+            if (c + 1 < columns)
+            {
+                edges.push_back({v, v + 1, drawWeight(rng, minWeight, maxWeight)});
+            }
+            if (r + 1 < rows)
+            {
+                edges.push_back({v, v + columns, drawWeight(rng, minWeight, maxWeight)});
+            }
+        }
+    }
+    BasicGraph<W> g;
+    g.loadEdges(rows * columns, edges, false);
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::path(size_t n, bool directed, W minWeight, W maxWeight, uint64_t seed)
+{
+    checkWeights(minWeight, maxWeight);
+    Engine rng(seed);
+    vector<typename BasicGraph<W>::Edge> edges;
+    for (size_t v = 0; v + 1 < n; v++)
+    {
+        edges.push_back({v, v + 1, drawWeight(rng, minWeight, maxWeight)});
+    }
+    BasicGraph<W> g;
+    g.loadEdges(n, edges, directed);
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::acyclic(size_t n, double p, W minWeight, W maxWeight, uint64_t seed)
+{
+    checkWeights(minWeight, maxWeight);
+    checkProbability(p);
+    Engine rng(seed);
+    vector<size_t> order = shuffledVertices(n, n, rng);
+    vector<typename BasicGraph<W>::Edge> edges;
+    // Only edges from a vertex to a later one in the order, so no edge closes a cycle.
+    sampleCells(n, [n](size_t i) { return static_cast<uint64_t>(n - 1 - i); }, p, rng, [&](size_t i, uint64_t c)
+                { edges.push_back({order[i], order[i + 1 + c], drawWeight(rng, minWeight, maxWeight)}); });
+    BasicGraph<W> g;
+    g.loadEdges(n, edges, true);
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::bipartite(size_t left, size_t right, double p, W minWeight, W maxWeight, uint64_t seed)
+{
+    checkWeights(minWeight, maxWeight);
+    checkProbability(p);
+    Engine rng(seed);
+    vector<typename BasicGraph<W>::Edge> edges;
+    sampleCells(left, [right](size_t) { return static_cast<uint64_t>(right); }, p, rng, [&](size_t i, uint64_t c)
+                { edges.push_back({i, left + c, drawWeight(rng, minWeight, maxWeight)}); });
+    BasicGraph<W> g;
+    g.loadEdges(left + right, edges, false);
+    return g;
+}
+
+template <typename W>
+BasicGraph<W> GraphGenerator::negativeCycle(size_t n, double p, size_t cycleLength, W maxWeight, uint64_t seed)
+{
+    if (cycleLength < 2 || cycleLength > n)
+    {
+        throw invalid_argument("The cycle must have 2 to n vertices.");
+    }
+    checkWeights(static_cast<W>(1), maxWeight);
+    checkProbability(p);
+    Engine rng(seed);
+    vector<typename BasicGraph<W>::Edge> edges;
+    sampleCells(n, [n](size_t) { return static_cast<uint64_t>(n - 1); }, p, rng, [&](size_t i, uint64_t c)
+                { edges.push_back({i, c < i ? c : c + 1, drawWeight(rng, static_cast<W>(1), maxWeight)}); });
+    // Given last, the edges of the cycle replace the random edges between the same vertices.
+    vector<size_t> cycle = shuffledVertices(n, cycleLength, rng);
+    for (size_t k = 0; k < cycleLength; k++)
+    {
+        edges.push_back({cycle[k], cycle[(k + 1) % cycleLength], static_cast<W>(-1)});
+    }
+    BasicGraph<W> g;
+    g.loadEdges(n, edges, true);
+    return g;
+}
+
+// The generators of graphs of every weight type.
+#define ARIEL_INSTANTIATE_GENERATOR(W)                                                                                                  \
+    template BasicGraph<W> GraphGenerator::erdosRenyi(size_t n, double p, bool directed, W minWeight, W maxWeight, uint64_t seed);     \
+    template BasicGraph<W> GraphGenerator::barabasiAlbert(size_t n, size_t m, W minWeight, W maxWeight, uint64_t seed);                \
+    template BasicGraph<W> GraphGenerator::rmat(size_t scale, size_t edgeFactor, double a, double b, double c, bool directed,          \
+                                                W minWeight, W maxWeight, uint64_t seed);                                              \
+    template BasicGraph<W> GraphGenerator::grid(size_t rows, size_t columns, W minWeight, W maxWeight, uint64_t seed);                 \
+    template BasicGraph<W> GraphGenerator::path(size_t n, bool directed, W minWeight, W maxWeight, uint64_t seed);                     \
+    template BasicGraph<W> GraphGenerator::acyclic(size_t n, double p, W minWeight, W maxWeight, uint64_t seed);                       \
+    template BasicGraph<W> GraphGenerator::bipartite(size_t left, size_t right, double p, W minWeight, W maxWeight, uint64_t seed);   \
+    template BasicGraph<W> GraphGenerator::negativeCycle(size_t n, double p, size_t cycleLength, W maxWeight, uint64_t seed);
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_GENERATOR)
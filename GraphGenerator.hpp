@@ -0,0 +1,161 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _GRAPH_GENERATOR_HPP_
+#define _GRAPH_GENERATOR_HPP_
+
+#include <cstdint>
+#include <vector>
+#include "Graph.hpp"
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * Random graphs for tests and benchmarks, the same graph for the same arguments and seed on every platform:
+    * the random numbers come from mt19937_64 and are turned into weights and probabilities here,
+    * not by the distributions of the standard library, which differ between implementations.
+    * The graphs are loaded from their edges (BasicGraph::loadEdges), without building an adjacency matrix,
+    * and every edge gets a random weight in [minWeight, maxWeight] other than 0.
+    */
+    class GraphGenerator
+    {
+    private:
+        /*
+        * @brief
+        * This function checks that there is a weight other than 0 in [minWeight, maxWeight].
+        * @throw invalid_argument - if minWeight > maxWeight or both are 0.
+        */
+        template <typename W>
+        static void checkWeights(W minWeight, W maxWeight);
+
+        /*
+        * @brief
+        * This function checks that a probability is in [0, 1].
+        * @throw invalid_argument - if it is not.
+        */
+        static void checkProbability(double p);
+
+    public:
+        /*
+        * @brief
+        * This function generates an Erdős–Rényi graph G(n, p): every possible edge, without loops, is in the graph with probability p.
+        * The edges are found by skipping a geometric number of pairs at a time, so it takes O(V + E), not O(V^2).
+        * @param n - number of vertices.
+        * @param p - the probability of every edge.
+        * @param directed - true for edges u -> v and v -> u of their own, false for undirected edges.
+        * @param minWeight, maxWeight - the range of the weights.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if n is 0, p is not a probability or the range has no weight other than 0.
+        */
+        template <typename W>
+        static BasicGraph<W> erdosRenyi(size_t n, double p, bool directed, W minWeight, W maxWeight, uint64_t seed);
+
+        /*
+        * @brief
+        * This function generates an undirected Barabási–Albert graph: the first m + 1 vertices form a clique,
+        * then every vertex joins m different earlier vertices, picked with probability proportional to their degree.
+        * @param n - number of vertices.
+        * @param m - the number of edges of every new vertex.
+        * @param minWeight, maxWeight - the range of the weights.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if n or m is 0, or the range has no weight other than 0.
+        */
+        template <typename W>
+        static BasicGraph<W> barabasiAlbert(size_t n, size_t m, W minWeight, W maxWeight, uint64_t seed);
+
+        /*
+        * @brief
+        * This function generates an R-MAT (recursive Kronecker) graph of 2^scale vertices: every edge picks one quarter
+        * of the matrix with probabilities a, b, c and 1 - a - b - c, then a quarter of that quarter, scale times.
+        * The same edge may be picked more than once, and loops are dropped, so the graph has at most edgeFactor * 2^scale edges.
+        * a = 0.57, b = c = 0.19 are the parameters of Graph500.
+        * @param scale - the log2 of the number of vertices, at most 30.
+        * @param edgeFactor - the number of edges picked per vertex.
+        * @param a, b, c - the probabilities of the top left, top right and bottom left quarters.
+        * @param directed - true for a directed graph, false for undirected edges.
+        * @param minWeight, maxWeight - the range of the weights.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if scale is above 30, a, b, c are not probabilities that sum to at most 1,
+        * or the range has no weight other than 0.
+        */
+        template <typename W>
+        static BasicGraph<W> rmat(size_t scale, size_t edgeFactor, double a, double b, double c, bool directed, W minWeight, W maxWeight, uint64_t seed);
+
+        /*
+        * @brief
+        * This function generates an undirected grid of rows x columns vertices, every vertex joined to the ones beside,
+        * above and below it. Vertex r * columns + c is in row r and column c.
+        * @param rows, columns - the size of the grid.
+        * @param minWeight, maxWeight - the range of the weights.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if the grid has no vertices, or the range has no weight other than 0.
+        */
+        template <typename W>
+        static BasicGraph<W> grid(size_t rows, size_t columns, W minWeight, W maxWeight, uint64_t seed);
+
+        /*
+        * @brief
+        * This function generates the path 0 - 1 - ... - (n - 1).
+        * @param n - number of vertices.
+        * @param directed - true for edges i -> i + 1 only, false for undirected edges.
+        * @param minWeight, maxWeight - the range of the weights.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if n is 0, or the range has no weight other than 0.
+        */
+        template <typename W>
+        static BasicGraph<W> path(size_t n, bool directed, W minWeight, W maxWeight, uint64_t seed);
+
+        /*
+        * @brief
+        * This function generates a directed acyclic graph: the vertices are put in a random order,
+        * and every edge from a vertex to a later one in the order is in the graph with probability p.
+        * @param n - number of vertices.
+        * @param p - the probability of every edge.
+        * @param minWeight, maxWeight - the range of the weights.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if n is 0, p is not a probability or the range has no weight other than 0.
+        */
+        template <typename W>
+        static BasicGraph<W> acyclic(size_t n, double p, W minWeight, W maxWeight, uint64_t seed);
+
+        /*
+        * @brief
+        * This function generates an undirected bipartite graph: vertices 0 .. left - 1 on one side, the rest on the other,
+        * and every edge between the sides is in the graph with probability p.
+        * @param left, right - the number of vertices on every side.
+        * @param p - the probability of every edge.
+        * @param minWeight, maxWeight - the range of the weights.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if the graph has no vertices, p is not a probability or the range has no weight other than 0.
+        */
+        template <typename W>
+        static BasicGraph<W> bipartite(size_t left, size_t right, double p, W minWeight, W maxWeight, uint64_t seed);
+
+        /*
+        * @brief
+        * This function generates a directed Erdős–Rényi graph with weights 1 .. maxWeight and plants a negative cycle in it:
+        * cycleLength different random vertices joined in a cycle of edges of weight -1, which replace the edges between them.
+        * Every other edge is positive, so every negative cycle of the graph goes through the planted edges.
+        * @param n - number of vertices.
+        * @param p - the probability of every edge.
+        * @param cycleLength - the number of vertices of the cycle, 2 .. n.
+        * @param maxWeight - the heaviest weight of the other edges, at least 1.
+        * @param seed - the seed of the generator.
+        * @return BasicGraph<W> - the graph.
+        * @throw invalid_argument - if cycleLength is not in 2 .. n, p is not a probability or maxWeight is below 1.
+        */
+        template <typename W>
+        static BasicGraph<W> negativeCycle(size_t n, double p, size_t cycleLength, W maxWeight, uint64_t seed);
+    };
+}
+
+#endif
@@ -0,0 +1,1252 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include "Graph.hpp"
+#include "Algorithms.hpp"
+#include "AllPairsPaths.hpp"
+#include "BenchmarkHarness.hpp"
+#include "DisjointSet.hpp"
+#include "GraphGenerator.hpp"
+#include "ReachabilityIndex.hpp"
+#include "StronglyConnectedComponents.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+using ariel::Algorithms;
+using ariel::BenchmarkHarness;
+using ariel::BenchmarkState;
+using ariel::Graph;
+using ariel::GraphGenerator;
+
+/*
+ * Every public operator of Graph and every entry point of Algorithms, over sizes from 16 to 16384 vertices
+ * and a sparse and a dense density, and the main ones again on the vector<vector<int>> graph the library started from. The options are listed in BenchmarkHarness::parseArguments,
+ * by default the cases up to 1024 vertices run, --max-vertices 16384 runs them all.
+ */
+
+typedef vector<vector<int>> Matrix;
+
+// Keeps the compiler from optimizing the measured work away.
+static volatile size_t sink = 0;
+
+static const vector<size_t> ALL_SIZES = {16, 64, 256, 1024, 4096, 16384};
+// The sizes of the operations that take O(V^3) on a dense graph.
+static const vector<size_t> CUBIC_SIZES = {16, 64, 256, 1024};
+// The sizes of the graph product, up to 8192 vertices, and those the i-j-k product it is compared with still finishes at.
+static const vector<size_t> PRODUCT_SIZES = {16, 64, 256, 512, 1024, 2048, 4096, 8192};
+static const vector<size_t> NAIVE_PRODUCT_SIZES = {16, 64, 256, 512, 1024, 2048};
+// Sparse storage and dense storage.
+static const vector<double> DENSITIES = {0.01, 0.5};
+static const vector<double> SPARSE_DENSITY = {0.01};
+static const vector<double> DENSE_DENSITY = {0.5};
+// The number of queries answered by one iteration of the query cases.
+static const size_t QUERIES = 10000;
+// The files the graph file formats are measured with.
+static const char *const BINARY_PATH = "microbench_graph.bin";
+static const char *const TEXT_PATH = "microbench_graph.txt";
+
+// The shape of a random input graph, generated by GraphGenerator with weights 1 to 9.
+enum class Shape
+{
+    // Every possible edge is in the graph with the probability of the density.
+    Directed,
+    // Only edges from a vertex to a later one in a random order, so the graph has no cycle and a search for one visits all of it.
+    Acyclic,
+    // Undirected, with edges only between the two halves of the vertices, so coloring it visits all of it.
+    Bipartite,
+    // Every possible edge is in both directions with the probability of the density.
+    Undirected,
+    // Undirected, every edge of weight 1, so the graph is kept in bitset storage when it is enabled.
+    Unweighted
+};
+
+static Graph randomGraph(const BenchmarkState &state, Shape shape, uint64_t seed)
+{
+    size_t n = state.getVertices();
+    double density = state.getDensity();
+    if (shape == Shape::Acyclic)
+    {
+        return GraphGenerator::acyclic(n, density, 1, 9, seed);
+    }
+    if (shape == Shape::Bipartite)
+    {
+        return GraphGenerator::bipartite(n / 2, n - n / 2, density, 1, 9, seed);
+    }
+    if (shape == Shape::Undirected || shape == Shape::Unweighted)
+    {
+        return GraphGenerator::erdosRenyi(n, density, false, 1, shape == Shape::Unweighted ? 1 : 9, seed);
+    }
+    return GraphGenerator::erdosRenyi(n, density, true, 1, 9, seed);
+}
+
+// The text formats Graph loads edges from.
+enum class TextFormat
+{
+    EdgeList,
+    Dimacs,
+    MatrixMarket
+};
+
+// Writes the edges of a graph to a text file in the format, and returns the size of the file.
+static size_t writeText(const Graph &g, TextFormat format, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        throw invalid_argument(string("Cannot create the file ") + path);
+    }
+    size_t n = g.getVertices();
+    if (format == TextFormat::Dimacs)
+    {
+        fprintf(file, "p sp %zu %zu\n", n, g.getEdges());
+    }
+    else if (format == TextFormat::MatrixMarket)
+    {
+        fprintf(file, "%%%%MatrixMarket matrix coordinate integer general\n%zu %zu %zu\n", n, n, g.getEdges());
+    }
+    // The edge list counts the vertices from 0, the other formats from 1.
+    size_t first = format == TextFormat::EdgeList ? 0 : 1;
+    const char *prefix = format == TextFormat::Dimacs ? "a " : "";
+    for (size_t i = 0; i < n; i++)
+    {
+        for (Graph::Neighbour neighbour : g.neighbours(i))
+        {
+            fprintf(file, "%s%zu %zu %d\n", prefix, i + first, neighbour.vertex + first, neighbour.weight);
+        }
+    }
+    size_t size = static_cast<size_t>(ftell(file));
+    fclose(file);
+    return size;
+}
+
+// A stream buffer that drops what is written to it.
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// Sends cout nowhere while it lives, for the functions that print, so their output does not mix with the table.
+class SilenceOutput
+{
+private:
+    NullBuffer discard;
+    streambuf *saved;
+
+public:
+    SilenceOutput() : saved(cout.rdbuf(&this->discard)) {}
+    ~SilenceOutput() { cout.rdbuf(this->saved); }
+};
+
+// Sets the storage graphs are kept in while it lives, for the graphs built and computed in a case, and restores the settings after.
+class StorageSettings
+{
+private:
+    double sparseThreshold;
+    bool bitsetStorage;
+    bool symmetricStorage;
+
+public:
+    StorageSettings(double sparse, bool bitset, bool symmetric)
+        : sparseThreshold(Graph::getSparseThreshold()), bitsetStorage(Graph::getBitsetStorage()), symmetricStorage(Graph::getSymmetricStorage())
+    {
+        Graph::setSparseThreshold(sparse);
+        Graph::setBitsetStorage(bitset);
+        Graph::setSymmetricStorage(symmetric);
+    }
+    StorageSettings(const StorageSettings &) = delete;
+    StorageSettings &operator=(const StorageSettings &) = delete;
+    ~StorageSettings()
+    {
+        Graph::setSparseThreshold(this->sparseThreshold);
+        Graph::setBitsetStorage(this->bitsetStorage);
+        Graph::setSymmetricStorage(this->symmetricStorage);
+    }
+};
+
+// A reachability query without the index: breadth first search from src until dest is found.
+static bool searchReachable(const Graph &g, size_t src, size_t dest)
+{
+    vector<bool> seen(g.getVertices(), false);
+    vector<size_t> queue(1, src);
+    seen[src] = true;
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        if (queue[head] == dest)
+        {
+            return true;
+        }
+        for (Graph::Neighbour neighbour : g.neighbours(queue[head]))
+        {
+            if (!seen[neighbour.vertex])
+            {
+                seen[neighbour.vertex] = true;
+                queue.push_back(neighbour.vertex);
+            }
+        }
+    }
+    return false;
+}
+
+// The vector<vector<int>> graph the library started from, every row of the matrix a heap allocation of its own,
+// kept as the baseline of the (legacy) cases.
+// Results went through loadGraph, which took the matrix by value, copied it again and scanned it twice.
+struct LegacyGraph
+{
+    Matrix adjancencyMatrix;
+    bool directed = false;
+    size_t edges = 0;
+
+    void loadGraph(Matrix graph)
+    {
+        this->adjancencyMatrix = graph;
+        this->directed = this->isDirected();
+        this->edges = this->countEdges();
+    }
+
+    bool isDirected() const
+    {
+        size_t n = this->adjancencyMatrix.size();
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                if (this->adjancencyMatrix[i][j] != this->adjancencyMatrix[j][i])
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    size_t countEdges() const
+    {
+        size_t n = this->adjancencyMatrix.size();
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                if (this->adjancencyMatrix[i][j] != 0)
+                {
+                    count++;
+                }
+            }
+        }
+        return this->directed ? count : count / 2;
+    }
+};
+
+static LegacyGraph legacyAdd(const LegacyGraph &g1, const LegacyGraph &g2)
+{
+    size_t n = g1.adjancencyMatrix.size();
+    Matrix sum(n, vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            sum[i][j] = g1.adjancencyMatrix[i][j] + g2.adjancencyMatrix[i][j];
+        }
+    }
+    LegacyGraph g;
+    g.loadGraph(sum);
+    return g;
+}
+
+static void legacyAddAssign(LegacyGraph &g1, const LegacyGraph &g2)
+{
+    size_t n = g1.adjancencyMatrix.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            g1.adjancencyMatrix[i][j] += g2.adjancencyMatrix[i][j];
+        }
+    }
+    g1.edges = g1.countEdges();
+}
+
+static LegacyGraph legacyMultiply(const LegacyGraph &g1, const LegacyGraph &g2)
+{
+    size_t n = g1.adjancencyMatrix.size();
+    Matrix product(n, vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            for (size_t k = 0; k < n; k++)
+            {
+                product[i][j] += g1.adjancencyMatrix[i][k] * g2.adjancencyMatrix[k][j];
+            }
+        }
+    }
+    LegacyGraph g;
+    g.loadGraph(product);
+    return g;
+}
+
+static bool legacyEquals(const LegacyGraph &g1, const LegacyGraph &g2)
+{
+    size_t n = g1.adjancencyMatrix.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            if (g1.adjancencyMatrix[i][j] != g2.adjancencyMatrix[i][j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The previous Floyd-Warshall: nested vectors and a branch on INF in the inner loop.
+static void legacyFloydWarshall(const LegacyGraph &g, Matrix &dist, Matrix &next)
+{
+    const int inf = 99999;
+    size_t n = g.adjancencyMatrix.size();
+    dist.assign(n, vector<int>(n, inf));
+    next.assign(n, vector<int>(n, -1));
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            if (g.adjancencyMatrix[i][j] != 0)
+            {
+                dist[i][j] = g.adjancencyMatrix[i][j];
+                next[i][j] = static_cast<int>(j);
+            }
+        }
+    }
+    for (size_t k = 0; k < n; k++)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                if (dist[i][j] > dist[i][k] + dist[k][j] && dist[k][j] != inf && dist[i][k] != inf)
+                {
+                    dist[i][j] = dist[i][k] + dist[k][j];
+                    next[i][j] = next[i][k];
+                }
+            }
+        }
+    }
+}
+
+// The previous shortestPath: Floyd-Warshall over the whole graph, for a single pair of vertices.
+static string legacyShortestPath(const LegacyGraph &g, size_t src, size_t dest)
+{
+    Matrix dist, next;
+    legacyFloydWarshall(g, dist, next);
+    if (dist[src][dest] == 99999)
+    {
+        return "-1";
+    }
+    string path = to_string(src);
+    while (src != dest)
+    {
+        src = static_cast<size_t>(next[src][dest]);
+        path += "->" + to_string(src);
+    }
+    return path;
+}
+
+// The previous operator* kernel: i-j-k over the contiguous matrices, walking down the columns of b.
+static int naiveMultiply(const vector<int> &a, const vector<int> &b, size_t n)
+{
+    vector<int> c(n * n);
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            int sum = 0;
+            for (size_t k = 0; k < n; k++)
+            {
+                sum += a[i * n + k] * b[k * n + j];
+            }
+            c[i * n + j] = sum;
+        }
+    }
+    return c[n * n - 1];
+}
+
+// The thread counts the parallel kernels are measured on: 1, 2, 4, ... and every hardware thread.
+static vector<size_t> threadCounts()
+{
+    size_t hardwareThreads = max(thread::hardware_concurrency(), 1u);
+    vector<size_t> counts;
+    for (size_t threads = 1; threads < hardwareThreads; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+    counts.push_back(hardwareThreads);
+    return counts;
+}
+
+// Drops the results the graph keeps, outside the measured time, so the next call computes them again.
+static void dropResults(BenchmarkState &state, Graph &g)
+{
+    state.pauseTiming();
+    g *= 1;
+    state.resumeTiming();
+}
+
+static void addGraphBenchmarks(BenchmarkHarness &harness)
+{
+    harness.add("loadGraph(copy)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Matrix m = randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix();
+        Graph g;
+        while (state.keepRunning())
+        {
+            g.loadGraph(m);
+            sink += g.getEdges();
+        }
+    });
+    harness.add("loadGraph(move)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Matrix m = randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix();
+        Graph g;
+        while (state.keepRunning())
+        {
+            state.pauseTiming();
+            Matrix copy = m;
+            state.resumeTiming();
+            g.loadGraph(move(copy));
+            sink += g.getEdges();
+        }
+    });
+    harness.add("printGraph", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        SilenceOutput silence;
+        while (state.keepRunning())
+        {
+            g.printGraph();
+        }
+    });
+    harness.add("loadEdges", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        size_t n = state.getVertices();
+        Graph source = randomGraph(state, Shape::Directed, 1);
+        vector<Graph::Edge> edges;
+        for (size_t i = 0; i < n; i++)
+        {
+            for (Graph::Neighbour neighbour : source.neighbours(i))
+            {
+                edges.push_back({i, neighbour.vertex, neighbour.weight});
+            }
+        }
+        Graph g;
+        while (state.keepRunning())
+        {
+            g.loadEdges(n, edges, true);
+            sink += g.getEdges();
+        }
+    });
+    // The file is in the page cache, so loading it measures mapping it and checking its arrays.
+    harness.add("saveBinary", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            g.saveBinary(BINARY_PATH);
+        }
+        remove(BINARY_PATH);
+    });
+    harness.add("loadBinary", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        randomGraph(state, Shape::Directed, 1).saveBinary(BINARY_PATH);
+        Graph g;
+        while (state.keepRunning())
+        {
+            g.loadBinary(BINARY_PATH);
+            sink += g.getEdges();
+        }
+        remove(BINARY_PATH);
+    });
+    // The text formats report the MB/s they are parsed at, on the threads set by --threads.
+    harness.add("loadEdgeList", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        state.setBytesProcessed(writeText(randomGraph(state, Shape::Directed, 1), TextFormat::EdgeList, TEXT_PATH));
+        Graph g;
+        while (state.keepRunning())
+        {
+            g.loadEdgeList(TEXT_PATH, true);
+            sink += g.getEdges();
+        }
+        remove(TEXT_PATH);
+    });
+    harness.add("loadDimacs", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        state.setBytesProcessed(writeText(randomGraph(state, Shape::Directed, 1), TextFormat::Dimacs, TEXT_PATH));
+        Graph g;
+        while (state.keepRunning())
+        {
+            g.loadDimacs(TEXT_PATH);
+            sink += g.getEdges();
+        }
+        remove(TEXT_PATH);
+    });
+    harness.add("loadMatrixMarket", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        state.setBytesProcessed(writeText(randomGraph(state, Shape::Directed, 1), TextFormat::MatrixMarket, TEXT_PATH));
+        Graph g;
+        while (state.keepRunning())
+        {
+            g.loadMatrixMarket(TEXT_PATH);
+            sink += g.getEdges();
+        }
+        remove(TEXT_PATH);
+    });
+    harness.add("erdosRenyi", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        uint64_t seed = 0;
+        while (state.keepRunning())
+        {
+            sink += GraphGenerator::erdosRenyi(state.getVertices(), state.getDensity(), true, 1, 9, seed++).getEdges();
+        }
+    });
+    harness.add("getAdjacencyMatrix", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g.getAdjacencyMatrix().size();
+        }
+    });
+    harness.add("getTranspose", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g.getTranspose().size();
+        }
+    });
+    harness.add("transposed", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g.transposed().getEdges();
+        }
+    });
+    harness.add("countEdges", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g.countEdges();
+        }
+    });
+    harness.add("getEdgesSet", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g.getEdgesSet().size();
+        }
+    });
+    harness.add("getVerticesSet", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g.getVerticesSet().size();
+        }
+    });
+    harness.add("getWeight", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        size_t n = g.getVertices();
+        while (state.keepRunning())
+        {
+            int total = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                for (size_t j = 0; j < n; j++)
+                {
+                    total += g.getWeight(i, j);
+                }
+            }
+            sink += static_cast<size_t>(total);
+        }
+    });
+    harness.add("neighbours", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        size_t n = g.getVertices();
+        while (state.keepRunning())
+        {
+            int total = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                for (Graph::Neighbour neighbour : g.neighbours(i))
+                {
+                    total += neighbour.weight;
+                }
+            }
+            sink += static_cast<size_t>(total);
+        }
+    });
+    harness.add("getAllPairsPaths", CUBIC_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            dropResults(state, g);
+            sink += static_cast<size_t>(g.getAllPairsPaths()->getDistance(0, g.getVertices() - 1));
+        }
+    });
+    harness.add("getReachability", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            dropResults(state, g);
+            sink += g.getReachability()->reachable(0, g.getVertices() - 1);
+        }
+    });
+    harness.add("getConnectivity", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Bipartite, 1);
+        while (state.keepRunning())
+        {
+            dropResults(state, g);
+            sink += g.getConnectivity()->getSetCount();
+        }
+    });
+}
+
+static void addOperatorBenchmarks(BenchmarkHarness &harness)
+{
+    // The weights of the graphs changed in place stay small: they are added to at most once per iteration,
+    // or multiplied and divided by -1.
+    harness.add("operator+=", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            g1 += g2;
+            sink += g1.getEdges();
+        }
+    });
+    harness.add("operator-=", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            g1 -= g2;
+            sink += g1.getEdges();
+        }
+    });
+    harness.add("operator+(unary)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += (+g).getEdges();
+        }
+    });
+    harness.add("operator-(unary)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += (-g).getEdges();
+        }
+    });
+    harness.add("operator++(prefix)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += (++g).getEdges();
+        }
+    });
+    harness.add("operator++(postfix)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += (g++).getEdges();
+        }
+    });
+    harness.add("operator--(prefix)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += (--g).getEdges();
+        }
+    });
+    harness.add("operator--(postfix)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += (g--).getEdges();
+        }
+    });
+    harness.add("operator+", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            Graph sum = g1 + g2;
+            sink += sum.getEdges();
+        }
+    });
+    harness.add("operator-", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            Graph difference = g1 - g2;
+            sink += difference.getEdges();
+        }
+    });
+    harness.add("operator*(scalar)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            Graph scaled = g * 3;
+            sink += scaled.getEdges();
+        }
+    });
+    harness.add("operator*=", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            g *= -1;
+            sink += g.getEdges();
+        }
+    });
+    harness.add("operator/=", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            g /= -1;
+            sink += g.getEdges();
+        }
+    });
+    harness.add("operator*", PRODUCT_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            Graph product = g1 * g2;
+            sink += product.getEdges();
+        }
+    });
+    // Equal graphs, so the comparison reads every cell.
+    harness.add("operator==", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g1 == g2;
+        }
+    });
+    harness.add("operator!=", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += g1 != g2;
+        }
+    });
+    // g1 is a subgraph of g2, so the check reads every edge of g1.
+    harness.add("operator<", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = g1 + randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            sink += g1 < g2;
+        }
+    });
+    harness.add("operator<=", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = g1 + randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            sink += g1 <= g2;
+        }
+    });
+    harness.add("operator>", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = g1 + randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            sink += g2 > g1;
+        }
+    });
+    harness.add("operator>=", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = g1 + randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            sink += g2 >= g1;
+        }
+    });
+    harness.add("operator<<", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        size_t bytes = 0;
+        while (state.keepRunning())
+        {
+            ostringstream out;
+            out << g;
+            bytes = out.str().size();
+            sink += bytes;
+        }
+        state.setBytesProcessed(bytes);
+    });
+    harness.add("writeMatrix", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        ostringstream out;
+        out << g;
+        int descriptor = open("/dev/null", O_WRONLY);
+        while (state.keepRunning())
+        {
+            g.writeMatrix(descriptor);
+            sink++;
+        }
+        close(descriptor);
+        state.setBytesProcessed(out.str().size());
+    });
+}
+
+static void addAlgorithmBenchmarks(BenchmarkHarness &harness)
+{
+    harness.add("isConnected", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += static_cast<size_t>(Algorithms::isConnected(g));
+        }
+    });
+    harness.add("stronglyConnectedComponents", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += Algorithms::stronglyConnectedComponents(g).getComponentCount();
+        }
+    });
+    harness.add("shortestPath", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        size_t n = g.getVertices();
+        while (state.keepRunning())
+        {
+            sink += Algorithms::shortestPath(g, 0, n - 1).size();
+        }
+    });
+    harness.add("isContainsCycle", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Acyclic, 1);
+        SilenceOutput silence;
+        while (state.keepRunning())
+        {
+            sink += Algorithms::isContainsCycle(g);
+        }
+    });
+    harness.add("isBipartite", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Bipartite, 1);
+        while (state.keepRunning())
+        {
+            sink += Algorithms::isBipartite(g).size();
+        }
+    });
+    harness.add("negativeCycle", CUBIC_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            dropResults(state, g);
+            sink += Algorithms::negativeCycle(g).size();
+        }
+    });
+}
+
+// The same operation on the storages, weight types, thread counts and ways of answering queries the library chooses between.
+// The case without a variant in its name is the one the library picks by default, measured above.
+static void addComparisonBenchmarks(BenchmarkHarness &harness)
+{
+    // One pass over the cells of all three operands, against a temporary graph for every operator.
+    harness.add("g1+g2-g3*2(expression)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        Graph g3 = randomGraph(state, Shape::Directed, 3);
+        while (state.keepRunning())
+        {
+            Graph result = g1 + g2 - g3 * 2;
+            sink += result.getEdges();
+        }
+    });
+    harness.add("g1+g2-g3*2(temporaries)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        Graph g3 = randomGraph(state, Shape::Directed, 3);
+        while (state.keepRunning())
+        {
+            Graph sum = g1 + g2;
+            Graph scaled = g3 * 2;
+            Graph result = sum - scaled;
+            sink += result.getEdges();
+        }
+    });
+
+    // Sparse graphs kept in dense storage, against the sparse rows they are kept in by default.
+    harness.add("isConnected(dense storage)", ALL_SIZES, SPARSE_DENSITY, [](BenchmarkState &state)
+    {
+        StorageSettings settings(0, false, false);
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        while (state.keepRunning())
+        {
+            sink += static_cast<size_t>(Algorithms::isConnected(g));
+        }
+    });
+    harness.add("operator*(dense storage)", CUBIC_SIZES, SPARSE_DENSITY, [](BenchmarkState &state)
+    {
+        StorageSettings settings(0, false, false);
+        Graph g1 = randomGraph(state, Shape::Directed, 1);
+        Graph g2 = randomGraph(state, Shape::Directed, 2);
+        while (state.keepRunning())
+        {
+            Graph product = g1 * g2;
+            sink += product.getEdges();
+        }
+    });
+
+    // Graphs whose edges all weigh 1, in bitset storage and in dense storage.
+    for (bool bitset : {true, false})
+    {
+        string storage = bitset ? "(bitset)" : "(bitset off)";
+        harness.add("isConnected" + storage, ALL_SIZES, DENSE_DENSITY, [bitset](BenchmarkState &state)
+        {
+            StorageSettings settings(0, bitset, false);
+            Graph g = randomGraph(state, Shape::Unweighted, 1);
+            while (state.keepRunning())
+            {
+                // The components of an undirected graph are kept with it, drop them so the graph is searched every time.
+                dropResults(state, g);
+                sink += static_cast<size_t>(Algorithms::isConnected(g));
+            }
+        });
+        harness.add("operator==" + storage, ALL_SIZES, DENSE_DENSITY, [bitset](BenchmarkState &state)
+        {
+            StorageSettings settings(0, bitset, false);
+            Graph g1 = randomGraph(state, Shape::Unweighted, 1);
+            Graph g2 = randomGraph(state, Shape::Unweighted, 1);
+            while (state.keepRunning())
+            {
+                sink += g1 == g2;
+            }
+        });
+        harness.add("operator*" + storage, CUBIC_SIZES, DENSE_DENSITY, [bitset](BenchmarkState &state)
+        {
+            StorageSettings settings(0, bitset, false);
+            Graph g1 = randomGraph(state, Shape::Unweighted, 1);
+            Graph g2 = randomGraph(state, Shape::Unweighted, 2);
+            while (state.keepRunning())
+            {
+                Graph product = g1 * g2;
+                sink += product.getEdges();
+            }
+        });
+    }
+
+    // Undirected graphs, only their upper triangle in symmetric storage or the whole matrix in dense storage.
+    for (bool symmetric : {true, false})
+    {
+        string storage = symmetric ? "(symmetric)" : "(symmetric off)";
+        harness.add("operator+=" + storage, ALL_SIZES, DENSE_DENSITY, [symmetric](BenchmarkState &state)
+        {
+            StorageSettings settings(0, false, symmetric);
+            Graph g1 = randomGraph(state, Shape::Undirected, 1);
+            Graph g2 = randomGraph(state, Shape::Undirected, 2);
+            while (state.keepRunning())
+            {
+                g1 += g2;
+                sink += g1.getEdges();
+            }
+        });
+        harness.add("g1+g2*2" + storage, ALL_SIZES, DENSE_DENSITY, [symmetric](BenchmarkState &state)
+        {
+            StorageSettings settings(0, false, symmetric);
+            Graph g1 = randomGraph(state, Shape::Undirected, 1);
+            Graph g2 = randomGraph(state, Shape::Undirected, 2);
+            while (state.keepRunning())
+            {
+                Graph result = g1 + g2 * 2;
+                sink += result.getEdges();
+            }
+        });
+    }
+
+    // 8 bit weights, four times as many cells to a vector register as the int weights of operator+= and operator*=.
+    // The weights are added and taken back, or negated, so they stay in range.
+    harness.add("operator+=(int8)", ALL_SIZES, DENSE_DENSITY, [](BenchmarkState &state)
+    {
+        ariel::BasicGraph<int8_t> g1 = GraphGenerator::erdosRenyi<int8_t>(state.getVertices(), state.getDensity(), true, 1, 9, 1);
+        ariel::BasicGraph<int8_t> g2 = GraphGenerator::erdosRenyi<int8_t>(state.getVertices(), state.getDensity(), true, 1, 9, 2);
+        while (state.keepRunning())
+        {
+            g1 += g2;
+            g1 -= g2;
+            sink += g1.getEdges();
+        }
+    });
+    harness.add("operator*=(int8)", ALL_SIZES, DENSE_DENSITY, [](BenchmarkState &state)
+    {
+        ariel::BasicGraph<int8_t> g = GraphGenerator::erdosRenyi<int8_t>(state.getVertices(), state.getDensity(), true, 1, 9, 1);
+        while (state.keepRunning())
+        {
+            g *= -1;
+            sink += g.getEdges();
+        }
+    });
+
+    // The parallel kernels on 1 thread up to every hardware thread, for their scaling.
+    for (size_t threads : threadCounts())
+    {
+        string suffix = "(threads " + to_string(threads) + ")";
+        harness.add("operator*" + suffix, CUBIC_SIZES, DENSE_DENSITY, [threads](BenchmarkState &state)
+        {
+            Graph g1 = randomGraph(state, Shape::Directed, 1);
+            Graph g2 = randomGraph(state, Shape::Directed, 2);
+            while (state.keepRunning())
+            {
+                sink += ariel::multiply(g1, g2, threads).getEdges();
+            }
+        });
+        harness.add("getAllPairsPaths" + suffix, CUBIC_SIZES, DENSE_DENSITY, [threads](BenchmarkState &state)
+        {
+            size_t saved = Algorithms::getThreadCount();
+            Algorithms::setThreadCount(threads);
+            Graph g = randomGraph(state, Shape::Directed, 1);
+            while (state.keepRunning())
+            {
+                dropResults(state, g);
+                sink += static_cast<size_t>(g.getAllPairsPaths()->getDistance(0, g.getVertices() - 1));
+            }
+            Algorithms::setThreadCount(saved);
+        });
+    }
+
+    // Many queries on the same graph: a search for every query, or the index or the all-pairs paths built once for all of them.
+    harness.add("reachable(search)", CUBIC_SIZES, SPARSE_DENSITY, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        size_t n = g.getVertices();
+        while (state.keepRunning())
+        {
+            for (size_t q = 0; q < QUERIES; q++)
+            {
+                sink += static_cast<size_t>(searchReachable(g, q % n, (q * 7) % n));
+            }
+        }
+    });
+    harness.add("reachable(index)", CUBIC_SIZES, SPARSE_DENSITY, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        size_t n = g.getVertices();
+        while (state.keepRunning())
+        {
+            ariel::ReachabilityIndex index(g);
+            for (size_t q = 0; q < QUERIES; q++)
+            {
+                sink += static_cast<size_t>(index.reachable(q % n, (q * 7) % n));
+            }
+        }
+    });
+    harness.add("getPath(all pairs)", CUBIC_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Graph g = randomGraph(state, Shape::Directed, 1);
+        size_t n = g.getVertices();
+        while (state.keepRunning())
+        {
+            dropResults(state, g);
+            shared_ptr<const ariel::AllPairsPaths> paths = g.getAllPairsPaths();
+            for (size_t q = 0; q < QUERIES; q++)
+            {
+                sink += paths->getPath(q % n, (q * 7) % n).size();
+            }
+        }
+    });
+}
+
+// The same operations on the vector<vector<int>> graph the library started from, on the same inputs as the cases above.
+static void addLegacyBenchmarks(BenchmarkHarness &harness)
+{
+    harness.add("loadGraph(legacy)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        Matrix m = randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix();
+        while (state.keepRunning())
+        {
+            LegacyGraph g;
+            g.loadGraph(m);
+            sink += g.edges;
+        }
+    });
+    harness.add("operator+(legacy)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        LegacyGraph g1, g2;
+        g1.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        g2.loadGraph(randomGraph(state, Shape::Directed, 2).getAdjacencyMatrix());
+        while (state.keepRunning())
+        {
+            sink += legacyAdd(g1, g2).edges;
+        }
+    });
+    harness.add("operator+=(legacy)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        LegacyGraph g1, g2;
+        g1.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        g2.loadGraph(randomGraph(state, Shape::Directed, 2).getAdjacencyMatrix());
+        while (state.keepRunning())
+        {
+            legacyAddAssign(g1, g2);
+            sink += g1.edges;
+        }
+    });
+    harness.add("operator==(legacy)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        LegacyGraph g1, g2;
+        g1.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        g2.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        while (state.keepRunning())
+        {
+            sink += legacyEquals(g1, g2);
+        }
+    });
+    harness.add("countEdges(legacy)", ALL_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        LegacyGraph g;
+        g.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        while (state.keepRunning())
+        {
+            sink += g.countEdges();
+        }
+    });
+    harness.add("operator*(legacy)", CUBIC_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        LegacyGraph g1, g2;
+        g1.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        g2.loadGraph(randomGraph(state, Shape::Directed, 2).getAdjacencyMatrix());
+        while (state.keepRunning())
+        {
+            sink += legacyMultiply(g1, g2).edges;
+        }
+    });
+    // The tiled operator* against the i-j-k kernel, which takes too long above 2048 vertices.
+    harness.add("operator*(i-j-k)", NAIVE_PRODUCT_SIZES, DENSE_DENSITY, [](BenchmarkState &state)
+    {
+        size_t n = state.getVertices();
+        Matrix m1 = randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix();
+        Matrix m2 = randomGraph(state, Shape::Directed, 2).getAdjacencyMatrix();
+        vector<int> a(n * n), b(n * n);
+        for (size_t i = 0; i < n; i++)
+        {
+            copy(m1[i].begin(), m1[i].end(), a.begin() + static_cast<long>(i * n));
+            copy(m2[i].begin(), m2[i].end(), b.begin() + static_cast<long>(i * n));
+        }
+        while (state.keepRunning())
+        {
+            sink += static_cast<size_t>(naiveMultiply(a, b, n));
+        }
+    });
+    // shortestPath ran Floyd-Warshall over the whole graph for a single pair, negativeCycle ran it too.
+    harness.add("shortestPath(legacy)", CUBIC_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        LegacyGraph g;
+        g.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        size_t n = g.adjancencyMatrix.size();
+        while (state.keepRunning())
+        {
+            sink += legacyShortestPath(g, 0, n - 1).size();
+        }
+    });
+    harness.add("getAllPairsPaths(legacy)", CUBIC_SIZES, DENSITIES, [](BenchmarkState &state)
+    {
+        LegacyGraph g;
+        g.loadGraph(randomGraph(state, Shape::Directed, 1).getAdjacencyMatrix());
+        size_t n = g.adjancencyMatrix.size();
+        while (state.keepRunning())
+        {
+            Matrix dist, next;
+            legacyFloydWarshall(g, dist, next);
+            sink += static_cast<size_t>(dist[0][n - 1]);
+        }
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkHarness::Options options;
+    try
+    {
+        options = BenchmarkHarness::parseArguments(argc, argv);
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    Algorithms::setThreadCount(options.threads);
+
+    BenchmarkHarness harness;
+    addGraphBenchmarks(harness);
+    addOperatorBenchmarks(harness);
+    addAlgorithmBenchmarks(harness);
+    addComparisonBenchmarks(harness);
+    addLegacyBenchmarks(harness);
+    vector<BenchmarkHarness::Result> results = harness.run(options, cout);
+
+    if (!options.jsonPath.empty())
+    {
+        ofstream json(options.jsonPath);
+        BenchmarkHarness::writeJson(results, options, json);
+        if (!json)
+        {
+            cerr << "Could not write " << options.jsonPath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
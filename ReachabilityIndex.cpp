@@ -0,0 +1,70 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <stdexcept>
+#include "ReachabilityIndex.hpp"
+#include "StronglyConnectedComponents.hpp"
+using ariel::ReachabilityIndex;
+using ariel::StronglyConnectedComponents;
+using ariel::BasicGraph;
+using namespace std;
+
+template <typename W>
+ReachabilityIndex::ReachabilityIndex(const BasicGraph<W> &graph)
+{
+    StronglyConnectedComponents components(graph);
+    this->vertices = graph.getVertices();
+    this->components = components.getComponentCount();
+    this->component = components.getComponents();
+
+    size_t c = this->components;
+    size_t words = (c + 63) / 64;
+    this->stride = AlignedBuffer<uint64_t>::rowStride(words);
+    this->reach = AlignedBuffer<uint64_t>(c * this->stride);
+
+    // Every edge of the condensation enters a smaller component, whose row is already complete.
+    for (size_t k = 0; k < c; k++)
+    {
+        uint64_t *row = this->reach.data() + k * this->stride;
+        row[k / 64] |= uint64_t(1) << (k % 64);
+        for (size_t d : components.getSuccessors(k))
+        {
+            const uint64_t *rowD = this->reach.data() + d * this->stride;
+            for (size_t w = 0; w < words; w++)
+            {
+                row[w] |= rowD[w];
+            }
+        }
+    }
+}
+
+size_t ReachabilityIndex::getVertices() const
+{
+    return this->vertices;
+}
+
+size_t ReachabilityIndex::getComponentCount() const
+{
+    return this->components;
+}
+
+bool ReachabilityIndex::reachable(size_t src, size_t dest) const
+{
+    if (src >= this->vertices || dest >= this->vertices)
+    {
+        throw invalid_argument("Invalid vertex");
+    }
+    size_t from = this->component[src];
+    size_t to = this->component[dest];
+    return (this->reach[from * this->stride + to / 64] >> (to % 64)) & 1;
+}
+
+bool ReachabilityIndex::isStronglyConnected() const
+{
+    return this->components <= 1;
+}
+
+// The indexes of the graphs of every weight type.
+#define ARIEL_INSTANTIATE_REACHABILITY_INDEX(W) \
+    template ReachabilityIndex::ReachabilityIndex(const BasicGraph<W> &graph);
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_REACHABILITY_INDEX)
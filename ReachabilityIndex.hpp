@@ -0,0 +1,81 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _REACHABILITY_INDEX_HPP_
+#define _REACHABILITY_INDEX_HPP_
+
+#include <vector>
+#include <cstdint>
+#include "AlignedBuffer.hpp"
+#include "Graph.hpp"
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * The transitive closure of a graph: for every pair of vertices, whether there is a path from the first to the second.
+    * The vertices of a strongly connected component reach the same vertices, so the closure is kept per component,
+    * one row of bits per component. The row of a component is the or of the rows of its successors in the condensation,
+    * 64 components at a time, in reverse topological order.
+    * A query takes O(1), the index takes O(V + E + D * C / 64) time and C * C / 8 bytes,
+    * for C components and D edges in the condensation.
+    * The object does not change, and does not follow later changes of the graph it was built from,
+    * use Graph::getReachability to get the reachability of the graph as it is now.
+    */
+    class ReachabilityIndex
+    {
+    private:
+        size_t vertices;
+        size_t components;
+        // The strongly connected component of every vertex, numbered so every edge between two components
+        // enters a component with a smaller number.
+        vector<size_t> component;
+        size_t stride;
+        // Bit d of row c, that starts at reach[c * stride], is set when component d can be reached from component c.
+        AlignedBuffer<uint64_t> reach;
+
+    public:
+        /*
+        * @brief
+        * Constructor, builds the index of the graph.
+        * @param graph - Graph object.
+        */
+        template <typename W>
+        explicit ReachabilityIndex(const BasicGraph<W> &graph);
+
+        /*
+        * @brief
+        * This function returns the number of vertices of the graph the index was built from.
+        * @return size_t - number of vertices.
+        */
+        size_t getVertices() const;
+
+        /*
+        * @brief
+        * This function returns the number of strongly connected components of the graph.
+        * @return size_t - number of components.
+        */
+        size_t getComponentCount() const;
+
+        /*
+        * @brief
+        * This function checks if there is a path from src to dest, in O(1). A vertex always reaches itself.
+        * @param src - source vertex.
+        * @param dest - destination vertex.
+        * @return bool - true if dest can be reached from src, false otherwise.
+        * @throw invalid_argument - if src or dest is not a vertex.
+        */
+        bool reachable(size_t src, size_t dest) const;
+
+        /*
+        * @brief
+        * This function checks if every vertex can be reached from every other vertex, in O(1).
+        * An undirected graph is strongly connected when it is connected.
+        * @return bool - true if the graph is strongly connected, false otherwise.
+        */
+        bool isStronglyConnected() const;
+    };
+}
+
+#endif
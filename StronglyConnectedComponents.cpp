@@ -0,0 +1,105 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <stdexcept>
+#include <algorithm>
+#include "StronglyConnectedComponents.hpp"
+#include "Algorithms.hpp"
+using ariel::StronglyConnectedComponents;
+using ariel::Algorithms;
+using ariel::BasicGraph;
+using namespace std;
+
+template <typename W>
+StronglyConnectedComponents::StronglyConnectedComponents(const BasicGraph<W> &graph)
+{
+    size_t n = graph.getVertices();
+    this->components = Algorithms::findComponents(graph, this->component);
+    size_t c = this->components;
+
+    this->sizes.assign(c, 0);
+    for (size_t v = 0; v < n; v++)
+    {
+        this->sizes[this->component[v]]++;
+    }
+
+    // The vertices of every component together, so the edges of a component are read one after the other.
+    vector<size_t> first(c + 1, 0), members(n);
+    for (size_t k = 0; k < c; k++)
+    {
+        first[k + 1] = first[k] + this->sizes[k];
+    }
+    vector<size_t> next(first.begin(), first.end() - 1);
+    for (size_t v = 0; v < n; v++)
+    {
+        members[next[this->component[v]]++] = v;
+    }
+
+    // takenBy[d] is the last component found to have an edge into d, so every edge of the condensation is listed once.
+    this->successors.resize(c);
+    vector<size_t> takenBy(c, c);
+    for (size_t k = 0; k < c; k++)
+    {
+        takenBy[k] = k;
+        for (size_t m = first[k]; m < first[k + 1]; m++)
+        {
+            for (typename BasicGraph<W>::Neighbour neighbour : graph.getRow(members[m]))
+            {
+                size_t d = this->component[neighbour.vertex];
+                if (takenBy[d] != k)
+                {
+                    takenBy[d] = k;
+                    this->successors[k].push_back(d);
+                }
+            }
+        }
+        sort(this->successors[k].begin(), this->successors[k].end());
+    }
+}
+
+size_t StronglyConnectedComponents::getVertices() const
+{
+    return this->component.size();
+}
+
+size_t StronglyConnectedComponents::getComponentCount() const
+{
+    return this->components;
+}
+
+size_t StronglyConnectedComponents::getComponent(size_t v) const
+{
+    if (v >= this->component.size())
+    {
+        throw invalid_argument("Invalid vertex");
+    }
+    return this->component[v];
+}
+
+const vector<size_t> &StronglyConnectedComponents::getComponents() const
+{
+    return this->component;
+}
+
+size_t StronglyConnectedComponents::getSize(size_t c) const
+{
+    if (c >= this->components)
+    {
+        throw invalid_argument("Invalid component");
+    }
+    return this->sizes[c];
+}
+
+const vector<size_t> &StronglyConnectedComponents::getSuccessors(size_t c) const
+{
+    if (c >= this->components)
+    {
+        throw invalid_argument("Invalid component");
+    }
+    return this->successors[c];
+}
+
+// The components of the graphs of every weight type.
+#define ARIEL_INSTANTIATE_COMPONENTS(W) \
+    template StronglyConnectedComponents::StronglyConnectedComponents(const BasicGraph<W> &graph);
+ARIEL_FOR_EACH_WEIGHT(ARIEL_INSTANTIATE_COMPONENTS)
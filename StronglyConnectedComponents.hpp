@@ -0,0 +1,93 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _STRONGLY_CONNECTED_COMPONENTS_HPP_
+#define _STRONGLY_CONNECTED_COMPONENTS_HPP_
+
+#include <vector>
+#include "Graph.hpp"
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * The strongly connected components of a graph: the largest sets of vertices that can all reach each other,
+    * and the condensation, the graph with an edge from one component to another when an edge of the graph joins them.
+    * The components are found with one iterative DFS (Tarjan), in O(V+E).
+    * They are numbered in the order their search finished, so every edge of the condensation enters a component
+    * with a smaller number: component 0 has no edge out, and the components from the last to 0 are in topological order.
+    * In an undirected graph the components are the connected components, and the condensation has no edges.
+    * The object does not change, and does not follow later changes of the graph it was computed from.
+    */
+    class StronglyConnectedComponents
+    {
+    private:
+        size_t components;
+        // The component of every vertex.
+        vector<size_t> component;
+        // The number of vertices of every component.
+        vector<size_t> sizes;
+        // The components every component has an edge to, each one once, in increasing order.
+        vector<vector<size_t>> successors;
+
+    public:
+        /*
+        * @brief
+        * Constructor, finds the components of the graph.
+        * @param graph - Graph object.
+        */
+        template <typename W>
+        explicit StronglyConnectedComponents(const BasicGraph<W> &graph);
+
+        /*
+        * @brief
+        * This function returns the number of vertices of the graph the components were found in.
+        * @return size_t - number of vertices.
+        */
+        size_t getVertices() const;
+
+        /*
+        * @brief
+        * This function returns the number of components.
+        * @return size_t - number of components, 1 if the graph is strongly connected, 0 if it has no vertices.
+        */
+        size_t getComponentCount() const;
+
+        /*
+        * @brief
+        * This function returns the component of a vertex.
+        * @param v - the vertex.
+        * @return size_t - the number of its component.
+        * @throw invalid_argument - if v is not a vertex.
+        */
+        size_t getComponent(size_t v) const;
+
+        /*
+        * @brief
+        * This function returns the component of every vertex.
+        * @return const vector<size_t>& - the number of the component of vertex i at index i.
+        */
+        const vector<size_t> &getComponents() const;
+
+        /*
+        * @brief
+        * This function returns the number of vertices of a component.
+        * @param c - the component.
+        * @return size_t - the number of its vertices, at least 1.
+        * @throw invalid_argument - if c is not a component.
+        */
+        size_t getSize(size_t c) const;
+
+        /*
+        * @brief
+        * This function returns the edges leaving a component in the condensation.
+        * @param c - the component.
+        * @return const vector<size_t>& - the components entered by an edge from c, each one once, all smaller than c.
+        * @throw invalid_argument - if c is not a component.
+        */
+        const vector<size_t> &getSuccessors(size_t c) const;
+    };
+}
+
+#endif
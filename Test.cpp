@@ -1,429 +1,1982 @@
-// ID: 205739907
-// Email: eladima66@gmail.com
-
-#include "doctest.h"
-#include "Algorithms.hpp"
-#include "Graph.hpp"
-#include <sstream>
-
-using namespace std;
-
-TEST_CASE("Test graph addition")
-{
-    ariel::Graph g1;
-    vector<vector<int>> graph = {
-        {0, 1, 0},
-        {1, 0, 1},
-        {0, 1, 0}};
-    g1.loadGraph(graph);
-    ariel::Graph g2;
-    vector<vector<int>> weightedGraph = {
-        {0, 1, 1},
-        {1, 0, 2},
-        {1, 2, 0}};
-    g2.loadGraph(weightedGraph);
-    ariel::Graph g3 = g1 + g2;
-    ariel::Graph expectedGraph;
-    vector<vector<int>> expectedMat = {
-        {0, 2, 1},
-        {2, 0, 3},
-        {1, 3, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    stringstream ss;
-    ss << g3;
-    CHECK(ss.str() == "[0, 2, 1], \n[2, 0, 3], \n[1, 3, 0]\n\n");
-    CHECK(g3 == expectedGraph);
-    ariel::Graph g4 = g2 + g1;
-    CHECK(g4 == expectedGraph);
-}
-
-TEST_CASE("Test graph multiplication")
-{
-    ariel::Graph g1;
-    vector<vector<int>> graph = {
-        {0, 1, 0},
-        {1, 0, 1},
-        {0, 1, 0}};
-    g1.loadGraph(graph);
-    ariel::Graph g2;
-    vector<vector<int>> weightedGraph = {
-        {0, 1, 1},
-        {1, 0, 2},
-        {1, 2, 0}};
-    g2.loadGraph(weightedGraph);
-    ariel::Graph g3 = g1 * g2;
-    ariel::Graph expectedGraph;
-    vector<vector<int>> expectedMat = {
-        {1, 0, 2},
-        {1, 3, 1},
-        {1, 0, 2}};
-    expectedGraph.loadGraph(expectedMat);
-    stringstream ss;
-    ss << g3;
-    CHECK(ss.str() == "[1, 0, 2], \n[1, 3, 1], \n[1, 0, 2]\n\n");
-    CHECK(g3 == expectedGraph);
-
-    ariel::Graph g4 = g2 * g1;
-    expectedMat = {
-        {1, 1, 1},
-        {0, 3, 0},
-        {2, 1, 2}};
-    expectedGraph.loadGraph(expectedMat);
-    ss.str("");
-    ss << g2 * g1;
-    CHECK(ss.str() == "[1, 1, 1], \n[0, 3, 0], \n[2, 1, 2]\n\n");
-    CHECK(g4 == expectedGraph);
-}
-
-TEST_CASE("Invalid operations")
-{
-    ariel::Graph g1;
-    vector<vector<int>> graph = {
-        {0, 1, 0},
-        {1, 0, 1},
-        {0, 1, 0}};
-    g1.loadGraph(graph);
-    ariel::Graph g2;
-    vector<vector<int>> weightedGraph = {
-        {0, 1, 1, 1},
-        {1, 0, 2, 1},
-        {1, 2, 0, 1}};
-    CHECK_THROWS(g2.loadGraph(weightedGraph));
-    ariel::Graph g5;
-    vector<vector<int>> graph2 = {
-        {0, 1, 0, 0, 1},
-        {1, 0, 1, 0, 0},
-        {0, 1, 0, 1, 0},
-        {0, 0, 1, 0, 1},
-        {1, 0, 0, 1, 0}};
-    g5.loadGraph(graph2);
-    CHECK_THROWS(g5 * g1);
-    CHECK_THROWS(g1 * g2);
-
-    // Addition of two graphs with different dimensions
-    ariel::Graph g6;
-    vector<vector<int>> graph3 = {
-        {0, 1, 0, 0, 1},
-        {1, 0, 1, 0, 0},
-        {0, 1, 0, 1, 0},
-        {0, 0, 1, 0, 1},
-        {1, 0, 0, 1, 0}};
-    g6.loadGraph(graph3);
-    CHECK_THROWS(g1 + g6);
-}
-
-TEST_CASE("Adding a graph to itself")
-{
-    ariel::Graph g1;
-    vector<vector<int>> graph = {
-        {0, 1, 0},
-        {1, 0, 1},
-        {0, 1, 0}};
-    g1.loadGraph(graph);
-    ariel::Graph g2;
-    vector<vector<int>> weightedGraph = {
-        {0, 1, 1},
-        {1, 0, 2},
-        {1, 2, 0}};
-    g2.loadGraph(weightedGraph);
-    g1 += g2;
-    ariel::Graph g3;
-    vector<vector<int>> expectedGraph = {
-        {0, 2, 1},
-        {2, 0, 3},
-        {1, 3, 0}};
-    g3.loadGraph(expectedGraph);
-    CHECK(g1 == g3);
-    expectedGraph = {
-        {0, 3, 2},
-        {3, 0, 4},
-        {2, 4, 0}};
-    g3.loadGraph(expectedGraph);
-    CHECK(++g1 == g3);
-    CHECK(g1++ == g3);
-
-    ariel::Graph g4;
-    vector<vector<int>> graph2 = {
-        {0, -1, 0, 1},
-        {-1, 0, -1, 0},
-        {0, -1, 0, -1},
-        {1, 0, -1, 0}};
-    g4.loadGraph(graph2);
-    expectedGraph = {
-        {0, 1, 0, 2},
-        {1, 0, 1, 0},
-        {0, 1, 0, 1},
-        {2, 0, 1, 0}};
-    g3.loadGraph(expectedGraph);
-    CHECK(++g4 == g3);
-    CHECK(g4++ == g3);
-}
-
-TEST_CASE("Subtracting two graphs")
-{
-    ariel::Graph g1;
-    vector<vector<int>> g1Mat = {
-        {0, 0, 0, 0},
-        {4, 0, -6, 0},
-        {0, 0, 0, 5},
-        {0, -2, 0, 0}};
-    g1.loadGraph(g1Mat);
-    ariel::Graph g2;
-    vector<vector<int>> g2Mat = {
-        {0, 4, 0, 0},
-        {4, 0, -6, -2},
-        {0, -6, 0, 5},
-        {0, -2, 5, 0}};
-    g2.loadGraph(g2Mat);
-    ariel::Graph g3 = g1 - g2;
-    ariel::Graph expectedGraph;
-    vector<vector<int>> expectedMat = {
-        {0, -4, 0, 0},
-        {0, 0, 0, 2},
-        {0, 6, 0, 0},
-        {0, 0, -5, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    CHECK(g3 == expectedGraph);
-    g3 = g2 - g1;
-    expectedMat = {
-        {0, 4, 0, 0},
-        {0, 0, 0, -2},
-        {0, -6, 0, 0},
-        {0, 0, 5, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    CHECK(g3 == expectedGraph);
-}
-
-TEST_CASE("Subtracting a graph from itself")
-{
-    ariel::Graph g1;
-    vector<vector<int>> g1Mat = {
-        {0, 1, 0, 0, 0},
-        {1, 0, 3, 0, 0},
-        {0, 3, 0, 4, 0},
-        {0, 0, 4, 0, 5},
-        {0, 0, 0, 5, 0}};
-    g1.loadGraph(g1Mat);
-    ariel::Graph g2;
-    vector<vector<int>> g2Mat = {
-        {0, 1, 1, 0, 0},
-        {1, 0, 1, 0, 0},
-        {1, 1, 0, 1, 0},
-        {0, 0, 1, 0, 0},
-        {0, 0, 0, 0, 0}};
-    g2.loadGraph(g2Mat);
-    g1 -= g2;
-    ariel::Graph expectedGraph;
-    vector<vector<int>> expectedMat = {
-        {0, 0, -1, 0, 0},
-        {0, 0, 2, 0, 0},
-        {-1, 2, 0, 3, 0},
-        {0, 0, 3, 0, 5},
-        {0, 0, 0, 5, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    CHECK(g1 == expectedGraph);
-    -g1;
-    expectedMat = {
-        {0, 0, 1, 0, 0},
-        {0, 0, -2, 0, 0},
-        {1, -2, 0, -3, 0},
-        {0, 0, -3, 0, -5},
-        {0, 0, 0, -5, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    CHECK(g1 == expectedGraph);
-    expectedMat = {
-        {0, 0, -1, 0, 0},
-        {0, 0, -3, 0, 0},
-        {-1, -3, 0, -4, 0},
-        {0, 0, -4, 0, -6},
-        {0, 0, 0, -6, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    CHECK(--g1 == expectedGraph);
-    CHECK(g1-- == expectedGraph);
-}
-
-TEST_CASE("Multiplying a graph by a scalar")
-{
-    ariel::Graph g1;
-    vector<vector<int>> g1Mat = {
-        {0, 1, 0, 0, 0},
-        {1, 0, 3, 0, 0},
-        {0, 3, 0, 4, 0},
-        {0, 0, 4, 0, 5},
-        {0, 0, 0, 5, 0}};
-    g1.loadGraph(g1Mat);
-    g1 *= 2;
-    ariel::Graph expectedGraph;
-    vector<vector<int>> expectedMat = {
-        {0, 2, 0, 0, 0},
-        {2, 0, 6, 0, 0},
-        {0, 6, 0, 8, 0},
-        {0, 0, 8, 0, 10},
-        {0, 0, 0, 10, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    CHECK(g1 == expectedGraph);
-    g1 *= -5;
-    expectedMat = {
-        {0, -10, 0, 0, 0},
-        {-10, 0, -30, 0, 0},
-        {0, -30, 0, -40, 0},
-        {0, 0, -40, 0, -50},
-        {0, 0, 0, -50, 0}};
-    expectedGraph.loadGraph(expectedMat);
-    CHECK(g1 == expectedGraph);
-}
-
-TEST_CASE("Dividing a graph by a scalar")
-{
-    ariel::Graph g1;
-    vector<vector<int>> g4Mat = { 
-        { 0, -1, 0, 1 },
-        { 1, 0, 1, 0 },
-        { 0, -1, 0, 1 },
-        { 1, 0, 1, 0 } };
-    g1.loadGraph(g4Mat);
-    CHECK_THROWS(g1 /= 0);
-    g1 /= 2;
-    ariel::Graph expectedGraph;
-    vector<vector<int>> expectedMat = {
-        {0, 0, 0, 0},
-        {0, 0, 0, 0},
-        {0, 0, 0, 0},
-        {0, 0, 0, 0}};
-    expectedGraph.loadGraph(expectedMat);
-}
-
-TEST_CASE("Testing equality of graphs")
-{
-    ariel::Graph g1;
-    vector<vector<int>> g1Mat = {
-        {0, 0, 0, 0},
-        {4, 0, -6, 0},
-        {0, 0, 0, 5},
-        {0, -2, 0, 0}};
-    g1.loadGraph(g1Mat);
-    ariel::Graph g2;
-    vector<vector<int>> g2Mat = {
-        {0, 0, 0, 0},
-        {-4, 0, 6, 0},
-        {0, 0, 0, -5},
-        {0, 2, 0, 0}};
-    g2.loadGraph(g2Mat);
-    CHECK(g1 != g2);
-    CHECK(g2 != g1);
-    CHECK((g1 == g2) == false);
-    -g2;
-    CHECK(g1 == g2);
-    CHECK(g2 == g1);
-    CHECK(g1 <= g2);
-    CHECK(g2 <= g1);
-    CHECK(g1 >= g2);
-    CHECK(g2 >= g1);
-}
-
-TEST_CASE("Testing graph inclusion")
-{
-    ariel::Graph g1;
-    vector<vector<int>> g1Mat = {
-        {0, 0, 0, 1},
-        {0, 0, 1, 0},
-        {0, 1, 0, 1},
-        {1, 0, 1, 0}};
-    g1.loadGraph(g1Mat);
-    ariel::Graph g2;
-    vector<vector<int>> g2Mat = {
-        {0, 1, 0, 1, 0},
-        {1, 0, 1, 1, 0},
-        {0, 1, 0, 1, 0},
-        {1, 1, 1, 0, 1},
-        {0, 0, 0, 1, 0}};
-    g2.loadGraph(g2Mat);
-    CHECK(g2.isSubgraph(g1));
-    CHECK(g1 < g2);
-    CHECK(g2 > g1);
-    CHECK((g1 > g2) == false);
-    ariel::Graph g3;
-    vector<vector<int>> g3Mat = {
-        {0,1},
-        {2,0}};
-    g3.loadGraph(g3Mat);
-    ariel::Graph g4;
-    vector<vector<int>> g4Mat = {
-        {0, 1, 0},
-        {0, 0, 0},
-        {0, 0, 0}};
-    g4.loadGraph(g4Mat);
-    CHECK(g3 > g4);
-    CHECK(g4 < g3); 
-    ariel::Graph g5;
-    vector<vector<int>> g5Mat = {
-        {0, 1, 0},
-        {1, 0, 1},
-        {0, 2, 0}};
-    g5.loadGraph(g5Mat);
-    ariel::Graph g6;
-    vector<vector<int>> g6Mat = {
-        {0, 1, 1},
-        {1, 0, 2},
-        {1, 2, 0}};
-    g6.loadGraph(g6Mat);
-    CHECK(g5 > g6);
-    CHECK(g6 < g5);
-}
-
-TEST_CASE("Testing graph inequality")
-{
-    ariel::Graph g1;
-    vector<vector<int>> g1Mat = {
-        {0, 0, 0, 1},
-        {0, 0, 1, 0},
-        {0, 1, 0, 1},
-        {1, 0, 1, 0}};
-    g1.loadGraph(g1Mat);
-    ariel::Graph g2;
-    vector<vector<int>> g2Mat = {
-        {0, 1, 0, 1, 0},
-        {1, 0, 1, 1, 0},
-        {0, 1, 0, 1, 0},
-        {1, 1, 1, 0, 1},
-        {0, 0, 0, 1, 0}};
-    g2.loadGraph(g2Mat);
-    CHECK(g1 != g2);
-    CHECK((g1 == g2) == false);
-    CHECK(g1 < g2);
-
-    ariel::Graph g3;
-    g3.loadGraph(g1Mat);
-    CHECK((g1 < g3) == false);
-    CHECK((g1 > g3) == false);
-    CHECK(g1 <= g3);
-    CHECK(g1 >= g3);
-    ariel::Graph g4;
-    vector<vector<int>> g4Mat = {
-        {0, 1, 0, 1, 0},
-        {1, 0, 1, 0, 1},
-        {0, 1, 0, 1, 0},
-        {1, 0, 1, 0, 1},
-        {0, 1, 0, 1, 0}};
-    g4.loadGraph(g4Mat);
-    ariel::Graph g5;
-    vector<vector<int>> g5Mat = {
-        {0, 1, 1, 0, 1},
-        {1, 0, 1, 0, 0},
-        {1, 1, 0, 1, 0},
-        {0, 0, 1, 0, 1},
-        {1, 0, 0, 1, 0}};
-    g5.loadGraph(g5Mat);
-    CHECK((g4 < g5) == false);
-    CHECK((g5 < g4) == false);
-    CHECK((g4 > g5) == false);
-    CHECK((g5 > g4) == false);
-    CHECK(g4 != g5);
-    CHECK(g5 != g4);
-    CHECK((g4 <= g5) == false);
-    CHECK((g5 <= g4) == false);
-    CHECK((g4 >= g5) == false);
-    CHECK((g5 >= g4) == false);
-
-}
-
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include "doctest.h"
+#include "Algorithms.hpp"
+#include "Graph.hpp"
+#include "AllocationCounter.hpp"
+#include "Traversal.hpp"
+#include "AllPairsPaths.hpp"
+#include "ReachabilityIndex.hpp"
+#include "StronglyConnectedComponents.hpp"
+#include "DisjointSet.hpp"
+#include "ThreadPool.hpp"
+#include "GraphGenerator.hpp"
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+TEST_CASE("Test graph addition")
+{
+    ariel::Graph g1;
+    vector<vector<int>> graph = {
+        {0, 1, 0},
+        {1, 0, 1},
+        {0, 1, 0}};
+    g1.loadGraph(graph);
+    ariel::Graph g2;
+    vector<vector<int>> weightedGraph = {
+        {0, 1, 1},
+        {1, 0, 2},
+        {1, 2, 0}};
+    g2.loadGraph(weightedGraph);
+    ariel::Graph g3 = g1 + g2;
+    ariel::Graph expectedGraph;
+    vector<vector<int>> expectedMat = {
+        {0, 2, 1},
+        {2, 0, 3},
+        {1, 3, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    stringstream ss;
+    ss << g3;
+    CHECK(ss.str() == "[0, 2, 1], \n[2, 0, 3], \n[1, 3, 0]\n\n");
+    CHECK(g3 == expectedGraph);
+    ariel::Graph g4 = g2 + g1;
+    CHECK(g4 == expectedGraph);
+}
+
+TEST_CASE("Test graph multiplication")
+{
+    ariel::Graph g1;
+    vector<vector<int>> graph = {
+        {0, 1, 0},
+        {1, 0, 1},
+        {0, 1, 0}};
+    g1.loadGraph(graph);
+    ariel::Graph g2;
+    vector<vector<int>> weightedGraph = {
+        {0, 1, 1},
+        {1, 0, 2},
+        {1, 2, 0}};
+    g2.loadGraph(weightedGraph);
+    ariel::Graph g3 = g1 * g2;
+    ariel::Graph expectedGraph;
+    vector<vector<int>> expectedMat = {
+        {1, 0, 2},
+        {1, 3, 1},
+        {1, 0, 2}};
+    expectedGraph.loadGraph(expectedMat);
+    stringstream ss;
+    ss << g3;
+    CHECK(ss.str() == "[1, 0, 2], \n[1, 3, 1], \n[1, 0, 2]\n\n");
+    CHECK(g3 == expectedGraph);
+
+    ariel::Graph g4 = g2 * g1;
+    expectedMat = {
+        {1, 1, 1},
+        {0, 3, 0},
+        {2, 1, 2}};
+    expectedGraph.loadGraph(expectedMat);
+    ss.str("");
+    ss << g2 * g1;
+    CHECK(ss.str() == "[1, 1, 1], \n[0, 3, 0], \n[2, 1, 2]\n\n");
+    CHECK(g4 == expectedGraph);
+}
+
+TEST_CASE("Multiplying graphs larger than a block")
+{
+    // 130 rows leave a block of 128 rows of g2 and two rows of the product that are not part of a group of four.
+    size_t n = 130;
+    vector<vector<int>> m1(n, vector<int>(n, 0)), m2(n, vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            if (i != j)
+            {
+                m1[i][j] = static_cast<int>((i * 3 + j) % 5) - 2;
+                m2[i][j] = static_cast<int>((i + j * 7) % 4);
+            }
+        }
+    }
+    ariel::Graph g1, g2;
+    g1.loadGraph(m1);
+    g2.loadGraph(m2);
+    ariel::Graph product = g1 * g2;
+
+    bool equal = true;
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            int sum = 0;
+            for (size_t k = 0; k < n; k++)
+            {
+                sum += m1[i][k] * m2[k][j];
+            }
+            equal = equal && product.getWeight(i, j) == sum;
+        }
+    }
+    CHECK(equal);
+
+    // The groups of rows are split between the threads, the product must not change.
+    CHECK(ariel::multiply(g1, g2, 1) == product);
+    CHECK(ariel::multiply(g1, g2, 3) == product);
+    CHECK(ariel::multiply(g1, g2, 8) == product);
+
+    // A loop started from inside a loop runs on the calling thread.
+    vector<int> calls(40, 0);
+    ariel::ThreadPool::instance().parallelFor(4, 4, [&](size_t i)
+    {
+        ariel::ThreadPool::instance().parallelFor(10, 4, [&](size_t j) { calls[i * 10 + j]++; });
+    });
+    CHECK(count(calls.begin(), calls.end(), 1) == 40);
+}
+
+TEST_CASE("Invalid operations")
+{
+    ariel::Graph g1;
+    vector<vector<int>> graph = {
+        {0, 1, 0},
+        {1, 0, 1},
+        {0, 1, 0}};
+    g1.loadGraph(graph);
+    ariel::Graph g2;
+    vector<vector<int>> weightedGraph = {
+        {0, 1, 1, 1},
+        {1, 0, 2, 1},
+        {1, 2, 0, 1}};
+    CHECK_THROWS(g2.loadGraph(weightedGraph));
+    ariel::Graph g5;
+    vector<vector<int>> graph2 = {
+        {0, 1, 0, 0, 1},
+        {1, 0, 1, 0, 0},
+        {0, 1, 0, 1, 0},
+        {0, 0, 1, 0, 1},
+        {1, 0, 0, 1, 0}};
+    g5.loadGraph(graph2);
+    CHECK_THROWS(g5 * g1);
+    CHECK_THROWS(g1 * g2);
+
+    // Addition of two graphs with different dimensions
+    ariel::Graph g6;
+    vector<vector<int>> graph3 = {
+        {0, 1, 0, 0, 1},
+        {1, 0, 1, 0, 0},
+        {0, 1, 0, 1, 0},
+        {0, 0, 1, 0, 1},
+        {1, 0, 0, 1, 0}};
+    g6.loadGraph(graph3);
+    CHECK_THROWS(g1 + g6);
+}
+
+TEST_CASE("Adding a graph to itself")
+{
+    ariel::Graph g1;
+    vector<vector<int>> graph = {
+        {0, 1, 0},
+        {1, 0, 1},
+        {0, 1, 0}};
+    g1.loadGraph(graph);
+    ariel::Graph g2;
+    vector<vector<int>> weightedGraph = {
+        {0, 1, 1},
+        {1, 0, 2},
+        {1, 2, 0}};
+    g2.loadGraph(weightedGraph);
+    g1 += g2;
+    ariel::Graph g3;
+    vector<vector<int>> expectedGraph = {
+        {0, 2, 1},
+        {2, 0, 3},
+        {1, 3, 0}};
+    g3.loadGraph(expectedGraph);
+    CHECK(g1 == g3);
+    expectedGraph = {
+        {0, 3, 2},
+        {3, 0, 4},
+        {2, 4, 0}};
+    g3.loadGraph(expectedGraph);
+    CHECK(++g1 == g3);
+    CHECK(g1++ == g3);
+
+    ariel::Graph g4;
+    vector<vector<int>> graph2 = {
+        {0, -1, 0, 1},
+        {-1, 0, -1, 0},
+        {0, -1, 0, -1},
+        {1, 0, -1, 0}};
+    g4.loadGraph(graph2);
+    expectedGraph = {
+        {0, 1, 0, 2},
+        {1, 0, 1, 0},
+        {0, 1, 0, 1},
+        {2, 0, 1, 0}};
+    g3.loadGraph(expectedGraph);
+    CHECK(++g4 == g3);
+    CHECK(g4++ == g3);
+}
+
+TEST_CASE("Subtracting two graphs")
+{
+    ariel::Graph g1;
+    vector<vector<int>> g1Mat = {
+        {0, 0, 0, 0},
+        {4, 0, -6, 0},
+        {0, 0, 0, 5},
+        {0, -2, 0, 0}};
+    g1.loadGraph(g1Mat);
+    ariel::Graph g2;
+    vector<vector<int>> g2Mat = {
+        {0, 4, 0, 0},
+        {4, 0, -6, -2},
+        {0, -6, 0, 5},
+        {0, -2, 5, 0}};
+    g2.loadGraph(g2Mat);
+    ariel::Graph g3 = g1 - g2;
+    ariel::Graph expectedGraph;
+    vector<vector<int>> expectedMat = {
+        {0, -4, 0, 0},
+        {0, 0, 0, 2},
+        {0, 6, 0, 0},
+        {0, 0, -5, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    CHECK(g3 == expectedGraph);
+    g3 = g2 - g1;
+    expectedMat = {
+        {0, 4, 0, 0},
+        {0, 0, 0, -2},
+        {0, -6, 0, 0},
+        {0, 0, 5, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    CHECK(g3 == expectedGraph);
+}
+
+TEST_CASE("Subtracting a graph from itself")
+{
+    ariel::Graph g1;
+    vector<vector<int>> g1Mat = {
+        {0, 1, 0, 0, 0},
+        {1, 0, 3, 0, 0},
+        {0, 3, 0, 4, 0},
+        {0, 0, 4, 0, 5},
+        {0, 0, 0, 5, 0}};
+    g1.loadGraph(g1Mat);
+    ariel::Graph g2;
+    vector<vector<int>> g2Mat = {
+        {0, 1, 1, 0, 0},
+        {1, 0, 1, 0, 0},
+        {1, 1, 0, 1, 0},
+        {0, 0, 1, 0, 0},
+        {0, 0, 0, 0, 0}};
+    g2.loadGraph(g2Mat);
+    g1 -= g2;
+    ariel::Graph expectedGraph;
+    vector<vector<int>> expectedMat = {
+        {0, 0, -1, 0, 0},
+        {0, 0, 2, 0, 0},
+        {-1, 2, 0, 3, 0},
+        {0, 0, 3, 0, 5},
+        {0, 0, 0, 5, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    CHECK(g1 == expectedGraph);
+    -g1;
+    expectedMat = {
+        {0, 0, 1, 0, 0},
+        {0, 0, -2, 0, 0},
+        {1, -2, 0, -3, 0},
+        {0, 0, -3, 0, -5},
+        {0, 0, 0, -5, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    CHECK(g1 == expectedGraph);
+    expectedMat = {
+        {0, 0, -1, 0, 0},
+        {0, 0, -3, 0, 0},
+        {-1, -3, 0, -4, 0},
+        {0, 0, -4, 0, -6},
+        {0, 0, 0, -6, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    CHECK(--g1 == expectedGraph);
+    CHECK(g1-- == expectedGraph);
+}
+
+TEST_CASE("Multiplying a graph by a scalar")
+{
+    ariel::Graph g1;
+    vector<vector<int>> g1Mat = {
+        {0, 1, 0, 0, 0},
+        {1, 0, 3, 0, 0},
+        {0, 3, 0, 4, 0},
+        {0, 0, 4, 0, 5},
+        {0, 0, 0, 5, 0}};
+    g1.loadGraph(g1Mat);
+    g1 *= 2;
+    ariel::Graph expectedGraph;
+    vector<vector<int>> expectedMat = {
+        {0, 2, 0, 0, 0},
+        {2, 0, 6, 0, 0},
+        {0, 6, 0, 8, 0},
+        {0, 0, 8, 0, 10},
+        {0, 0, 0, 10, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    CHECK(g1 == expectedGraph);
+    g1 *= -5;
+    expectedMat = {
+        {0, -10, 0, 0, 0},
+        {-10, 0, -30, 0, 0},
+        {0, -30, 0, -40, 0},
+        {0, 0, -40, 0, -50},
+        {0, 0, 0, -50, 0}};
+    expectedGraph.loadGraph(expectedMat);
+    CHECK(g1 == expectedGraph);
+}
+
+TEST_CASE("Dividing a graph by a scalar")
+{
+    ariel::Graph g1;
+    vector<vector<int>> g4Mat = { 
+        { 0, -1, 0, 1 },
+        { 1, 0, 1, 0 },
+        { 0, -1, 0, 1 },
+        { 1, 0, 1, 0 } };
+    g1.loadGraph(g4Mat);
+    CHECK_THROWS(g1 /= 0);
+    g1 /= 2;
+    ariel::Graph expectedGraph;
+    vector<vector<int>> expectedMat = {
+        {0, 0, 0, 0},
+        {0, 0, 0, 0},
+        {0, 0, 0, 0},
+        {0, 0, 0, 0}};
+    expectedGraph.loadGraph(expectedMat);
+}
+
+TEST_CASE("Testing equality of graphs")
+{
+    ariel::Graph g1;
+    vector<vector<int>> g1Mat = {
+        {0, 0, 0, 0},
+        {4, 0, -6, 0},
+        {0, 0, 0, 5},
+        {0, -2, 0, 0}};
+    g1.loadGraph(g1Mat);
+    ariel::Graph g2;
+    vector<vector<int>> g2Mat = {
+        {0, 0, 0, 0},
+        {-4, 0, 6, 0},
+        {0, 0, 0, -5},
+        {0, 2, 0, 0}};
+    g2.loadGraph(g2Mat);
+    CHECK(g1 != g2);
+    CHECK(g2 != g1);
+    CHECK((g1 == g2) == false);
+    -g2;
+    CHECK(g1 == g2);
+    CHECK(g2 == g1);
+    CHECK(g1 <= g2);
+    CHECK(g2 <= g1);
+    CHECK(g1 >= g2);
+    CHECK(g2 >= g1);
+}
+
+TEST_CASE("Testing graph inclusion")
+{
+    ariel::Graph g1;
+    vector<vector<int>> g1Mat = {
+        {0, 0, 0, 1},
+        {0, 0, 1, 0},
+        {0, 1, 0, 1},
+        {1, 0, 1, 0}};
+    g1.loadGraph(g1Mat);
+    ariel::Graph g2;
+    vector<vector<int>> g2Mat = {
+        {0, 1, 0, 1, 0},
+        {1, 0, 1, 1, 0},
+        {0, 1, 0, 1, 0},
+        {1, 1, 1, 0, 1},
+        {0, 0, 0, 1, 0}};
+    g2.loadGraph(g2Mat);
+    CHECK(g2.isSubgraph(g1));
+    CHECK(g1 < g2);
+    CHECK(g2 > g1);
+    CHECK((g1 > g2) == false);
+    ariel::Graph g3;
+    vector<vector<int>> g3Mat = {
+        {0,1},
+        {2,0}};
+    g3.loadGraph(g3Mat);
+    ariel::Graph g4;
+    vector<vector<int>> g4Mat = {
+        {0, 1, 0},
+        {0, 0, 0},
+        {0, 0, 0}};
+    g4.loadGraph(g4Mat);
+    CHECK(g3 > g4);
+    CHECK(g4 < g3); 
+    ariel::Graph g5;
+    vector<vector<int>> g5Mat = {
+        {0, 1, 0},
+        {1, 0, 1},
+        {0, 2, 0}};
+    g5.loadGraph(g5Mat);
+    ariel::Graph g6;
+    vector<vector<int>> g6Mat = {
+        {0, 1, 1},
+        {1, 0, 2},
+        {1, 2, 0}};
+    g6.loadGraph(g6Mat);
+    CHECK(g5 > g6);
+    CHECK(g6 < g5);
+}
+
+TEST_CASE("Testing graph inequality")
+{
+    ariel::Graph g1;
+    vector<vector<int>> g1Mat = {
+        {0, 0, 0, 1},
+        {0, 0, 1, 0},
+        {0, 1, 0, 1},
+        {1, 0, 1, 0}};
+    g1.loadGraph(g1Mat);
+    ariel::Graph g2;
+    vector<vector<int>> g2Mat = {
+        {0, 1, 0, 1, 0},
+        {1, 0, 1, 1, 0},
+        {0, 1, 0, 1, 0},
+        {1, 1, 1, 0, 1},
+        {0, 0, 0, 1, 0}};
+    g2.loadGraph(g2Mat);
+    CHECK(g1 != g2);
+    CHECK((g1 == g2) == false);
+    CHECK(g1 < g2);
+
+    ariel::Graph g3;
+    g3.loadGraph(g1Mat);
+    CHECK((g1 < g3) == false);
+    CHECK((g1 > g3) == false);
+    CHECK(g1 <= g3);
+    CHECK(g1 >= g3);
+    ariel::Graph g4;
+    vector<vector<int>> g4Mat = {
+        {0, 1, 0, 1, 0},
+        {1, 0, 1, 0, 1},
+        {0, 1, 0, 1, 0},
+        {1, 0, 1, 0, 1},
+        {0, 1, 0, 1, 0}};
+    g4.loadGraph(g4Mat);
+    ariel::Graph g5;
+    vector<vector<int>> g5Mat = {
+        {0, 1, 1, 0, 1},
+        {1, 0, 1, 0, 0},
+        {1, 1, 0, 1, 0},
+        {0, 0, 1, 0, 1},
+        {1, 0, 0, 1, 0}};
+    g5.loadGraph(g5Mat);
+    CHECK((g4 < g5) == false);
+    CHECK((g5 < g4) == false);
+    CHECK((g4 > g5) == false);
+    CHECK((g5 > g4) == false);
+    CHECK(g4 != g5);
+    CHECK(g5 != g4);
+    CHECK((g4 <= g5) == false);
+    CHECK((g5 <= g4) == false);
+    CHECK((g4 >= g5) == false);
+    CHECK((g5 >= g4) == false);
+
+}
+
+
+TEST_CASE("Sparse graphs")
+{
+    // A ring of 30 vertices has 60 cells out of 900, below the default threshold.
+    size_t n = 30;
+    vector<vector<int>> ringMat(n, vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++)
+    {
+        ringMat[i][(i + 1) % n] = 1;
+        ringMat[(i + 1) % n][i] = 1;
+    }
+    ariel::Graph ring;
+    ring.loadGraph(ringMat);
+    CHECK(ring.getStorage() == ariel::Graph::Storage::Sparse);
+    CHECK(ring.getEdges() == 30);
+    CHECK(ring.isDirected() == false);
+    CHECK(ring.getAdjacencyMatrix() == ringMat);
+    CHECK(ariel::Algorithms::isConnected(ring) == 1);
+    CHECK(ariel::Algorithms::isBipartite(ring) != "0");
+    CHECK(ariel::Algorithms::shortestPath(ring, 0, 3) == "0->1->2->3");
+
+    // The same graph stored dense must behave the same.
+    double threshold = ariel::Graph::getSparseThreshold();
+    ariel::Graph::setSparseThreshold(0);
+    ariel::Graph::setBitsetStorage(false);
+    ariel::Graph::setSymmetricStorage(false);
+    ariel::Graph denseRing;
+    denseRing.loadGraph(ringMat);
+    ariel::Graph::setSparseThreshold(threshold);
+    ariel::Graph::setBitsetStorage(true);
+    ariel::Graph::setSymmetricStorage(true);
+    CHECK(denseRing.getStorage() == ariel::Graph::Storage::Dense);
+    CHECK(denseRing == ring);
+    stringstream sparseOut, denseOut;
+    sparseOut << ring;
+    denseOut << denseRing;
+    CHECK(sparseOut.str() == denseOut.str());
+
+    // Multiplying the weights keeps the graph sparse, filling it with edges of weight 1 switches to bitset storage,
+    // and other weights to symmetric storage.
+    ring *= 3;
+    CHECK(ring.getStorage() == ariel::Graph::Storage::Sparse);
+    CHECK(ring.getAdjacencyMatrix()[0][1] == 3);
+    ring *= 0;
+    CHECK(ring.getEdges() == 0);
+    vector<vector<int>> fullMat(n, vector<int>(n, 1));
+    ariel::Graph full;
+    full.loadGraph(fullMat);
+    ring += full;
+    CHECK(ring.getStorage() == ariel::Graph::Storage::Bitset);
+    CHECK(ring.getEdges() == 450);
+    ++ring;
+    CHECK(ring.getStorage() == ariel::Graph::Storage::Symmetric);
+}
+
+TEST_CASE("Graphs whose edges all weigh 1")
+{
+    // An even cycle over more than two words of vertices, with a chord every 10 vertices, too few edges for bitset storage
+    // unless sparse storage is turned off.
+    double threshold = ariel::Graph::getSparseThreshold();
+    ariel::Graph::setSparseThreshold(0);
+    size_t n = 130;
+    vector<vector<int>> cycleMat(n, vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++)
+    {
+        cycleMat[i][(i + 1) % n] = cycleMat[(i + 1) % n][i] = 1;
+        cycleMat[i][(i + 11) % n] = cycleMat[(i + 11) % n][i] = i % 10 == 0 ? 1 : 0;
+    }
+    ariel::Graph bits;
+    bits.loadGraph(cycleMat);
+    CHECK(bits.getStorage() == ariel::Graph::Storage::Bitset);
+    CHECK(bits.getAdjacencyMatrix() == cycleMat);
+    CHECK(bits.isDirected() == false);
+    CHECK(bits.getEdges() == 143);
+    CHECK(bits.getWeight(0, 11) == 1);
+    CHECK(bits.getWeight(1, 12) == 0);
+    CHECK(ariel::Algorithms::isConnected(bits) == 1);
+    CHECK(ariel::Algorithms::shortestPath(bits, 0, 12) == "0->11->12");
+
+    // The same graph kept dense must give the same results.
+    ariel::Graph::setBitsetStorage(false);
+    ariel::Graph::setSymmetricStorage(false);
+    ariel::Graph dense;
+    dense.loadGraph(cycleMat);
+    ariel::Graph::setBitsetStorage(true);
+    ariel::Graph::setSymmetricStorage(true);
+    CHECK(dense.getStorage() == ariel::Graph::Storage::Dense);
+    CHECK(bits == dense);
+    CHECK(ariel::Algorithms::isBipartite(bits) == ariel::Algorithms::isBipartite(dense));
+    CHECK(bits * bits == dense * dense);
+    CHECK((bits * bits).isDirected() == false);
+
+    // Removing one direction of an edge keeps a subgraph, and the path around the cycle still connects every vertex.
+    vector<vector<int>> pathMat = cycleMat;
+    pathMat[n - 1][0] = 0;
+    ariel::Graph path;
+    path.loadGraph(pathMat);
+    CHECK(path.getStorage() == ariel::Graph::Storage::Bitset);
+    CHECK(path.isDirected());
+    CHECK(bits.isSubgraph(path) == dense.isSubgraph(path));
+    CHECK(ariel::Algorithms::isConnected(path) == 1);
+    ariel::Graph transposed = path.transposed();
+    CHECK(transposed.getWeight(n - 1, 0) == 1);
+    CHECK(transposed.getWeight(0, n - 1) == 0);
+
+    // Weights other than 1 move the graph to symmetric storage, and back.
+    bits *= 2;
+    CHECK(bits.getStorage() == ariel::Graph::Storage::Symmetric);
+    bits /= 2;
+    CHECK(bits.getStorage() == ariel::Graph::Storage::Bitset);
+    CHECK(bits == dense);
+
+    // Negated edges of -1 weigh 1 again, so the graph goes back to bitset storage from symmetric storage too.
+    -bits;
+    CHECK(bits.getStorage() == ariel::Graph::Storage::Symmetric);
+    -bits;
+    CHECK(bits.getStorage() == ariel::Graph::Storage::Bitset);
+    CHECK(bits == dense);
+    ariel::Graph::setSparseThreshold(threshold);
+}
+
+TEST_CASE("Undirected graphs in symmetric storage")
+{
+    vector<vector<int>> mat = {
+        {0, 2, 0, -1},
+        {2, 3, 4, 0},
+        {0, 4, 0, 5},
+        {-1, 0, 5, 0}};
+    ariel::Graph g;
+    g.loadGraph(mat);
+    CHECK(g.getStorage() == ariel::Graph::Storage::Symmetric);
+    CHECK(g.isDirected() == false);
+    CHECK(g.getEdges() == g.countEdges());
+
+    // Only the upper triangle is kept, the graph is still read as the whole matrix.
+    CHECK(g.getAdjacencyMatrix() == mat);
+    CHECK(g.getWeight(3, 0) == -1);
+    CHECK(g.getWeight(0, 3) == -1);
+    CHECK(g.getRow(2)[1] == 4);
+    size_t count = 0;
+    for (ariel::Graph::Neighbour neighbour : g.getRow(3))
+    {
+        CHECK(neighbour.weight == mat[3][neighbour.vertex]);
+        count++;
+    }
+    CHECK(count == 2);
+    ariel::Graph::setSymmetricStorage(false);
+    ariel::Graph dense;
+    dense.loadGraph(mat);
+    ariel::Graph::setSymmetricStorage(true);
+    CHECK(dense.getStorage() == ariel::Graph::Storage::Dense);
+    CHECK(g == dense);
+    stringstream symmetricOut, denseOut;
+    symmetricOut << g;
+    denseOut << dense;
+    CHECK(symmetricOut.str() == denseOut.str());
+    CHECK(g.transposed() == g);
+    CHECK(ariel::Algorithms::shortestPath(g, 0, 2) == ariel::Algorithms::shortestPath(dense, 0, 2));
+
+    // Undirected results stay in symmetric storage.
+    ariel::Graph sum = g + dense * 2;
+    CHECK(sum.getStorage() == ariel::Graph::Storage::Symmetric);
+    CHECK(sum.getWeight(2, 3) == 15);
+    g += dense;
+    CHECK(g.getStorage() == ariel::Graph::Storage::Symmetric);
+    g *= 3;
+    ++g;
+    -g;
+    CHECK(g.getStorage() == ariel::Graph::Storage::Symmetric);
+    CHECK(g.getWeight(3, 2) == -31);
+    CHECK(g.getWeight(2, 0) == 0);
+    CHECK(g.getEdges() == g.countEdges());
+    g = g + sum;
+    CHECK(g.getStorage() == ariel::Graph::Storage::Symmetric);
+    CHECK(g.getWeight(1, 1) == -10);
+
+    // A directed result moves to dense storage.
+    ariel::Graph arc;
+    arc.loadGraph({{0, 0, 0, 7}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}});
+    g += arc;
+    CHECK(g.getStorage() == ariel::Graph::Storage::Dense);
+    CHECK(g.isDirected());
+    CHECK(g.getWeight(0, 3) == 9);
+    CHECK(g.getWeight(3, 0) == 2);
+    CHECK(g.getEdges() == g.countEdges());
+}
+
+TEST_CASE("Multiplying sparse graphs")
+{
+    // A directed ring with weights 1 and 2 and a few chords of weight -1, in sparse storage.
+    size_t n = 40;
+    vector<vector<int>> m1(n, vector<int>(n, 0)), m2(n, vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++)
+    {
+        m1[i][(i + 1) % n] = 1 + static_cast<int>(i % 2);
+        m2[i][(i + 3) % n] = 2;
+        m2[i][(i + 7) % n] = -1;
+    }
+    // The two paths from 0 to 10 cancel out: 1 * 2 through vertex 1 and 2 * (-1) through vertex 3.
+    m1[0][3] = 2;
+    m2[1][10] = 2;
+    ariel::Graph g1, g2;
+    g1.loadGraph(m1);
+    g2.loadGraph(m2);
+    CHECK(g1.getStorage() == ariel::Graph::Storage::Sparse);
+    CHECK(g2.getStorage() == ariel::Graph::Storage::Sparse);
+
+    double threshold = ariel::Graph::getSparseThreshold();
+    ariel::Graph::setSparseThreshold(0);
+    ariel::Graph dense1, dense2;
+    dense1.loadGraph(m1);
+    dense2.loadGraph(m2);
+    ariel::Graph::setSparseThreshold(threshold);
+
+    ariel::Graph product = g1 * g2;
+    CHECK(product.getStorage() == ariel::Graph::Storage::Sparse);
+    CHECK(product == dense1 * dense2);
+    CHECK(product.getAdjacencyMatrix() == (dense1 * dense2).getAdjacencyMatrix());
+    CHECK(product.getWeight(0, 10) == 0);
+    CHECK(product.getEdges() == (dense1 * dense2).getEdges());
+    CHECK(ariel::multiply(g1, g2, 3) == product);
+}
+
+TEST_CASE("Chains of graph operators")
+{
+    ariel::Graph g1, g2, g3;
+    g1.loadGraph({{0, 1, 2}, {1, 0, 3}, {2, 3, 0}});
+    g2.loadGraph({{0, 4, 0}, {4, 0, 1}, {0, 1, 0}});
+    g3.loadGraph({{0, 1, 0}, {0, 0, 1}, {1, 0, 0}});
+    ariel::Graph expected;
+
+    // The whole chain is computed in one pass, the matrix of the result and a row to expand each operand,
+    // g1 and g2 in symmetric storage and g3 in bitset storage, are the only allocations.
+    ariel::AllocationCounter counter;
+    ariel::Graph result = g1 + g2 - g3 * 2;
+    CHECK(counter.getAllocations() == 4);
+    expected.loadGraph({{0, 3, 2}, {5, 0, 2}, {0, 4, 0}});
+    CHECK(result == expected);
+    CHECK(result.isDirected());
+    CHECK(result.getEdges() == 5);
+
+    // Symmetric operands give a symmetric result.
+    result = 3 * (g1 - g2) + -(g1 + g2);
+    expected.loadGraph({{0, -14, 4}, {-14, 0, 2}, {4, 2, 0}});
+    CHECK(result == expected);
+    CHECK(result.isDirected() == false);
+    CHECK(result.getEdges() == 3);
+
+    // The destination may be one of the operands.
+    g1 = g1 + g1 - g2;
+    expected.loadGraph({{0, -2, 4}, {-2, 0, 5}, {4, 5, 0}});
+    CHECK(g1 == expected);
+
+    // Unary - of a graph still negates the graph itself.
+    ariel::Graph negative = g2 + -g3;
+    expected.loadGraph({{0, 3, 0}, {4, 0, 0}, {-1, 1, 0}});
+    CHECK(negative == expected);
+    expected.loadGraph({{0, -1, 0}, {0, 0, -1}, {-1, 0, 0}});
+    CHECK(g3 == expected);
+
+    ariel::Graph g4;
+    g4.loadGraph({{0, 1}, {1, 0}});
+    CHECK_THROWS(g2 + g3 - g4);
+}
+
+TEST_CASE("Operators reuse the matrices they can")
+{
+    vector<vector<int>> m1 = {{0, 1, 2}, {1, 0, 3}, {2, 3, 0}};
+    vector<vector<int>> m2 = {{0, 4, 0}, {4, 0, 1}, {0, 1, 0}};
+    ariel::Graph g1, g2, expected;
+    g2.loadGraph(m2);
+
+    // Loading from a vector the graph takes over releases the vector, loading from a vector it reads does not copy it.
+    vector<vector<int>> copy = m1;
+    ariel::AllocationCounter loadCounter;
+    g1.loadGraph(copy);
+    CHECK(loadCounter.getAllocations() == 1);
+    g1.loadGraph(move(copy));
+    CHECK(copy.empty());
+    CHECK(g1.getAdjacencyMatrix() == m1);
+
+    // The compound operators change the graph in place and return it, without copying it.
+    ariel::AllocationCounter counter;
+    ariel::Graph &same = ((+(++(g1 += g2) -= g2)) *= 3) /= 3;
+    --g1;
+    -(-g1);
+    CHECK(counter.getAllocations() == 0);
+    CHECK(&same == &g1);
+    CHECK(g1.getAdjacencyMatrix() == m1);
+    ariel::Graph temporary;
+    temporary.loadGraph(m2);
+    g1 += move(temporary);
+    expected.loadGraph({{0, 5, 2}, {5, 0, 4}, {2, 4, 0}});
+    CHECK(g1 == expected);
+
+    // A graph about to be destroyed lends its matrix to the result, only the rows of g1 and g2,
+    // in symmetric storage, are expanded.
+    ariel::Graph product = g1 * g2;
+    const int *matrix = product.getRow(0).data();
+    ariel::AllocationCounter moveCounter;
+    ariel::Graph sum = move(product) + g2 - g1;
+    CHECK(moveCounter.getAllocations() == 2);
+    CHECK(sum.getRow(0).data() == matrix);
+    expected.loadGraph({{20, 1, 3}, {-1, 24, -3}, {14, 5, 4}});
+    CHECK(sum == expected);
+    CHECK(sum.isDirected());
+    ariel::Graph difference = g2 - (g1 * g2);
+    CHECK(difference.isDirected());
+    CHECK(difference.getEdges() == 9);
+
+    ariel::Graph square = move(sum) * g2;
+    CHECK(square.getRow(0).data() == matrix);
+    expected.loadGraph({{4, 83, 1}, {96, -7, 24}, {20, 60, 5}});
+    CHECK(square == expected);
+}
+
+TEST_CASE("Edge count, direction and weights follow the operators")
+{
+    ariel::Graph g, other;
+    g.loadGraph({{0, 2, 0}, {2, 0, -1}, {0, -1, 0}});
+    CHECK(g.getEdges() == 2);
+    CHECK(g.isDirected() == false);
+    CHECK(g.getLightestWeight() == -1);
+    CHECK(g.getHeaviestWeight() == 2);
+    CHECK(g.hasNegativeWeights());
+
+    // An edge of weight -1 jumps to 1, the weights keep their order.
+    ++g;
+    CHECK(g.getLightestWeight() == 1);
+    CHECK(g.getHeaviestWeight() == 3);
+    CHECK(g.hasNegativeWeights() == false);
+    -g;
+    CHECK(g.getLightestWeight() == -3);
+    CHECK(g.getHeaviestWeight() == -1);
+    g *= -2;
+    CHECK(g.getLightestWeight() == 2);
+    CHECK(g.getHeaviestWeight() == 6);
+    g /= 3;
+    CHECK(g.getAdjacencyMatrix() == vector<vector<int>>({{0, 2, 0}, {2, 0, 0}, {0, 0, 0}}));
+    CHECK(g.getEdges() == 1);
+    CHECK(g.getLightestWeight() == 2);
+
+    other.loadGraph({{0, 0, 5}, {0, 0, 0}, {0, 0, 0}});
+    g += other;
+    CHECK(g.isDirected());
+    CHECK(g.getEdges() == 3);
+    CHECK(g.getHeaviestWeight() == 5);
+    g -= g;
+    CHECK(g.isDirected() == false);
+    CHECK(g.getEdges() == 0);
+    CHECK(g.getLightestWeight() == 0);
+    CHECK(g.getHeaviestWeight() == 0);
+
+    // The counts kept by the operators match a full scan.
+    ariel::Graph product = other * other + other;
+    CHECK(product.getEdges() == product.countEdges());
+    CHECK(product.isDirected());
+}
+
+TEST_CASE("Reading a graph without copying it")
+{
+    ariel::Graph g;
+    vector<vector<int>> graph = {
+        {0, 1, 0},
+        {1, 0, 2},
+        {0, 2, 0}};
+    // A row is only read in place in dense storage.
+    ariel::Graph::setSymmetricStorage(false);
+    g.loadGraph(graph);
+    ariel::Graph::setSymmetricStorage(true);
+    CHECK(g.getWeight(1, 2) == 2);
+    CHECK(g.getWeight(0, 2) == 0);
+    ariel::Graph::RowView row = g.getRow(1);
+    CHECK(row.size() == 3);
+    CHECK(row[0] == 1);
+    CHECK(row[1] == 0);
+    CHECK(row.data() != nullptr);
+    size_t count = 0;
+    for (ariel::Graph::Neighbour neighbour : row)
+    {
+        CHECK(neighbour.weight == graph[1][neighbour.vertex]);
+        count++;
+    }
+    CHECK(count == 2);
+
+    // The algorithms allocate the same number of times whatever the number of vertices is.
+    size_t allocations[2];
+    size_t sizes[] = {50, 500};
+    for (size_t s = 0; s < 2; s++)
+    {
+        size_t n = sizes[s];
+        vector<vector<int>> pathMat(n, vector<int>(n, 0));
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            pathMat[i][i + 1] = 1;
+            pathMat[i + 1][i] = 1;
+        }
+        ariel::Graph path;
+        path.loadGraph(pathMat);
+        stringstream out;
+        streambuf *old = cout.rdbuf(out.rdbuf());
+        ariel::AllocationCounter counter;
+        CHECK(ariel::Algorithms::isConnected(path) == 1);
+        CHECK(ariel::Algorithms::isContainsCycle(path) == false);
+        CHECK(ariel::Algorithms::isBipartite(path) != "0");
+        allocations[s] = counter.getAllocations();
+        cout.rdbuf(old);
+    }
+    CHECK(allocations[0] == allocations[1]);
+}
+
+// Records the order of the callbacks of a depth first search.
+struct RecordingVisitor : ariel::DepthFirstVisitor
+{
+    string events;
+
+    bool discover(size_t v, size_t)
+    {
+        this->events += "d" + to_string(v) + " ";
+        return true;
+    }
+    bool backEdge(size_t u, const ariel::Graph::Neighbour &edge)
+    {
+        this->events += "b" + to_string(u) + to_string(edge.vertex) + " ";
+        return true;
+    }
+    bool forwardOrCrossEdge(size_t u, const ariel::Graph::Neighbour &edge)
+    {
+        this->events += "c" + to_string(u) + to_string(edge.vertex) + " ";
+        return true;
+    }
+    bool finish(size_t v)
+    {
+        this->events += "f" + to_string(v) + " ";
+        return true;
+    }
+};
+
+TEST_CASE("Depth first search")
+{
+    ariel::Graph g;
+    vector<vector<int>> graph = {
+        {0, 1, 1, 0},
+        {0, 0, 1, 0},
+        {1, 0, 0, 0},
+        {0, 0, 1, 0}};
+    g.loadGraph(graph);
+    ariel::DepthFirstSearch search(g);
+    RecordingVisitor visitor;
+    CHECK(search.run(0, visitor));
+    CHECK(visitor.events == "d0 d1 d2 b20 f2 f1 c02 f0 ");
+    CHECK(search.isDiscovered(2));
+    CHECK(search.isDiscovered(3) == false);
+    // A second run only visits what the first one did not.
+    CHECK(search.run(3, visitor));
+    CHECK(visitor.events == "d0 d1 d2 b20 f2 f1 c02 f0 d3 c32 f3 ");
+    CHECK(search.run(1, visitor));
+    CHECK(visitor.events == "d0 d1 d2 b20 f2 f1 c02 f0 d3 c32 f3 ");
+}
+
+TEST_CASE("Shortest paths")
+{
+    // All the edges weigh the same.
+    ariel::Graph g1;
+    vector<vector<int>> graph1 = {
+        {0, 2, 2, 0},
+        {2, 0, 0, 2},
+        {2, 0, 0, 2},
+        {0, 2, 2, 0}};
+    g1.loadGraph(graph1);
+    CHECK(ariel::Algorithms::shortestPath(g1, 0, 3) == "0->1->3");
+    CHECK(ariel::Algorithms::shortestPath(g1, 2, 2) == "2");
+
+    // Non negative weights, the path with fewer edges is heavier.
+    ariel::Graph g2;
+    vector<vector<int>> graph2 = {
+        {0, 1, 9, 0},
+        {0, 0, 1, 0},
+        {0, 0, 0, 1},
+        {0, 0, 0, 0}};
+    g2.loadGraph(graph2);
+    CHECK(ariel::Algorithms::shortestPath(g2, 0, 3) == "0->1->2->3");
+    CHECK(ariel::Algorithms::shortestPath(g2, 3, 0) == "-1");
+
+    // Negative edges without a negative cycle.
+    ariel::Graph g3;
+    vector<vector<int>> graph3 = {
+        {0, 4, 2, 0},
+        {0, 0, 0, 1},
+        {0, -3, 0, 5},
+        {0, 0, 0, 0}};
+    g3.loadGraph(graph3);
+    CHECK(ariel::Algorithms::shortestPath(g3, 0, 3) == "0->2->1->3");
+
+    // A negative cycle between 1 and 2: paths through it have no minimum, paths around it are fine.
+    ariel::Graph g4;
+    vector<vector<int>> graph4 = {
+        {0, 1, 0, 0, 3},
+        {0, 0, -2, 0, 0},
+        {0, 1, 0, 1, 0},
+        {0, 0, 0, 0, 0},
+        {0, 0, 0, 0, 0}};
+    g4.loadGraph(graph4);
+    CHECK(ariel::Algorithms::shortestPath(g4, 0, 3) == "-1");
+    CHECK(ariel::Algorithms::shortestPath(g4, 0, 4) == "0->4");
+
+    CHECK_THROWS(ariel::Algorithms::shortestPath(g4, 0, 5));
+}
+
+TEST_CASE("Floyd-Warshall on several threads")
+{
+    // Three tiles of vertices: a ring of positive edges, with a negative shortcut between the first and the last tile.
+    size_t n = 150;
+    vector<vector<int>> graph(n, vector<int>(n, 0));
+    for (size_t i = 0; i < n; i++)
+    {
+        graph[i][(i + 1) % n] = 1 + static_cast<int>(i % 3);
+        graph[i][(i * 7 + 3) % n] = 5;
+    }
+    graph[140][10] = -500;
+    ariel::Graph g;
+    g.loadGraph(graph);
+
+    size_t threads = ariel::Algorithms::getThreadCount();
+    ariel::Algorithms::setThreadCount(1);
+    string sequential = ariel::Algorithms::negativeCycle(g);
+    ariel::Algorithms::setThreadCount(4);
+    CHECK(ariel::Algorithms::getThreadCount() == 4);
+    string parallel = ariel::Algorithms::negativeCycle(g);
+    ariel::Algorithms::setThreadCount(0);
+    CHECK(ariel::Algorithms::getThreadCount() >= 1);
+    ariel::Algorithms::setThreadCount(threads);
+
+    CHECK(sequential.find("The negative cycle is:") == 0);
+    CHECK(parallel == sequential);
+}
+
+TEST_CASE("All pairs shortest paths")
+{
+    ariel::Graph g;
+    vector<vector<int>> graph = {
+        {0, 4, 1, 0},
+        {0, 0, 0, 1},
+        {0, 2, 0, 6},
+        {0, 0, 0, 0}};
+    g.loadGraph(graph);
+    shared_ptr<const ariel::AllPairsPaths> paths = g.getAllPairsPaths();
+    CHECK(paths->getVertices() == 4);
+    CHECK(paths->hasNegativeCycle() == false);
+    CHECK(paths->getDistance(0, 3) == 4);
+    CHECK(paths->getDistance(2, 2) == 0);
+    CHECK(paths->getDistance(3, 0) == ariel::AllPairsPaths::NO_PATH);
+    CHECK(paths->getPath(0, 3) == vector<size_t>({0, 2, 1, 3}));
+    CHECK(paths->getPath(3, 0).empty());
+    CHECK_THROWS(paths->getDistance(0, 4));
+
+    // The result is kept until the graph changes.
+    CHECK(g.getAllPairsPaths() == paths);
+    g *= 2;
+    shared_ptr<const ariel::AllPairsPaths> doubled = g.getAllPairsPaths();
+    CHECK(doubled != paths);
+    CHECK(doubled->getDistance(0, 3) == 8);
+    CHECK(paths->getDistance(0, 3) == 4);
+    ++g;
+    CHECK(g.getAllPairsPaths()->getDistance(0, 3) == 11);
+    g -= g;
+    CHECK(g.getAllPairsPaths()->getDistance(0, 3) == ariel::AllPairsPaths::NO_PATH);
+
+    // Once the distances pass through a negative cycle, the next matrix may lead around a cycle that is not negative,
+    // here 0 -> 3 -> 0 of weight 0, while the negative cycle is 1 -> 2 -> 1.
+    ariel::Graph misleading;
+    vector<vector<int>> cycles = {
+        {0, 0, 2, 2},
+        {3, 0, -3, 0},
+        {3, -2, 0, 0},
+        {-2, 0, 0, 0}};
+    misleading.loadGraph(cycles);
+    vector<size_t> cycle = misleading.getAllPairsPaths()->getNegativeCycle();
+    REQUIRE(cycle.size() >= 3);
+    CHECK(cycle.front() == cycle.back());
+    int weight = 0;
+    for (size_t k = 0; k + 1 < cycle.size(); k++)
+    {
+        CHECK(cycles[cycle[k]][cycle[k + 1]] != 0);
+        weight += cycles[cycle[k]][cycle[k + 1]];
+    }
+    CHECK(weight < 0);
+
+    // A negative cycle makes the distances meaningless.
+    ariel::Graph h;
+    vector<vector<int>> negative = {
+        {0, 1, 0},
+        {0, 0, -3},
+        {1, 0, 0}};
+    h.loadGraph(negative);
+    CHECK(h.getAllPairsPaths()->hasNegativeCycle());
+    CHECK(h.getAllPairsPaths()->getNegativeCycle() == vector<size_t>({0, 1, 2, 0}));
+    CHECK_THROWS(h.getAllPairsPaths()->getPath(0, 2));
+    CHECK(ariel::Algorithms::negativeCycle(h) == "The negative cycle is:0->1->2->0");
+}
+
+TEST_CASE("Strongly connected components")
+{
+    // Components {0, 1, 2}, {3, 4} and {5}, with 0 -> 3, 1 -> 3 and 4 -> 5.
+    ariel::Graph g;
+    vector<vector<int>> graph = {
+        {0, 1, 0, 2, 0, 0},
+        {0, 0, 1, 5, 0, 0},
+        {1, 0, 0, 0, 0, 0},
+        {0, 0, 0, 0, 1, 0},
+        {0, 0, 0, 1, 0, 3},
+        {0, 0, 0, 0, 0, 0}};
+    g.loadGraph(graph);
+    ariel::StronglyConnectedComponents scc = ariel::Algorithms::stronglyConnectedComponents(g);
+    CHECK(scc.getVertices() == 6);
+    CHECK(scc.getComponentCount() == 3);
+    // The components finish sinks first.
+    CHECK(scc.getComponents() == vector<size_t>({2, 2, 2, 1, 1, 0}));
+    CHECK(scc.getComponent(4) == 1);
+    CHECK(scc.getSize(0) == 1);
+    CHECK(scc.getSize(1) == 2);
+    CHECK(scc.getSize(2) == 3);
+    // Both edges from {0, 1, 2} to {3, 4} are one edge of the condensation.
+    CHECK(scc.getSuccessors(2) == vector<size_t>({1}));
+    CHECK(scc.getSuccessors(1) == vector<size_t>({0}));
+    CHECK(scc.getSuccessors(0).empty());
+    CHECK_THROWS(scc.getComponent(6));
+    CHECK_THROWS(scc.getSize(3));
+    CHECK_THROWS(scc.getSuccessors(3));
+    CHECK(ariel::Algorithms::isConnected(g) == false);
+
+    // Closing the cycle through all three components makes the graph strongly connected.
+    graph[5][0] = 1;
+    g.loadGraph(graph);
+    CHECK(ariel::Algorithms::stronglyConnectedComponents(g).getComponentCount() == 1);
+    CHECK(ariel::Algorithms::isConnected(g) == true);
+
+    // In an undirected graph the components are the connected components.
+    ariel::Graph u;
+    u.loadGraph({{0, 1, 0, 0}, {1, 0, 0, 0}, {0, 0, 0, 1}, {0, 0, 1, 0}});
+    ariel::StronglyConnectedComponents halves = ariel::Algorithms::stronglyConnectedComponents(u);
+    CHECK(halves.getComponentCount() == 2);
+    CHECK(halves.getComponent(0) == halves.getComponent(1));
+    CHECK(halves.getComponent(2) != halves.getComponent(0));
+    CHECK(halves.getSuccessors(0).empty());
+    CHECK(halves.getSuccessors(1).empty());
+}
+
+TEST_CASE("Connected components kept with operator+=")
+{
+    ariel::DisjointSet sets(5);
+    CHECK(sets.getSetCount() == 5);
+    CHECK(sets.unite(0, 1));
+    CHECK(sets.unite(3, 4));
+    CHECK(sets.unite(1, 0) == false);
+    CHECK(sets.getSetCount() == 3);
+    CHECK(sets.connected(0, 1));
+    CHECK(sets.connected(1, 3) == false);
+    CHECK(sets.find(3) == sets.find(4));
+    CHECK_THROWS(sets.find(5));
+    CHECK_THROWS(sets.unite(0, 5));
+
+    // Two halves {0, 1, 2} and {3, 4, 5}, joined one edge at a time.
+    ariel::Graph g;
+    vector<vector<int>> graph(6, vector<int>(6, 0));
+    graph[0][1] = graph[1][0] = 2;
+    graph[1][2] = graph[2][1] = 2;
+    graph[3][4] = graph[4][3] = 2;
+    graph[4][5] = graph[5][4] = 2;
+    g.loadGraph(graph);
+    CHECK(ariel::Algorithms::isConnected(g) == false);
+    shared_ptr<const ariel::DisjointSet> before = g.getConnectivity();
+    CHECK(before->getSetCount() == 2);
+    CHECK(before->connected(0, 2));
+
+    vector<vector<int>> bridge(6, vector<int>(6, 0));
+    bridge[2][3] = bridge[3][2] = 1;
+    ariel::Graph delta;
+    delta.loadGraph(bridge);
+    ariel::Graph copy = g;
+    g += delta;
+    // The components were updated, not found again, and the ones held before the sum did not change.
+    shared_ptr<const ariel::DisjointSet> after = g.getConnectivity();
+    CHECK(after != before);
+    CHECK(after->getSetCount() == 1);
+    CHECK(ariel::Algorithms::isConnected(g) == true);
+    CHECK(before->getSetCount() == 2);
+    CHECK(copy.getConnectivity() == before);
+    CHECK(ariel::Algorithms::isConnected(copy) == false);
+    // Nobody else holds them now, so the next sum updates them in place.
+    before.reset();
+    copy += delta;
+    CHECK(copy.getConnectivity()->isConnected());
+
+    // A negative edge can cancel an edge out, the components are found again.
+    g += delta * -1;
+    CHECK(ariel::Algorithms::isConnected(g) == false);
+    CHECK(g.getConnectivity()->getSetCount() == 2);
+    g += delta;
+    CHECK(g.getConnectivity()->getSetCount() == 1);
+    g -= delta;
+    CHECK(ariel::Algorithms::isConnected(g) == false);
+
+    // The components are only kept for undirected graphs.
+    ariel::Graph directed;
+    directed.loadGraph({{0, 1}, {0, 0}});
+    CHECK_THROWS(directed.getConnectivity());
+}
+
+TEST_CASE("Reachability index")
+{
+    // Components {0, 1, 2}, {3, 4} and {5}, with 0 -> 3 and 4 -> 5.
+    ariel::Graph g;
+    vector<vector<int>> graph = {
+        {0, 1, 0, 2, 0, 0},
+        {0, 0, 1, 0, 0, 0},
+        {1, 0, 0, 0, 0, 0},
+        {0, 0, 0, 0, 1, 0},
+        {0, 0, 0, 1, 0, 3},
+        {0, 0, 0, 0, 0, 0}};
+    g.loadGraph(graph);
+    shared_ptr<const ariel::ReachabilityIndex> index = g.getReachability();
+    CHECK(index->getVertices() == 6);
+    CHECK(index->getComponentCount() == 3);
+    CHECK(index->isStronglyConnected() == false);
+    CHECK(index->reachable(2, 5));
+    CHECK(index->reachable(1, 0));
+    CHECK(index->reachable(4, 3));
+    CHECK(index->reachable(5, 5));
+    CHECK(index->reachable(3, 2) == false);
+    CHECK(index->reachable(5, 4) == false);
+    CHECK_THROWS(index->reachable(0, 6));
+
+    // The index is kept until the graph changes.
+    CHECK(g.getReachability() == index);
+    g += g;
+    CHECK(g.getReachability() != index);
+    CHECK(g.getReachability()->reachable(0, 5));
+
+    // An undirected graph is strongly connected when it is connected.
+    ariel::Graph path;
+    path.loadGraph({{0, 1, 0}, {1, 0, 1}, {0, 1, 0}});
+    CHECK(path.getReachability()->isStronglyConnected());
+    CHECK(path.getReachability()->isStronglyConnected() == ariel::Algorithms::isConnected(path));
+
+    // More than 64 components, each one a single vertex: i reaches j exactly when i divides j.
+    size_t n = 150;
+    vector<vector<int>> chains(n, vector<int>(n, 0));
+    for (size_t i = 1; i < n; i++)
+    {
+        for (size_t j = 2 * i; j < n; j += i)
+        {
+            chains[i][j] = 1;
+        }
+    }
+    ariel::Graph multiples;
+    multiples.loadGraph(chains);
+    shared_ptr<const ariel::ReachabilityIndex> divides = multiples.getReachability();
+    CHECK(divides->getComponentCount() == n);
+    bool same = true;
+    for (size_t i = 1; i < n; i++)
+    {
+        for (size_t j = 1; j < n; j++)
+        {
+            same = same && divides->reachable(i, j) == (j % i == 0);
+        }
+    }
+    CHECK(same);
+}
+
+TEST_CASE("Weight types")
+{
+    // 8 bit weights print as numbers, and the operators work on them like on ints.
+    ariel::BasicGraph<int8_t> small;
+    small.loadGraph({{0, 2, 0}, {3, 0, -1}, {0, 4, 0}});
+    stringstream out;
+    out << small;
+    CHECK(out.str() == "[0, 2, 0], \n[3, 0, -1], \n[0, 4, 0]\n\n");
+    ++small;
+    CHECK(small.getWeight(1, 2) == 1);
+    CHECK(small.getHeaviestWeight() == 5);
+    ariel::BasicGraph<int8_t> sum = small + small * 2;
+    CHECK(sum.getWeight(2, 1) == 15);
+    CHECK((small * small).getWeight(0, 0) == 12);
+    CHECK(ariel::Algorithms::shortestPath(small, 0, 2) == "0->1->2");
+
+    // The distances of 8 bit weights are ints, a path can be longer than any weight.
+    ariel::BasicGraph<int8_t> chain;
+    chain.loadGraph({{0, 100, 0, 0}, {0, 0, 100, 0}, {0, 0, 0, 100}, {0, 0, 0, 0}});
+    CHECK(chain.getAllPairsPaths()->getDistance(0, 3) == 300);
+    CHECK(chain.getAllPairsPaths()->getDistance(3, 0) == ariel::BasicAllPairsPaths<int8_t>::NO_PATH);
+
+    // 64 bit weights beyond the range of int.
+    int64_t heavy = 3000000000LL;
+    ariel::BasicGraph<int64_t> wide;
+    wide.loadGraph({{0, heavy, 0}, {heavy, 0, heavy}, {0, heavy, 0}});
+    CHECK(wide.getAllPairsPaths()->getDistance(0, 2) == 2 * heavy);
+    ariel::BasicGraph<int64_t> doubled = wide * 2;
+    CHECK(doubled.getHeaviestWeight() == 2 * heavy);
+    CHECK(ariel::Algorithms::isConnected(wide) == 1);
+
+    // Floating point weights, no path is infinitely long.
+    ariel::BasicGraph<double> real;
+    real.loadGraph({{0, 0.5, 2}, {0, 0, 0.25}, {0, 0, 0}});
+    CHECK(ariel::Algorithms::shortestPath(real, 0, 2) == "0->1->2");
+    CHECK(real.getAllPairsPaths()->getDistance(0, 2) == 0.75);
+    CHECK(real.getAllPairsPaths()->getDistance(2, 0) == ariel::BasicAllPairsPaths<double>::NO_PATH);
+    real /= 2;
+    CHECK(real.getWeight(1, 2) == 0.125);
+    ariel::BasicGraph<double> cycle;
+    cycle.loadGraph({{0, 0.5}, {-0.75, 0}});
+    CHECK(ariel::Algorithms::negativeCycle(cycle) == "The negative cycle is:0->1->0");
+
+    // -0.0 is no edge, like 0.0.
+    ariel::BasicGraph<float> zero, negativeZero;
+    zero.loadGraph({{0, 1.5f}, {0, 0}});
+    negativeZero.loadGraph({{-0.0f, 1.5f}, {0, -0.0f}});
+    CHECK(negativeZero.getEdges() == 1);
+    CHECK(zero == negativeZero);
+}
+
+TEST_CASE("Loading a graph from its edges")
+{
+    // A repeated edge keeps its last weight, an edge of weight 0 is no edge.
+    ariel::Graph directed;
+    directed.loadEdges(4, {{0, 1, 5}, {2, 3, 1}, {0, 1, 7}, {3, 0, 0}, {1, 2, 2}}, true);
+    ariel::Graph fromMatrix;
+    fromMatrix.loadGraph({{0, 7, 0, 0}, {0, 0, 2, 0}, {0, 0, 0, 1}, {0, 0, 0, 0}});
+    CHECK(directed == fromMatrix);
+    CHECK(directed.getEdges() == 3);
+    CHECK(directed.isDirected());
+
+    // An undirected edge is given once and stands for both cells.
+    ariel::Graph undirected;
+    undirected.loadEdges(3, {{0, 1, 4}, {2, 1, 3}}, false);
+    CHECK(undirected.getAdjacencyMatrix() == vector<vector<int>>({{0, 4, 0}, {4, 0, 3}, {0, 3, 0}}));
+    CHECK(undirected.getEdges() == 2);
+    CHECK(!undirected.isDirected());
+
+    // Directed edges that all have their reverse edge make an undirected graph, like loadGraph.
+    ariel::Graph mirrored;
+    mirrored.loadEdges(2, {{0, 1, 6}, {1, 0, 6}}, true);
+    CHECK(!mirrored.isDirected());
+    CHECK(mirrored.getEdges() == 1);
+
+    CHECK_THROWS(directed.loadEdges(0, {}, true));
+    CHECK_THROWS(directed.loadEdges(2, {{0, 2, 1}}, true));
+}
+
+TEST_CASE("Random graph generators")
+{
+    // The same seed gives the same graph, another seed another graph.
+    ariel::Graph random = ariel::GraphGenerator::erdosRenyi(200, 0.05, true, 1, 9, 42);
+    CHECK(random == ariel::GraphGenerator::erdosRenyi(200, 0.05, true, 1, 9, 42));
+    CHECK(random != ariel::GraphGenerator::erdosRenyi(200, 0.05, true, 1, 9, 43));
+    // 200 * 199 possible edges, about 1990 of them, the weights in range and no loops.
+    CHECK(random.getEdges() > 1700);
+    CHECK(random.getEdges() < 2300);
+    CHECK(random.getLightestWeight() >= 1);
+    CHECK(random.getHeaviestWeight() <= 9);
+    bool loops = false;
+    for (size_t v = 0; v < 200; v++)
+    {
+        loops = loops || random.getWeight(v, v) != 0;
+    }
+    CHECK(!loops);
+    ariel::Graph complete = ariel::GraphGenerator::erdosRenyi(10, 1.0, false, 1, 1, 1);
+    CHECK(complete.getEdges() == 45);
+    CHECK(ariel::GraphGenerator::erdosRenyi(10, 0.0, true, 1, 1, 1).getEdges() == 0);
+
+    // A clique of m + 1 vertices, then m edges for every other vertex.
+    ariel::Graph preferential = ariel::GraphGenerator::barabasiAlbert(100, 3, 1, 5, 7);
+    CHECK(preferential.getEdges() == 6 + 3 * 96);
+    CHECK(!preferential.isDirected());
+    CHECK(ariel::Algorithms::isConnected(preferential) == 1);
+
+    // 2^scale vertices, at most edgeFactor * 2^scale edges.
+    ariel::Graph kronecker = ariel::GraphGenerator::rmat(8, 8, 0.57, 0.19, 0.19, true, 1, 3, 11);
+    CHECK(kronecker.getVertices() == 256);
+    CHECK(kronecker.getEdges() <= 8 * 256);
+    CHECK(kronecker.getEdges() > 1000);
+
+    // A 3 x 4 grid has 3 * 3 horizontal and 2 * 4 vertical edges.
+    ariel::Graph lattice = ariel::GraphGenerator::grid(3, 4, 1, 1, 0);
+    CHECK(lattice.getEdges() == 17);
+    CHECK(lattice.getWeight(5, 6) == 1);
+    CHECK(lattice.getWeight(5, 9) == 1);
+    CHECK(lattice.getWeight(3, 4) == 0);
+    CHECK(ariel::Algorithms::isBipartite(lattice) != "0");
+
+    ariel::Graph line = ariel::GraphGenerator::path(6, true, 2, 2, 0);
+    CHECK(ariel::Algorithms::shortestPath(line, 0, 5) == "0->1->2->3->4->5");
+    CHECK(ariel::Algorithms::shortestPath(line, 5, 0) == "-1");
+
+    ariel::Graph dag = ariel::GraphGenerator::acyclic(60, 0.3, 1, 9, 5);
+    CHECK(dag.getEdges() > 300);
+    CHECK(ariel::Algorithms::isContainsCycle(dag) == false);
+
+    ariel::Graph sides = ariel::GraphGenerator::bipartite(20, 30, 0.2, -3, 3, 9);
+    CHECK(sides.getVertices() == 50);
+    CHECK(sides.getWeight(3, 7) == 0);
+    CHECK(ariel::Algorithms::isBipartite(sides) != "0");
+
+    // The planted cycle is the only negative one, so it is the one found.
+    ariel::Graph planted = ariel::GraphGenerator::negativeCycle(30, 0.1, 4, 9, 3);
+    CHECK(planted.getLightestWeight() == -1);
+    string cycle = ariel::Algorithms::negativeCycle(planted);
+    CHECK(cycle.find("The negative cycle is:") == 0);
+    CHECK(ariel::GraphGenerator::erdosRenyi(30, 0.1, true, 1, 9, 3) != planted);
+    CHECK(ariel::Algorithms::negativeCycle(ariel::GraphGenerator::erdosRenyi(30, 0.1, true, 1, 9, 3)) == "The graph does not contain a negative cycle");
+
+    // Other weight types.
+    ariel::BasicGraph<int8_t> narrow = ariel::GraphGenerator::erdosRenyi<int8_t>(50, 0.2, false, -100, 100, 1);
+    CHECK(narrow.getLightestWeight() >= -100);
+    CHECK(narrow.getHeaviestWeight() <= 100);
+    ariel::BasicGraph<double> real = ariel::GraphGenerator::grid(5, 5, 0.5, 1.5, 2);
+    CHECK(real.getLightestWeight() >= 0.5);
+    CHECK(real.getHeaviestWeight() <= 1.5);
+
+    CHECK_THROWS(ariel::GraphGenerator::erdosRenyi(10, 1.5, true, 1, 9, 0));
+    CHECK_THROWS(ariel::GraphGenerator::erdosRenyi(10, 0.5, true, 0, 0, 0));
+    CHECK_THROWS(ariel::GraphGenerator::erdosRenyi(10, 0.5, true, 9, 1, 0));
+    CHECK_THROWS(ariel::GraphGenerator::barabasiAlbert(10, 0, 1, 9, 0));
+    CHECK_THROWS(ariel::GraphGenerator::rmat(4, 4, 0.6, 0.3, 0.3, true, 1, 9, 0));
+    CHECK_THROWS(ariel::GraphGenerator::negativeCycle(10, 0.5, 11, 9, 0));
+}
+
+TEST_CASE("Saving a graph to a binary file and mapping it back")
+{
+    const string path = "test_graph.bin";
+    // A graph in every storage, and one of another weight type.
+    vector<ariel::Graph> graphs = {ariel::GraphGenerator::erdosRenyi(100, 0.5, true, -4, 9, 1),
+                                   ariel::GraphGenerator::erdosRenyi(200, 0.02, true, 1, 9, 2),
+                                   ariel::GraphGenerator::erdosRenyi(130, 0.5, true, 1, 1, 3),
+                                   ariel::GraphGenerator::erdosRenyi(100, 0.5, false, 1, 9, 4)};
+    vector<ariel::Graph::Storage> storages = {ariel::Graph::Storage::Dense, ariel::Graph::Storage::Sparse,
+                                              ariel::Graph::Storage::Bitset, ariel::Graph::Storage::Symmetric};
+    for (size_t i = 0; i < graphs.size(); i++)
+    {
+        CHECK(graphs[i].getStorage() == storages[i]);
+        graphs[i].saveBinary(path);
+        // The arrays are used in place, no buffer is allocated for them.
+        ariel::Graph loaded;
+        size_t buffers = ariel::alignedBufferAllocations().load();
+        loaded.loadBinary(path);
+        CHECK(ariel::alignedBufferAllocations().load() == buffers);
+        CHECK(loaded.getStorage() == storages[i]);
+        CHECK(loaded == graphs[i]);
+        CHECK(loaded.getAdjacencyMatrix() == graphs[i].getAdjacencyMatrix());
+        CHECK(loaded.getEdges() == graphs[i].getEdges());
+        CHECK(loaded.isDirected() == graphs[i].isDirected());
+        CHECK(loaded.getLightestWeight() == graphs[i].getLightestWeight());
+        CHECK(loaded.getHeaviestWeight() == graphs[i].getHeaviestWeight());
+        CHECK(ariel::Algorithms::shortestPath(loaded, 0, 5) == ariel::Algorithms::shortestPath(graphs[i], 0, 5));
+
+        // Changing the mapped graph does not change the file, and a copy outlives the graph it was copied from.
+        ariel::Graph copy = loaded;
+        loaded *= 2;
+        CHECK(loaded != graphs[i]);
+        ariel::Graph again;
+        again.loadBinary(path);
+        CHECK(again == graphs[i]);
+        loaded = ariel::Graph();
+        CHECK(copy == graphs[i]);
+    }
+
+    ariel::BasicGraph<double> real = ariel::GraphGenerator::grid(6, 6, 0.5, 1.5, 2);
+    real.saveBinary(path);
+    ariel::BasicGraph<double> loadedReal;
+    loadedReal.loadBinary(path);
+    CHECK(loadedReal == real);
+    ariel::Graph wrongType;
+    CHECK_THROWS(wrongType.loadBinary(path));
+
+    {
+        ofstream damaged(path, ios::binary | ios::trunc);
+        damaged << "not a graph file, but longer than the header of one, so the header is read and rejected"
+                << "................................................................................................";
+    }
+    CHECK_THROWS(wrongType.loadBinary(path));
+    // A file cut short has arrays past its end.
+    graphs[0].saveBinary(path);
+    {
+        ifstream in(path, ios::binary);
+        string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        ofstream cut(path, ios::binary | ios::trunc);
+        cut.write(bytes.data(), static_cast<streamsize>(bytes.size() / 2));
+    }
+    CHECK_THROWS(wrongType.loadBinary(path));
+    remove(path.c_str());
+    CHECK_THROWS(wrongType.loadBinary(path));
+}
+
+// Writes text to a file, replacing it.
+static void writeText(const string &path, const string &text)
+{
+    ofstream file(path, ios::binary | ios::trunc);
+    file << text;
+}
+
+TEST_CASE("Loading a graph from a text file")
+{
+    const string path = "test_graph.txt";
+
+    // Comments, blank lines, \r\n, a missing weight, a repeated edge and an edge of weight 0.
+    writeText(path, "# an edge list\n0 1 5\r\n\n% another comment\n2 3\n  0 1 7  \n3 0 0\n1 2 -2\n");
+    ariel::Graph edges;
+    edges.loadEdgeList(path, true);
+    CHECK(edges.getAdjacencyMatrix() == vector<vector<int>>({{0, 7, 0, 0}, {0, 0, -2, 0}, {0, 0, 0, 1}, {0, 0, 0, 0}}));
+    edges.loadEdgeList(path, false);
+    CHECK(edges.getAdjacencyMatrix() == vector<vector<int>>({{0, 7, 0, 0}, {7, 0, -2, 0}, {0, -2, 0, 1}, {0, 0, 1, 0}}));
+
+    // A file of more than one chunk, parsed on several threads, is the graph it was written from.
+    ariel::Graph random = ariel::GraphGenerator::erdosRenyi(3000, 0.02, true, -50, 50, 8);
+    string text;
+    for (size_t i = 0; i < random.getVertices(); i++)
+    {
+        for (ariel::Graph::Neighbour neighbour : random.neighbours(i))
+        {
+            text += to_string(i) + " " + to_string(neighbour.vertex) + " " + to_string(neighbour.weight) + "\n";
+        }
+    }
+    CHECK(text.size() > 2 * 1024 * 1024);
+    writeText(path, text);
+    size_t threads = ariel::Algorithms::getThreadCount();
+    ariel::Algorithms::setThreadCount(4);
+    ariel::Graph parsed;
+    parsed.loadEdgeList(path, true);
+    ariel::Algorithms::setThreadCount(threads);
+    CHECK(parsed == random);
+
+    // DIMACS: vertices from 1, the number of vertices from the problem line.
+    writeText(path, "c a shortest path problem\np sp 4 3\nc the arcs\na 1 2 3\na 2 3 4\na 4 1 -1\n");
+    ariel::Graph dimacs;
+    dimacs.loadDimacs(path);
+    CHECK(dimacs.getAdjacencyMatrix() == vector<vector<int>>({{0, 3, 0, 0}, {0, 0, 4, 0}, {0, 0, 0, 0}, {-1, 0, 0, 0}}));
+
+    // Matrix Market: a general integer matrix, a symmetric pattern and real values.
+    writeText(path, "%%MatrixMarket matrix coordinate integer general\n% a comment\n3 3 2\n1 2 4\n3 1 -6\n");
+    ariel::Graph market;
+    market.loadMatrixMarket(path);
+    CHECK(market.getAdjacencyMatrix() == vector<vector<int>>({{0, 4, 0}, {0, 0, 0}, {-6, 0, 0}}));
+    writeText(path, "%%MatrixMarket matrix coordinate pattern symmetric\n3 3 2\n2 1\n3 2\n");
+    market.loadMatrixMarket(path);
+    CHECK(market.getAdjacencyMatrix() == vector<vector<int>>({{0, 1, 0}, {1, 0, 1}, {0, 1, 0}}));
+    CHECK(!market.isDirected());
+    writeText(path, "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 2 0.25\n");
+    ariel::BasicGraph<double> real;
+    real.loadMatrixMarket(path);
+    CHECK(real.getWeight(0, 1) == 0.25);
+    CHECK_THROWS(market.loadMatrixMarket(path));
+
+    // The first line that is not valid is reported with its number.
+    writeText(path, "0 1 2\n1 2 3\n1 2 3 4\n2 0 x\n");
+    CHECK_THROWS_WITH(edges.loadEdgeList(path, true), "test_graph.txt:3: unexpected text after the edge");
+    writeText(path, "0 1 300\n");
+    ariel::BasicGraph<int8_t> narrow;
+    CHECK_THROWS(narrow.loadEdgeList(path, true));
+    writeText(path, "0 1 -128\n");
+    narrow.loadEdgeList(path, true);
+    CHECK(narrow.getWeight(0, 1) == -128);
+    writeText(path, "p sp 2 1\na 1 3 1\n");
+    CHECK_THROWS_WITH(dimacs.loadDimacs(path), "test_graph.txt:2: the vertex is not one of 1 .. n");
+    // A vertex far beyond the size of the file is a damaged line, not a graph to allocate.
+    writeText(path, "0 1\n0 4000000000000\n");
+    CHECK_THROWS_WITH_AS(edges.loadEdgeList(path, true), "test_graph.txt:2: the vertex is too large for the size of the file", invalid_argument);
+    writeText(path, "0 1000000\n");
+    edges.loadEdgeList(path, false);
+    CHECK(edges.getVertices() == 1000001);
+    writeText(path, "p sp 4000000000000 1\na 1 2 1\n");
+    CHECK_THROWS_WITH(dimacs.loadDimacs(path), "test_graph.txt:1: the number of vertices is too large for the size of the file");
+    writeText(path, "%%MatrixMarket matrix coordinate integer general\n4000000000000 4000000000000 1\n1 2 1\n");
+    CHECK_THROWS_WITH(market.loadMatrixMarket(path), "test_graph.txt:2: the number of vertices is too large for the size of the file");
+    writeText(path, "%%MatrixMarket matrix coordinate integer general\n2 3 0\n");
+    CHECK_THROWS(market.loadMatrixMarket(path));
+    writeText(path, "%%MatrixMarket matrix array integer general\n2 2\n1\n2\n3\n4\n");
+    CHECK_THROWS(market.loadMatrixMarket(path));
+    writeText(path, "");
+    CHECK_THROWS(edges.loadEdgeList(path, true));
+    CHECK_THROWS(dimacs.loadDimacs(path));
+    remove(path.c_str());
+    CHECK_THROWS(edges.loadEdgeList(path, true));
+}
+
+// Prints a graph with showbase, which does not change decimal numbers but sends every cell through << one at a time.
+template <typename W>
+static string printCells(const ariel::BasicGraph<W> &g, streamsize precision)
+{
+    ostringstream out;
+    out << showbase << setprecision(precision) << g;
+    return out.str();
+}
+
+TEST_CASE("Printing a graph through a buffer")
+{
+    // Every storage, and a graph printed in many blocks of the buffer.
+    vector<ariel::Graph> graphs = {ariel::GraphGenerator::erdosRenyi(100, 0.5, true, -400, 900, 1),
+                                   ariel::GraphGenerator::erdosRenyi(200, 0.02, true, 1, 9, 2),
+                                   ariel::GraphGenerator::erdosRenyi(130, 0.5, true, 1, 1, 3),
+                                   ariel::GraphGenerator::erdosRenyi(100, 0.5, false, -9, 9, 4),
+                                   ariel::GraphGenerator::erdosRenyi(1000, 0.3, true, -99999, 99999, 5)};
+    for (const ariel::Graph &g : graphs)
+    {
+        ostringstream out;
+        out << g;
+        CHECK(out.str() == printCells(g, 6));
+    }
+    ariel::Graph empty;
+    ostringstream emptyOut;
+    emptyOut << empty;
+    CHECK(emptyOut.str() == "\n");
+
+    ariel::BasicGraph<int64_t> wide;
+    wide.loadGraph({{0, numeric_limits<int64_t>::min()}, {numeric_limits<int64_t>::max(), 0}});
+    ostringstream wideOut;
+    wideOut << wide;
+    CHECK(wideOut.str() == "[0, -9223372036854775808], \n[9223372036854775807, 0]\n\n");
+
+    ariel::BasicGraph<double> real;
+    real.loadGraph({{0, 0.5, -1e-7}, {1e300, 0, 1.0 / 3}, {-2.25, 123456789.0, 0}});
+    ostringstream realOut;
+    realOut << real;
+    CHECK(realOut.str() == "[0, 0.5, -1e-07], \n[1e+300, 0, 0.333333], \n[-2.25, 1.23457e+08, 0]\n\n");
+    ostringstream preciseOut;
+    preciseOut << setprecision(17) << real;
+    CHECK(preciseOut.str() == printCells(real, 17));
+
+    // Flags that change the numbers are still honoured.
+    ariel::Graph small;
+    small.loadGraph({{0, 2}, {-3, 0}});
+    ostringstream signedOut;
+    signedOut << showpos << small;
+    CHECK(signedOut.str() == "[+0, +2], \n[-3, +0]\n\n");
+    ostringstream fixedOut;
+    fixedOut << fixed << setprecision(1) << real;
+    CHECK(fixedOut.str().substr(0, 21) == "[0.0, 0.5, -0.0], \n[1");
+
+    // writeMatrix writes the same text straight to a file descriptor.
+    FILE *file = tmpfile();
+    REQUIRE(file != nullptr);
+    graphs[0].writeMatrix(fileno(file));
+    real.writeMatrix(fileno(file));
+    string expected = printCells(graphs[0], 6) + realOut.str();
+    string written(expected.size() + 1, '\0');
+    rewind(file);
+    written.resize(fread(&written[0], 1, written.size(), file));
+    fclose(file);
+    CHECK(written == expected);
+    CHECK_THROWS(small.writeMatrix(-1));
+}
+
+// The lightest and heaviest weights of a graph, from a full scan of its matrix.
+template <typename W>
+static pair<W, W> scanWeights(const ariel::BasicGraph<W> &g)
+{
+    W lightest = numeric_limits<W>::max(), heaviest = numeric_limits<W>::lowest();
+    for (const vector<W> &row : g.getAdjacencyMatrix())
+    {
+        for (W w : row)
+        {
+            if (w != 0)
+            {
+                lightest = min(lightest, w);
+                heaviest = max(heaviest, w);
+            }
+        }
+    }
+    return {lightest, heaviest};
+}
+
+TEST_CASE("Weights that change order under ++, -- and unary -")
+{
+    // -1 jumps to 1, past -0.5 that goes to 0.5.
+    ariel::BasicGraph<double> real;
+    real.loadGraph({{0, -1}, {-0.5, 0}});
+    ++real;
+    CHECK(real.getLightestWeight() == 0.5);
+    CHECK(real.getHeaviestWeight() == 1);
+    --real;
+    CHECK(real.getLightestWeight() == -1);
+    CHECK(real.getHeaviestWeight() == -0.5);
+
+    // The heaviest 8 bit weight wraps around to the lightest, and back.
+    ariel::BasicGraph<int8_t> small;
+    small.loadGraph({{0, 127}, {1, 0}});
+    ++small;
+    CHECK(small.getLightestWeight() == -128);
+    CHECK(small.getHeaviestWeight() == 2);
+    CHECK(small.hasNegativeWeights());
+    CHECK(ariel::Algorithms::negativeCycle(small) == "The negative cycle is:0->1->0");
+    --small;
+    CHECK(small.getLightestWeight() == 1);
+    CHECK(small.getHeaviestWeight() == 127);
+    -small;
+    --small;
+    CHECK(small.getLightestWeight() == -128);
+    CHECK(small.getHeaviestWeight() == -2);
+    // -(-128) is -128 again.
+    -small;
+    CHECK(small.getLightestWeight() == -128);
+    CHECK(small.getHeaviestWeight() == 2);
+
+    // The same in sparse and symmetric storage, against a full scan.
+    ariel::BasicGraph<int8_t> sparse, symmetric;
+    vector<vector<int8_t>> cells(40, vector<int8_t>(40, 0));
+    cells[0][1] = 127;
+    cells[2][3] = -128;
+    cells[5][6] = -1;
+    sparse.loadGraph(cells);
+    CHECK(sparse.getStorage() == ariel::BasicGraph<int8_t>::Storage::Sparse);
+    symmetric.loadGraph({{0, 127, -1}, {127, 0, -128}, {-1, -128, 0}});
+    CHECK(symmetric.getStorage() == ariel::BasicGraph<int8_t>::Storage::Symmetric);
+    for (ariel::BasicGraph<int8_t> *g : {&sparse, &symmetric})
+    {
+        ++*g;
+        CHECK(make_pair(g->getLightestWeight(), g->getHeaviestWeight()) == scanWeights(*g));
+        -*g;
+        CHECK(make_pair(g->getLightestWeight(), g->getHeaviestWeight()) == scanWeights(*g));
+        --*g;
+        --*g;
+        CHECK(make_pair(g->getLightestWeight(), g->getHeaviestWeight()) == scanWeights(*g));
+    }
+}
+
+TEST_CASE("Floyd-Warshall distances do not overflow")
+{
+    // A path of two 32 bit weights is longer than any int.
+    ariel::Graph g;
+    g.loadGraph({{0, 1500000000, 0}, {0, 0, 1500000000}, {0, 0, 0}});
+    CHECK(g.getAllPairsPaths()->getDistance(0, 2) == 3000000000LL);
+    CHECK(g.getAllPairsPaths()->getDistance(2, 0) == ariel::AllPairsPaths::NO_PATH);
+    g.loadGraph({{0, numeric_limits<int>::min(), 0}, {0, 0, numeric_limits<int>::min()}, {numeric_limits<int>::max(), 0, 0}});
+    CHECK(g.getAllPairsPaths()->hasNegativeCycle());
+
+    // 64 bit weights that Floyd-Warshall can't add without overflowing are rejected.
+    int64_t huge = numeric_limits<int64_t>::max() / 2;
+    ariel::BasicGraph<int64_t> wide;
+    wide.loadGraph({{0, huge - 1}, {0, 0}});
+    CHECK(wide.getAllPairsPaths()->getDistance(0, 1) == huge - 1);
+    wide.loadGraph({{0, huge}, {0, 0}});
+    CHECK_THROWS_AS(wide.getAllPairsPaths(), invalid_argument);
+    wide.loadGraph({{0, -huge}, {0, 0}});
+    CHECK_THROWS_AS(ariel::Algorithms::negativeCycle(wide), invalid_argument);
+}
+
+TEST_CASE("Expressions as operands of <<, comparisons and products")
+{
+    ariel::Graph g1, g2, g3;
+    g1.loadGraph({{0, 1, 0}, {1, 0, 1}, {0, 1, 0}});
+    g2.loadGraph({{0, 2, 0}, {2, 0, 0}, {0, 0, 0}});
+    g3.loadGraph({{0, 3, 0}, {3, 0, 1}, {0, 1, 0}});
+
+    stringstream out;
+    out << (g1 + g2);
+    CHECK(out.str() == "[0, 3, 0], \n[3, 0, 1], \n[0, 1, 0]\n\n");
+
+    CHECK((g1 + g2) == g3);
+    CHECK(g3 == (g1 + g2));
+    CHECK((g1 + g2) == (g3 - g2 + g2));
+    CHECK((g1 - g2) != g3);
+    CHECK(g1 != (g3 * 2));
+    CHECK(g2 < (g1 + g2));
+    CHECK((g1 + g2) <= g3);
+    CHECK((g1 + g2) > g2);
+    CHECK(g3 >= (g1 + g2));
+
+    ariel::Graph product = g1 * g3;
+    CHECK(g1 * (g2 + g1) == product);
+    CHECK((g1 + g2) * g1 == g3 * g1);
+    CHECK((g3 - g2) * (g1 + g2) == product);
+    ariel::Graph larger;
+    larger.loadGraph({{0, 1}, {1, 0}});
+    CHECK_THROWS(larger * (g1 + g2));
+}
+
+TEST_CASE("A graph that was moved from is empty")
+{
+    ariel::Graph g;
+    g.loadGraph({{0, 1, 0}, {1, 0, 2}, {0, 2, 0}});
+    CHECK(ariel::Algorithms::isConnected(g) == 1);
+    ariel::Graph h(move(g));
+    CHECK(h.getVertices() == 3);
+    CHECK(h.getEdges() == 2);
+    CHECK(ariel::Algorithms::isConnected(h) == 1);
+    CHECK(g.getVertices() == 0);
+    CHECK(g.getEdges() == 0);
+    CHECK(g.getAdjacencyMatrix().empty());
+    CHECK(g.getLightestWeight() == 0);
+    CHECK(g.getHeaviestWeight() == 0);
+    CHECK(g.isDirected() == false);
+
+    // The moved from graph can be loaded and used again.
+    g.loadGraph({{0, 5}, {0, 0}});
+    CHECK(g.getEdges() == 1);
+    CHECK(g.getWeight(0, 1) == 5);
+    size_t neighbours = 0;
+    for (ariel::Graph::Neighbour neighbour : g.neighbours(0))
+    {
+        neighbours += neighbour.vertex;
+    }
+    CHECK(neighbours == 1);
+
+    // The same for move assignment, in every storage.
+    vector<ariel::Graph> graphs = {ariel::GraphGenerator::erdosRenyi(100, 0.5, true, -4, 9, 1),
+                                   ariel::GraphGenerator::erdosRenyi(200, 0.02, true, 1, 9, 2),
+                                   ariel::GraphGenerator::erdosRenyi(130, 0.5, true, 1, 1, 3),
+                                   ariel::GraphGenerator::erdosRenyi(100, 0.5, false, 1, 9, 4)};
+    for (ariel::Graph &source : graphs)
+    {
+        ariel::Graph copy = source;
+        ariel::Graph target;
+        target = move(source);
+        CHECK(target == copy);
+        CHECK(source.getVertices() == 0);
+        CHECK(source.getStorage() == ariel::Graph::Storage::Dense);
+        CHECK(source == ariel::Graph());
+        source = move(target);
+        CHECK(source == copy);
+    }
+}
+
+TEST_CASE("An exception thrown by the body of a parallel loop")
+{
+    ariel::ThreadPool &pool = ariel::ThreadPool::instance();
+    // Index 0 runs on the calling thread, index 3 on a thread of the pool unless the calling thread steals it first.
+    for (size_t thrower : {size_t(0), size_t(3)})
+    {
+        atomic<size_t> calls(0);
+        CHECK_THROWS_AS(pool.parallelFor(4, 4, [&](size_t i)
+        {
+            calls++;
+            if (i == thrower)
+            {
+                throw runtime_error("body failed");
+            }
+        }), runtime_error);
+        CHECK(calls.load() >= 1);
+    }
+
+    // The next loop still runs on several threads: every call waits until all four have started.
+    atomic<size_t> started(0);
+    atomic<bool> together(true);
+    pool.parallelFor(4, 4, [&](size_t)
+    {
+        started++;
+        chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(10);
+        while (started.load() < 4 && chrono::steady_clock::now() < deadline)
+        {
+            this_thread::yield();
+        }
+        together = together && started.load() == 4;
+    });
+    CHECK(together.load());
+
+    // A loop inside a loop that throws runs on the calling thread, and its exception leaves the outer loop.
+    CHECK_THROWS_AS(pool.parallelFor(4, 4, [&](size_t)
+    {
+        pool.parallelFor(2, 2, [](size_t j)
+        {
+            if (j == 1)
+            {
+                throw invalid_argument("inner body failed");
+            }
+        });
+    }), invalid_argument);
+}
+
+TEST_CASE("Connected components queried from several threads")
+{
+    // The copies share the components of g, the queries only read them. The answers come from a set of their own.
+    ariel::Graph g = ariel::GraphGenerator::erdosRenyi(300, 0.004, false, 1, 9, 7);
+    g.getConnectivity();
+    ariel::DisjointSet reference(g);
+    size_t sets = reference.getSetCount();
+    vector<size_t> representative(300);
+    for (size_t v = 0; v < 300; v++)
+    {
+        representative[v] = reference.find(v);
+    }
+    vector<ariel::Graph> copies(4, g);
+    vector<int> matches(4, 0);
+    vector<thread> threads;
+    for (size_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            bool same = ariel::Algorithms::isConnected(copies[t]) == (sets == 1 ? 1 : 0);
+            for (size_t v = 0; v < 300; v++)
+            {
+                same = same && copies[t].getConnectivity()->find(v) == representative[v];
+                same = same && copies[t].getConnectivity()->connected(v, (v * 7) % 300) == (representative[v] == representative[(v * 7) % 300]);
+            }
+            matches[t] = same ? 1 : 0;
+        });
+    }
+    for (thread &worker : threads)
+    {
+        worker.join();
+    }
+    CHECK(count(matches.begin(), matches.end(), 1) == 4);
+}
+
+TEST_CASE("Results of one graph requested from several threads")
+{
+    // Every thread asks the same graph, the first request builds each result and the others get the same object.
+    const ariel::Graph g = ariel::GraphGenerator::erdosRenyi(60, 0.05, false, 1, 9, 11);
+    vector<const void *> paths(4), reachability(4), components(4);
+    vector<ariel::Graph> copies(4);
+    vector<thread> threads;
+    for (size_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            paths[t] = g.getAllPairsPaths().get();
+            copies[t] = g;
+            reachability[t] = g.getReachability().get();
+            components[t] = g.getConnectivity().get();
+        });
+    }
+    for (thread &worker : threads)
+    {
+        worker.join();
+    }
+    CHECK(count(paths.begin(), paths.end(), paths[0]) == 4);
+    CHECK(count(reachability.begin(), reachability.end(), reachability[0]) == 4);
+    CHECK(count(components.begin(), components.end(), components[0]) == 4);
+    CHECK(copies[3].getAllPairsPaths().get() == paths[0]);
+    CHECK(copies[3].getAllPairsPaths()->getDistance(0, 59) == g.getAllPairsPaths()->getDistance(0, 59));
+}
+
+// Writes bytes over a file at offset, keeping the rest of it.
+static void patchFile(const string &path, streamoff offset, const void *bytes, size_t length)
+{
+    fstream file(path, ios::binary | ios::in | ios::out);
+    file.seekp(offset);
+    file.write(static_cast<const char *>(bytes), static_cast<streamsize>(length));
+}
+
+TEST_CASE("A binary file whose header does not match its arrays")
+{
+    const string path = "test_graph_header.bin";
+    // The edges, non zero cells, lightest and heaviest weights and direction of the header, by their offsets.
+    const streamoff directedOffset = 24, edgesOffset = 40, nonZerosOffset = 48, lightestOffset = 64, heaviestOffset = 72;
+    const uint32_t undirected = 0, directed = 1;
+    const uint64_t wrongCount = 5;
+    const int wrongLightest = 100, wrongHeaviest = -100;
+
+    ariel::Graph dense = ariel::GraphGenerator::erdosRenyi(100, 0.5, true, -4, 9, 1);
+    ariel::Graph sparse = ariel::GraphGenerator::erdosRenyi(200, 0.02, true, 1, 9, 2);
+    for (const ariel::Graph *g : {&dense, &sparse})
+    {
+        g->saveBinary(path);
+        patchFile(path, directedOffset, &undirected, sizeof(undirected));
+        patchFile(path, edgesOffset, &wrongCount, sizeof(wrongCount));
+        patchFile(path, nonZerosOffset, &wrongCount, sizeof(wrongCount));
+        patchFile(path, lightestOffset, &wrongLightest, sizeof(wrongLightest));
+        patchFile(path, heaviestOffset, &wrongHeaviest, sizeof(wrongHeaviest));
+        ariel::Graph loaded;
+        loaded.loadBinary(path);
+        CHECK(loaded == *g);
+        CHECK(loaded.getEdges() == g->getEdges());
+        CHECK(loaded.isDirected());
+        CHECK(loaded.getLightestWeight() == g->getLightestWeight());
+        CHECK(loaded.getHeaviestWeight() == g->getHeaviestWeight());
+        CHECK(ariel::Algorithms::negativeCycle(loaded) == ariel::Algorithms::negativeCycle(*g));
+    }
+
+    // Symmetric storage holds only undirected graphs, and a failed load leaves the graph as it was.
+    ariel::Graph symmetric = ariel::GraphGenerator::erdosRenyi(100, 0.5, false, 1, 9, 4);
+    CHECK(symmetric.getStorage() == ariel::Graph::Storage::Symmetric);
+    symmetric.saveBinary(path);
+    patchFile(path, directedOffset, &directed, sizeof(directed));
+    ariel::Graph kept = sparse;
+    CHECK_THROWS_AS(kept.loadBinary(path), invalid_argument);
+    CHECK(kept == sparse);
+
+    // So many vertices that n + 1 wraps around to 0, with empty sparse arrays and row offsets far past the end of the file.
+    const streamoff verticesOffset = 32, rowOffsetsOffset = 88, sparseLengthsOffset = 128;
+    const uint64_t tooManyVertices = UINT64_MAX, farOffset = uint64_t(1) << 40;
+    const uint64_t emptyLengths[3] = {0, 0, 0};
+    sparse.saveBinary(path);
+    patchFile(path, verticesOffset, &tooManyVertices, sizeof(tooManyVertices));
+    patchFile(path, rowOffsetsOffset, &farOffset, sizeof(farOffset));
+    patchFile(path, sparseLengthsOffset, emptyLengths, sizeof(emptyLengths));
+    CHECK_THROWS_AS(kept.loadBinary(path), invalid_argument);
+    CHECK(kept == sparse);
+    remove(path.c_str());
+}
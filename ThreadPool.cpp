@@ -0,0 +1,229 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#include <algorithm>
+#include "ThreadPool.hpp"
+using namespace std;
+using namespace ariel;
+
+size_t ThreadPool::threadCount = 1;
+
+// True on the threads of the pool, and on a thread while it runs a loop.
+static thread_local bool insideLoop = false;
+
+ThreadPool::ThreadPool() : job(nullptr), generation(0), stopping(false)
+{
+
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(this->lock);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (thread &worker : this->workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::setThreadCount(size_t threads)
+{
+    if (threads == 0)
+    {
+        // hardware_concurrency may not know, and return 0.
+        threads = max(thread::hardware_concurrency(), 1u);
+    }
+    ThreadPool::threadCount = threads;
+}
+
+size_t ThreadPool::getThreadCount()
+{
+    return ThreadPool::threadCount;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t maxThreads, const function<void(size_t)> &body)
+{
+    if (maxThreads == 0)
+    {
+        maxThreads = ThreadPool::threadCount;
+    }
+    size_t slots = min(maxThreads, count);
+
+    unique_lock<mutex> call(this->callLock, defer_lock);
+    if (slots <= 1 || insideLoop || !call.try_lock())
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    // The calling thread takes part, so the loop needs slots - 1 threads of the pool.
+    while (this->workers.size() < slots - 1)
+    {
+        this->workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    // Every slot starts with an equal share of the indices, in order, the calling thread with the first one.
+    Job current;
+    current.body = &body;
+    current.ranges.reset(new Range[slots]);
+    current.slots = slots;
+    current.joined = 1;
+    current.active = 0;
+    current.failed = false;
+    for (size_t s = 0; s < slots; s++)
+    {
+        current.ranges[s].next = count * s / slots;
+        current.ranges[s].end = count * (s + 1) / slots;
+    }
+
+    // Ends the job when the calling thread leaves it, by an exception too: the calling thread is no longer inside a loop,
+    // the other threads are kept from joining, and the ones still running an index are waited for, the job is on this stack.
+    struct JobGuard
+    {
+        ThreadPool *pool;
+        Job *job;
+
+        ~JobGuard()
+        {
+            insideLoop = false;
+            unique_lock<mutex> guard(this->pool->lock);
+            this->pool->job = nullptr;
+            this->pool->done.wait(guard, [this]() { return this->job->active == 0; });
+        }
+    };
+
+    {
+        JobGuard jobGuard{this, &current};
+        {
+            lock_guard<mutex> guard(this->lock);
+            this->job = &current;
+            this->generation++;
+        }
+        this->wake.notify_all();
+
+        insideLoop = true;
+        ThreadPool::runSlot(current, 0);
+    }
+    if (current.error)
+    {
+        rethrow_exception(current.error);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    insideLoop = true;
+    size_t seen = 0;
+    unique_lock<mutex> guard(this->lock);
+    while (true)
+    {
+        this->wake.wait(guard, [&]() { return this->stopping || this->generation != seen; });
+        if (this->stopping)
+        {
+            return;
+        }
+        seen = this->generation;
+        Job *current = this->job;
+        if (current == nullptr || current->joined == current->slots)
+        {
+            continue;
+        }
+        size_t slot = current->joined++;
+        current->active++;
+
+        guard.unlock();
+        ThreadPool::runSlot(*current, slot);
+        guard.lock();
+
+        if (--current->active == 0)
+        {
+            this->done.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::take(Range &range, size_t &index)
+{
+    lock_guard<mutex> guard(range.lock);
+    if (range.next == range.end)
+    {
+        return false;
+    }
+    index = range.next++;
+    return true;
+}
+
+void ThreadPool::fail(Job &job, exception_ptr error)
+{
+    lock_guard<mutex> guard(job.errorLock);
+    if (!job.error)
+    {
+        job.error = error;
+    }
+    job.failed = true;
+}
+
+void ThreadPool::runSlot(Job &job, size_t slot)
+{
+    Range &own = job.ranges[slot];
+    size_t index = 0;
+    while (true)
+    {
+        // An exception must not leave a thread of the pool, it is kept for the calling thread.
+        while (!job.failed.load(memory_order_relaxed) && ThreadPool::take(own, index))
+        {
+            try
+            {
+                (*job.body)(index);
+            }
+            catch (...)
+            {
+                ThreadPool::fail(job, current_exception());
+            }
+        }
+        if (job.failed.load(memory_order_relaxed))
+        {
+            return;
+        }
+
+        // Steal the upper half of the first range that is not empty, looking at the slots after this one first.
+        bool stolen = false;
+        for (size_t s = 1; s < job.slots && !stolen; s++)
+        {
+            Range &victim = job.ranges[(slot + s) % job.slots];
+            size_t begin = 0, end = 0;
+            {
+                lock_guard<mutex> guard(victim.lock);
+                if (victim.next < victim.end)
+                {
+                    begin = victim.next + (victim.end - victim.next) / 2;
+                    end = victim.end;
+                    victim.end = begin;
+                }
+            }
+            if (begin < end)
+            {
+                lock_guard<mutex> guard(own.lock);
+                own.next = begin;
+                own.end = end;
+                stolen = true;
+            }
+        }
+        if (!stolen)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,151 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <exception>
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * Threads owned by the library that run the parallel loops of the graph operators and algorithms.
+    * The threads are started the first time a loop needs them and wait for work between loops,
+    * so a loop does not pay for creating threads.
+    * Every thread taking part in a loop starts with its own range of indices, and a thread that runs out of indices
+    * steals the upper half of the range of another thread, so a slow index does not hold back the others.
+    */
+    class ThreadPool
+    {
+    private:
+        // The indices left to a thread taking part in a loop, next .. end - 1.
+        struct Range
+        {
+            mutex lock;
+            size_t next = 0;
+            size_t end = 0;
+        };
+
+        // A running loop, it lives on the stack of the thread that called parallelFor.
+        struct Job
+        {
+            const function<void(size_t)> *body;
+            unique_ptr<Range[]> ranges;
+            size_t slots;
+            // Slots handed out to threads, the calling thread has slot 0.
+            size_t joined;
+            // Threads of the pool that are still inside the job.
+            size_t active;
+            // The first exception thrown by the body, thrown again by parallelFor. Once there is one, no new index is started.
+            mutex errorLock;
+            exception_ptr error;
+            atomic<bool> failed;
+        };
+
+        // Default number of threads of a loop.
+        static size_t threadCount;
+
+        vector<thread> workers;
+        // Guards job, generation, stopping and the joined and active counters of the job.
+        mutex lock;
+        // Only one loop runs on the pool at a time.
+        mutex callLock;
+        condition_variable wake;
+        condition_variable done;
+        Job *job;
+        // Increased for every new job, so a thread does not join the same job twice.
+        size_t generation;
+        bool stopping;
+
+        /*
+        * @brief
+        * This function is the loop of a thread of the pool: wait for a job, take a slot in it and run it.
+        * @return void
+        */
+        void workerLoop();
+
+        /*
+        * @brief
+        * This function runs the indices of a slot of the job, then steals from the other slots until none is left.
+        * @param job - the running job.
+        * @param slot - the slot of the calling thread.
+        * @return void
+        */
+        static void runSlot(Job &job, size_t slot);
+
+        /*
+        * @brief
+        * This function takes the next index of a range.
+        * @param range - the range.
+        * @param index - set to the index taken.
+        * @return bool - true if an index was taken, false if the range is empty.
+        */
+        static bool take(Range &range, size_t &index);
+
+        /*
+        * @brief
+        * This function keeps the first exception thrown by the body of a job and stops the job from starting new indices.
+        * @param job - the running job.
+        * @param error - the exception.
+        * @return void
+        */
+        static void fail(Job &job, exception_ptr error);
+
+    public:
+        // Constructor, no thread is started yet.
+        ThreadPool();
+
+        // Destructor, stops and joins the threads.
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /*
+        * @brief
+        * This function returns the pool shared by the whole library.
+        * @return ThreadPool& - the pool.
+        */
+        static ThreadPool &instance();
+
+        /*
+        * @brief
+        * This function sets the default number of threads of a loop, used by the operators and algorithms
+        * that are not given a number of threads.
+        * @param threads - number of threads, 1 runs on the calling thread only, 0 uses every hardware thread.
+        * @return void
+        */
+        static void setThreadCount(size_t threads);
+
+        /*
+        * @brief
+        * This function returns the default number of threads of a loop.
+        * @return size_t - number of threads, at least 1.
+        */
+        static size_t getThreadCount();
+
+        /*
+        * @brief
+        * This function calls body(0) .. body(count - 1), split between up to maxThreads threads,
+        * and returns when all the calls are done. The calling thread is one of the threads.
+        * A loop started from inside a body, or while another thread runs a loop on the pool, runs on the calling thread only.
+        * @param count - number of calls.
+        * @param maxThreads - the most threads the loop may run on, 0 uses the default number of threads.
+        * @param body - the function to call, it must be safe to call concurrently with different indices.
+        * @return void
+        * @throw the first exception thrown by body, once every thread has left the loop. The indices not started by then are skipped.
+        */
+        void parallelFor(size_t count, size_t maxThreads, const function<void(size_t)> &body);
+    };
+}
+
+#endif
@@ -0,0 +1,181 @@
+// ID: 205739907
+// Email: eladima66@gmail.com
+
+#ifndef _TRAVERSAL_HPP_
+#define _TRAVERSAL_HPP_
+
+#include <vector>
+#include <cstdint>
+#include "Graph.hpp"
+using namespace std;
+namespace ariel
+{
+
+    /*
+    * @brief
+    * The callbacks of a depth first search, each one does nothing and lets the search go on.
+    * A visitor derives from this class and hides the callbacks it needs, they are resolved at compile time.
+    * A callback returns false to stop the search. The edges are the Neighbour of the graph searched,
+    * so the edge callbacks are templates and a visitor can search graphs of any weight type.
+    */
+    struct DepthFirstVisitor
+    {
+        // Called for every edge leaving a vertex, in increasing order of the vertex it enters, before the edge is classified.
+        template <typename Edge>
+        bool examineEdge(size_t, const Edge &) { return true; }
+        // Called when the search first reaches v, parent is the vertex it came from or NO_PARENT for the root.
+        bool discover(size_t, size_t) { return true; }
+        // Called for an edge entering a vertex that is still on the stack, an ancestor of u or u itself.
+        template <typename Edge>
+        bool backEdge(size_t, const Edge &) { return true; }
+        // Called for an edge entering a vertex whose search is already finished.
+        template <typename Edge>
+        bool forwardOrCrossEdge(size_t, const Edge &) { return true; }
+        // Called when all the edges leaving v have been examined.
+        bool finish(size_t) { return true; }
+    };
+
+    /*
+    * @brief
+    * Depth first search over the neighbours of the vertices, with an explicit stack instead of recursion.
+    * The vertices and edges are visited in the same order as by the recursive search, but the depth of the search
+    * is only bounded by the heap. The stack is allocated once, so a search does not allocate per visited vertex.
+    * The search remembers the vertices it has discovered, so it can be run from several roots to cover the graph.
+    */
+    template <typename W>
+    class BasicDepthFirstSearch
+    {
+    public:
+        // The parent passed to discover for the root of the search.
+        // An enumerator rather than a static member, so it can be bound to a reference without a definition in a source file.
+        enum : size_t
+        {
+            NO_PARENT = SIZE_MAX
+        };
+
+    private:
+        enum class State : unsigned char
+        {
+            Undiscovered,
+            OnStack,
+            Finished
+        };
+
+        // A vertex on the stack and the next of its edges to examine.
+        struct Frame
+        {
+            size_t vertex;
+            typename BasicGraph<W>::NeighbourIterator next;
+            typename BasicGraph<W>::NeighbourIterator end;
+        };
+
+        const BasicGraph<W> &graph;
+        vector<State> state;
+        vector<Frame> stack;
+
+        void push(size_t v)
+        {
+            typename BasicGraph<W>::RowView row = this->graph.getRow(v);
+            this->state[v] = State::OnStack;
+            this->stack.push_back(Frame{v, row.begin(), row.end()});
+        }
+
+    public:
+        // Constructor, no vertex is discovered yet.
+        explicit BasicDepthFirstSearch(const BasicGraph<W> &graph) : graph(graph), state(graph.getVertices(), State::Undiscovered)
+        {
+            // The stack never holds more than every vertex once.
+            this->stack.reserve(graph.getVertices());
+        }
+
+        /*
+        * @brief
+        * This function checks if a vertex was discovered by one of the searches so far.
+        * @param v - the vertex.
+        * @return bool - true if the vertex was discovered, false otherwise.
+        */
+        bool isDiscovered(size_t v) const
+        {
+            return this->state[v] != State::Undiscovered;
+        }
+
+        /*
+        * @brief
+        * This function searches the vertices reachable from the root that were not discovered yet.
+        * It does nothing if the root itself was already discovered.
+        * @param root - the vertex to start from.
+        * @param visitor - object with the callbacks of DepthFirstVisitor.
+        * @return bool - false if a callback stopped the search, true otherwise.
+        */
+        template <typename Visitor>
+        bool run(size_t root, Visitor &visitor)
+        {
+            if (this->isDiscovered(root))
+            {
+                return true;
+            }
+            // A search stopped by a callback leaves its stack behind.
+            this->stack.clear();
+            this->push(root);
+            if (!visitor.discover(root, NO_PARENT))
+            {
+                return false;
+            }
+
+            while (!this->stack.empty())
+            {
+                Frame &top = this->stack.back();
+                size_t u = top.vertex;
+
+                // All the edges of the vertex were examined, go back to its parent.
+                if (top.next == top.end)
+                {
+                    this->state[u] = State::Finished;
+                    this->stack.pop_back();
+                    if (!visitor.finish(u))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+
+                typename BasicGraph<W>::Neighbour edge = *top.next;
+                ++top.next;
+                if (!visitor.examineEdge(u, edge))
+                {
+                    return false;
+                }
+
+                switch (this->state[edge.vertex])
+                {
+                case State::Undiscovered:
+                    // Go down the edge, the rest of the edges of u wait in its frame.
+                    this->push(edge.vertex);
+                    if (!visitor.discover(edge.vertex, u))
+                    {
+                        return false;
+                    }
+                    break;
+                case State::OnStack:
+                    if (!visitor.backEdge(u, edge))
+                    {
+                        return false;
+                    }
+                    break;
+                case State::Finished:
+                    if (!visitor.forwardOrCrossEdge(u, edge))
+                    {
+                        return false;
+                    }
+                    break;
+                }
+            }
+            return true;
+        }
+    };
+
+    // The search of a graph of int weights.
+    typedef BasicDepthFirstSearch<int> DepthFirstSearch;
+}
+
+#endif